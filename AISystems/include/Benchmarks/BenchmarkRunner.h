@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations = 0;
+    size_t items = 0;
+    double minSeconds = 0.0;
+    double medianSeconds = 0.0;
+    double itemsPerSecond = 0.0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    size_t peakResidentBytes = 0;
+};
+
+class BenchmarkRunner {
+private:
+    size_t _iterations;
+    std::vector<BenchmarkResult> _results;
+    std::vector<std::pair<std::string, std::string>> _parameters;
+
+
+public:
+    explicit BenchmarkRunner(size_t iterations);
+
+    void AddParameter(const std::string& name, const std::string& value);
+    void AddParameter(const std::string& name, double value);
+
+    const BenchmarkResult& Run(const std::string& name, size_t items, const std::function<void()>& body);
+
+    const std::vector<BenchmarkResult>& GetResults() const;
+    void PrintTable(std::ostream& out) const;
+    void WriteJson(std::ostream& out) const;
+};
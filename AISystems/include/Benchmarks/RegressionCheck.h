@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DTDataset.h"
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+
+class RegressionCheck {
+private:
+    static std::string SaveBytes(const DecisionTree& tree);
+    static std::string ToLegacyFormat(const std::string& model, uint32_t version);
+    static std::vector<uint32_t> PredictAll(const DecisionTree& tree, const DTDataset& dataset);
+    static bool Report(std::ostream& out, bool passed, const std::string& name);
+    static size_t CountLeaves(const Node* node, size_t& maxBranches);
+    static void WriteLines(const std::string& filename, const std::vector<std::string>& lines);
+
+public:
+    // Инварианты, которые оптимизации построения не должны нарушать: дерево не зависит
+    // от числа потоков, поиска разбиений и уровня описания, а модели версий 2 и 3 читаются
+    // текущей сборкой с теми же предсказаниями. Модели пишутся во временный файл modelPath
+    static bool Run(const DTDataset& dataset, size_t threads, const std::string& modelPath, std::ostream& out);
+
+    // Потоковое построение по CSV-файлу csvPath и по строкам набора даёт ту же модель, что и ID3
+    static bool RunStreaming(const DTDataset& dataset, const std::string& csvPath, char delimiter, std::ostream& out);
+
+    // Инкрементное дерево: граница Хёфдинга разрешает разбиение ровно на той строке, где
+    // отрыв лучшего признака превышает epsilon, а обновление набором равно обновлению по строкам
+    static bool RunIncremental(const DTDataset& dataset, std::ostream& out);
+
+    // Перекрёстная проверка: блоки разбивают строки и сохраняют доли классов, отложенная часть
+    // имеет заданную долю, а результат не зависит от числа потоков
+    static bool RunCrossValidation(const DTDataset& dataset, size_t threads, std::ostream& out);
+
+    // Перебор параметров: ранняя остановка снимает отстающие испытания, лучшее выбирается
+    // среди доведённых до конца, и всё это не зависит от числа потоков
+    static bool RunGridSearch(const DTDataset& dataset, size_t threads, std::ostream& out);
+
+    // Обрезка: проверочный набор из validationPath, загруженный без распознавания чисел, обрезает
+    // дерево так же, как числовой; число листьев доводится до maxLeaves, насколько позволяют
+    // ветвления; поддеревья, до которых не дошли проверочные строки, не сворачиваются
+    static bool RunPruning(const DTDataset& training, const std::string& validationPath, const DTDataset::LoadOptions& loadOptions, std::ostream& out);
+};
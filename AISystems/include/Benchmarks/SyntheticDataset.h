@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SyntheticDataset {
+public:
+    struct Options {
+        size_t rows = 100000;
+        size_t features = 10;
+        size_t cardinality = 8;
+        size_t classes = 2;
+        double imbalance = 1.0;
+        double noise = 0.1;
+        size_t informativeFeatures = 3;
+        char delimiter = ';';
+        bool numeric = false;
+        uint64_t seed = 1;
+    };
+
+private:
+    static std::vector<double> ClassDistribution(const Options& options);
+
+public:
+    static void Validate(const Options& options);
+    static size_t WriteCsv(const std::string& filename, const Options& options);
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class DTDataset;
+
+class BuildProfile {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        double start = 0.0;
+        double seconds = 0.0;
+    };
+
+    struct NodeStats {
+        std::string path;
+        size_t depth = 0;
+        size_t rows = 0;
+        size_t countedRows = 0;
+        std::string feature;
+        size_t children = 0;
+        size_t thread = 0;
+        Phase total;
+        Phase counting;
+        Phase gain;
+        Phase partition;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+    };
+
+    struct DepthStats {
+        size_t depth = 0;
+        size_t nodes = 0;
+        size_t leaves = 0;
+        size_t rows = 0;
+        size_t countedRows = 0;
+        double countingSeconds = 0.0;
+        double gainSeconds = 0.0;
+        double partitionSeconds = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+    };
+
+    struct FeatureStats {
+        std::string name;
+        size_t cardinality = 0;
+        size_t evaluations = 0;
+        size_t rows = 0;
+        double gainSeconds = 0.0;
+    };
+
+private:
+    Clock::time_point _start;
+    double _totalSeconds = 0.0;
+    bool _allocationsCounted = false;
+    uint64_t _allocations = 0;
+    uint64_t _allocatedBytes = 0;
+    uint64_t _startAllocations = 0;
+    uint64_t _startAllocatedBytes = 0;
+    std::vector<std::pair<std::string, Phase>> _stages;
+    std::vector<NodeStats> _nodes;
+    std::vector<FeatureStats> _features;
+    std::vector<std::thread::id> _threads;
+    mutable std::mutex _mutex;
+
+    static void WriteEvent
+    (
+        std::ostream& out,
+        const std::string& name,
+        const char* category,
+        const Phase& phase,
+        size_t thread,
+        bool& first
+    );
+
+public:
+    void Start(const DTDataset& dataset);
+    void Finish();
+    double Now() const;
+
+    void AddStage(const std::string& name, const Phase& phase);
+    void AddNode(NodeStats node, const std::vector<std::pair<size_t, double>>& gainSeconds);
+
+    double TotalSeconds() const;
+    bool AllocationsCounted() const;
+    uint64_t Allocations() const;
+    uint64_t AllocatedBytes() const;
+    const std::vector<std::pair<std::string, Phase>>& GetStages() const;
+    const std::vector<NodeStats>& GetNodes() const;
+    const std::vector<FeatureStats>& GetFeatures() const;
+    std::vector<DepthStats> GetDepthStats() const;
+
+    void PrintSummary(std::ostream& out) const;
+    void WriteChromeTrace(std::ostream& out) const;
+    void WriteChromeTrace(const std::string& filename) const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <fstream>
+#include <ostream>
+#include <string>
+
+enum class TraceLevel {
+    Off,
+    Summary,
+    Full
+};
+
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+    virtual std::ostream& GetStream() = 0;
+};
+
+class OStreamTraceSink : public TraceSink {
+private:
+    std::ostream& _stream;
+
+public:
+    explicit OStreamTraceSink(std::ostream& stream)
+        : _stream(stream) {
+    }
+
+    std::ostream& GetStream() override;
+};
+
+class FileTraceSink : public TraceSink {
+private:
+    std::ofstream _file;
+
+public:
+    explicit FileTraceSink(const std::string& filename);
+
+    std::ostream& GetStream() override;
+};
+
+class NoTrace {
+public:
+    static constexpr bool Summary = false;
+    static constexpr bool Full = false;
+
+    explicit NoTrace(std::ostream&) {
+    }
+};
+
+template <TraceLevel Level>
+class StreamTrace {
+private:
+    std::ostream* _stream;
+
+public:
+    static constexpr bool Summary = Level != TraceLevel::Off;
+    static constexpr bool Full = Level == TraceLevel::Full;
+
+    explicit StreamTrace(std::ostream& stream)
+        : _stream(&stream) {
+    }
+
+    std::ostream& Out() const {
+        return *_stream;
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DecisionTrees/DTDatasetView.h"
+#include "Utils/WorkStealingPool.h"
+
+class ContingencyTable {
+private:
+    size_t _numClasses = 0;
+    size_t _totalRows = 0;
+    std::vector<size_t> _features;
+    std::vector<size_t> _valueCounts;
+    std::vector<size_t> _offsets;
+    std::vector<size_t> _codeOffsets;
+    std::vector<uint32_t> _codes;
+    std::vector<uint32_t> _counts;
+    std::vector<uint32_t> _classCounts;
+    std::vector<size_t> _laneOffsets;
+    std::vector<uint32_t> _lanes;
+
+    void AccumulateSlots(const DTDatasetView& dataset, size_t firstSlot, size_t lastSlot, bool countClasses);
+    void MergeLanes(size_t slot);
+
+public:
+    static constexpr size_t BlockSize = 2048;
+    static constexpr size_t HistogramLanes = 4;
+    static constexpr size_t MaxLaneCells = 4096;
+    static constexpr size_t NoLanes = static_cast<size_t>(-1);
+    static constexpr size_t AllCodes = static_cast<size_t>(-1);
+    static constexpr size_t CompactRatio = 4;
+    static constexpr size_t NoValue = static_cast<size_t>(-1);
+
+    static ContingencyTable Build(const DTDatasetView& dataset, WorkStealingPool* pool = nullptr, const std::vector<bool>& selected = {});
+
+    size_t FeatureCount() const;
+    size_t NumClasses() const;
+    size_t TotalRows() const;
+
+    size_t GetFeatureIndex(size_t slot) const;
+    size_t GetValueCount(size_t slot) const;
+    const uint32_t* GetValueCodes(size_t slot) const;
+    size_t FindValue(size_t slot, uint32_t code) const;
+    const uint32_t* GetFeatureCounts(size_t slot) const;
+    const std::vector<uint32_t>& GetClassCounts() const;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DecisionTrees/DTDatasetView.h"
+#include "DecisionTrees/DTFeatureBins.h"
+#include "Utils/WorkStealingPool.h"
+
+class FeatureHistogram {
+private:
+    size_t _numClasses = 0;
+    size_t _totalRows = 0;
+    std::vector<size_t> _binCounts;
+    std::vector<size_t> _offsets;
+    std::vector<uint32_t> _counts;
+    std::vector<uint32_t> _classCounts;
+
+    void AccumulateColumns
+    (
+        const DTDatasetView& dataset,
+        const DTFeatureBins& bins,
+        const std::vector<size_t>& columns,
+        size_t first,
+        size_t last,
+        bool countClasses
+    );
+
+public:
+    static constexpr size_t BlockSize = 2048;
+
+    static FeatureHistogram Build(const DTDatasetView& dataset, const DTFeatureBins& bins, WorkStealingPool* pool = nullptr);
+
+    void Subtract(const FeatureHistogram& other);
+
+    bool Empty() const;
+    size_t NumClasses() const;
+    size_t TotalRows() const;
+
+    size_t GetBinCount(size_t columnIndex) const;
+    const uint32_t* GetFeatureCounts(size_t columnIndex) const;
+    const std::vector<uint32_t>& GetClassCounts() const;
+};
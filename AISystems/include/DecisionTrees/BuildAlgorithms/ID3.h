@@ -1,37 +1,181 @@
 #pragma once
 #include "DecisionTrees/DecisionTree/DecisionTree.h"
 #include "DecisionTrees/DTDataset.h"
+#include "DecisionTrees/DTDatasetView.h"
+#include "BuildProfile.h"
+#include "BuildTrace.h"
+#include "TreePruner.h"
+#include "ContingencyTable.h"
+#include "FeatureHistogram.h"
+#include "SplitCriteria.h"
+#include "Utils/WorkStealingPool.h"
 
 class ID3 {
+public:
+    enum class SplitSearch {
+        Exact,
+        Histogram
+    };
+
+    enum class CategoricalSplit {
+        Multiway,
+        Binary
+    };
+
+    struct Options {
+        size_t threads = 1;
+        size_t parallelSubtreeRows = 4096;
+        size_t parallelCountingRows = 65536;
+        WorkStealingPool* pool = nullptr;
+        TraceLevel traceLevel = TraceLevel::Full;
+        TraceSink* traceSink = nullptr;
+        SplitSearch splitSearch = SplitSearch::Exact;
+        SplitCriterion criterion = SplitCriterion::InformationGain;
+        CategoricalSplit categoricalSplit = CategoricalSplit::Multiway;
+        size_t histogramBins = 0;
+        size_t featureSubset = 0;
+        uint64_t seed = 0;
+        BuildProfile* profile = nullptr;
+        size_t maxDepth = 0;
+        size_t minSamplesSplit = 0;
+        double minGain = 0.0;
+        size_t maxLeaves = 0;
+        const DTDataset* validation = nullptr;
+    };
+
 private:
-    static bool AllSameTargetValue(const DTDataset& dataset);
+    struct BuildContext {
+        const Options& options;
+        WorkStealingPool* pool;
+        const DTFeatureBins* bins;
+        NodeArena* arena;
+    };
+
+    struct SplitChoice {
+        size_t feature;
+        bool numeric;
+        float threshold;
+        double gain;
+        std::vector<bool> subset;
+    };
 
-    static double CalculateInformationGain
+    static constexpr size_t NoFeature = static_cast<size_t>(-1);
+
+    // Наибольшее число ветвей, гистограммы которых получает от родителя (через вычитание)
+    static constexpr size_t SubtractionFanout = 4;
+
+    static bool AllSameTargetValue(const DTDatasetView& dataset);
+
+    static std::vector<bool> SampleFeatures(const DTDatasetView& dataset, size_t count, uint64_t seed);
+
+    template <typename Criterion>
+    static double CalculateSplitScore
     (
-        const DTDataset& dataset,
+        const uint32_t* leftCounts,
+        const uint32_t* totalCounts,
+        size_t numClasses,
+        size_t leftRows,
+        size_t totalRows,
+        const double& nodeImpurity,
+        std::vector<uint32_t>& rightCounts
+    );
+
+    template <typename Criterion, typename Trace>
+    static double CalculateFeatureScore
+    (
+        const DTDatasetView& dataset,
         size_t featureIndex,
-        const double& totalEntropy,
-        std::ostringstream& oss,
+        const uint32_t* classDist,
+        const uint32_t* totalCounts,
+        size_t numValues,
+        size_t numClasses,
+        const uint32_t* valueCodes,
+        const double& nodeImpurity,
+        Trace& trace,
         const std::string& indent
     );
 
-    static size_t FindBestFeature
+    template <typename Criterion, typename Trace>
+    static double CalculateThresholdScore
     (
-        const DTDataset& dataset,
-        const double& totalEntropy,
-        std::ostringstream& oss,
+        const DTDatasetView& dataset,
+        size_t featureIndex,
+        const uint32_t* totalCounts,
+        size_t numClasses,
+        const uint32_t* histogram,
+        const DTFeatureBins::ColumnBins* bins,
+        const double& nodeImpurity,
+        float& threshold,
+        Trace& trace,
         const std::string& indent
     );
 
-    static std::unique_ptr<Node> BuildTreeInternal
+    template <typename Criterion, typename Trace>
+    static double CalculateSubsetScore
     (
-        const DTDataset& dataset,
-        std::ostringstream& oss,
-        size_t& iteration,
+        const DTDatasetView& dataset,
+        size_t featureIndex,
+        const uint32_t* classDist,
+        const uint32_t* totalCounts,
+        size_t numValues,
+        size_t numClasses,
+        const DTFeatureBins::ColumnBins* bins,
+        const uint32_t* valueCodes,
+        const double& nodeImpurity,
+        std::vector<bool>& subset,
+        Trace& trace,
         const std::string& indent
     );
 
-    static std::unique_ptr<Node> BuildTree(const DTDataset& dataset, std::ostringstream& oss);
+    template <typename Criterion, typename Trace>
+    static SplitChoice FindBestFeature
+    (
+        const DTDatasetView& dataset,
+        const ContingencyTable* table,
+        const FeatureHistogram* histogram,
+        const std::vector<bool>& selected,
+        const double& nodeImpurity,
+        Trace& trace,
+        const std::string& indent,
+        const BuildContext& context,
+        std::vector<std::pair<size_t, double>>& gainSeconds
+    );
+
+    static void PassClassCounts
+    (
+        std::vector<std::pair<uint32_t, DTDatasetView>>& children,
+        const SplitChoice& best,
+        const ContingencyTable* table,
+        const FeatureHistogram* histogram,
+        const BuildContext& context
+    );
+
+    static void PassSubsetCounts
+    (
+        std::vector<std::pair<uint32_t, DTDatasetView>>& children,
+        const std::vector<bool>& inSubset,
+        const uint32_t* counts,
+        const std::vector<uint32_t>& total
+    );
+
+    template <typename Criterion, typename Trace>
+    static const Node* BuildTreeInternal
+    (
+        DTDatasetView& dataset,
+        FeatureHistogram histogram,
+        uint64_t seed,
+        size_t depth,
+        Trace& trace,
+        const std::string& indent,
+        const BuildContext& context,
+        const std::string& path
+    );
+
+    template <typename Criterion, typename Trace>
+    static const Node* BuildTree(DTDatasetView& view, std::ostream& out, const BuildContext& context);
+
+    template <typename Criterion>
+    static const Node* BuildTraced(DTDatasetView& view, std::ostream& out, const BuildContext& context);
 
     DTDataset _trainDataset;
     std::vector<std::string> _originalHeaders;
@@ -42,5 +186,20 @@ public:
     }
 
     static DecisionTree Train(const DTDataset& dataset);
-};
+    static DecisionTree Train(const DTDataset& dataset, const Options& options);
+
+    // Шаги обучения, общие с ансамблями, перекрёстной проверкой и инкрементальным построением
+    static DecisionTree TrainView(DTDatasetView& view, const Options& options, WorkStealingPool* pool, const DTFeatureBins* bins);
 
+    static const DTFeatureBins* ResolveFeatureBins
+    (
+        const DTDataset& dataset,
+        const Options& options,
+        WorkStealingPool* pool,
+        std::unique_ptr<DTFeatureBins>& ownBins
+    );
+
+    static uint64_t ChildSeed(uint64_t seed, size_t child);
+
+    static double CalculateEntropy(const uint32_t* counts, size_t numClasses, size_t total);
+};
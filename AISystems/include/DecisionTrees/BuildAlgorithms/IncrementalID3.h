@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+#include "DecisionTrees/DTDataset.h"
+
+class IncrementalID3 {
+public:
+    struct Options {
+        double splitConfidence = 1e-7;
+        double tieThreshold = 0.05;
+        size_t gracePeriod = 200;
+    };
+
+private:
+    struct IncrementalNode {
+        uint32_t feature = NoFeature;
+        uint32_t defaultClass = NoClass;
+        std::vector<uint32_t> children;
+
+        size_t rows = 0;
+        size_t rowsAtLastCheck = 0;
+        size_t classStride = 0;
+        std::vector<uint32_t> classCounts;
+        std::vector<uint32_t> activeFeatures;
+        std::vector<std::vector<uint32_t>> featureCounts;
+    };
+
+    static constexpr uint32_t NoFeature = UINT32_MAX;
+    static constexpr uint32_t NoClass = UINT32_MAX;
+    static constexpr uint32_t NoChild = UINT32_MAX;
+
+    std::vector<std::string> _headers;
+    size_t _targetColumn;
+    Options _options;
+    std::vector<DTDictionary> _dictionaries;
+    std::vector<IncrementalNode> _nodes;
+    std::vector<uint32_t> _codes;
+    size_t _rows = 0;
+
+    uint32_t AddLeaf(std::vector<uint32_t> activeFeatures, uint32_t defaultClass);
+    uint32_t Route(const uint32_t* codes);
+    void CountRow(IncrementalNode& leaf, const uint32_t* codes);
+    void AttemptSplit(uint32_t index);
+    void Learn(const uint32_t* codes);
+
+    static uint32_t MajorityClass(const std::vector<uint32_t>& classCounts, uint32_t defaultClass);
+    const Node* BuildNodes(uint32_t index, NodeArena& arena) const;
+
+public:
+    IncrementalID3(const std::vector<std::string>& headers, size_t targetColumn);
+    IncrementalID3(const std::vector<std::string>& headers, size_t targetColumn, const Options& options);
+
+    void Update(const std::vector<std::string>& row);
+    void Update(const DTDataset& dataset);
+
+    std::string Predict(const std::vector<std::string>& sample) const;
+    DecisionTree GetTree() const;
+
+    size_t RowCount() const;
+    size_t NodeCount() const;
+    size_t MemoryUsage() const;
+};
@@ -0,0 +1,207 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+enum class SplitCriterion {
+    InformationGain,
+    GainRatio,
+    Gini,
+    ChiSquare
+};
+
+class NLog2N {
+public:
+    static constexpr size_t TableSize = 4096;
+
+private:
+    static const std::array<double, TableSize> _table;
+
+public:
+    static double Get(size_t n) {
+        return n < TableSize ? _table[n] : static_cast<double>(n) * std::log2(static_cast<double>(n));
+    }
+};
+
+// Политики критериев разбиения. Оценка разбиения накапливается по ветвям (AddBranch)
+// и сводится в одно число (Score): чем больше, тем лучше разбиение. Построение дерева
+// инстанцируется с политикой, поэтому расчёт встраивается без косвенных вызовов
+class InformationGainCriterion {
+public:
+    static constexpr const char* NodeTitle = "Общая энтропия набора";
+    static constexpr const char* SearchTitle = "с наибольшим информационным приростом G";
+    static constexpr const char* BestTitle = "по информационному приросту";
+    static constexpr const char* ScoreTitle = "Информационный прирост";
+    static constexpr const char* ImpurityTitle = "Энтропия";
+    static constexpr const char* BranchTitle = "энтропия";
+    static constexpr bool Entropy = true;
+
+    struct Split {
+        double weighted = 0.0;
+    };
+
+    // Энтропия через n*log2(n) целых счётчиков: H = (n*log2(n) - сумма c*log2(c)) / n
+    static double Impurity(const uint32_t* counts, size_t numClasses, size_t total) {
+        if (total == 0)
+            return 0.0;
+        double sum = 0.0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            sum += NLog2N::Get(counts[c]);
+        }
+        return (NLog2N::Get(total) - sum) / total;
+    }
+
+    static void AddBranch(Split& split, const uint32_t* counts, const uint32_t*, size_t numClasses, size_t rows) {
+        double sum = 0.0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            sum += NLog2N::Get(counts[c]);
+        }
+        split.weighted += NLog2N::Get(rows) - sum;
+    }
+
+    static double WeightedImpurity(const Split& split, size_t totalRows) {
+        return split.weighted / totalRows;
+    }
+
+    static double Score(const Split& split, double nodeImpurity, size_t totalRows) {
+        return nodeImpurity - split.weighted / totalRows;
+    }
+};
+
+class GainRatioCriterion {
+public:
+    static constexpr const char* NodeTitle = "Общая энтропия набора";
+    static constexpr const char* SearchTitle = "с наибольшим отношением прироста GR";
+    static constexpr const char* BestTitle = "по отношению прироста";
+    static constexpr const char* ScoreTitle = "Отношение прироста";
+    static constexpr const char* ImpurityTitle = "Энтропия";
+    static constexpr const char* BranchTitle = "энтропия";
+    static constexpr bool Entropy = true;
+
+    struct Split {
+        double weighted = 0.0;
+        double branches = 0.0;
+    };
+
+    static double Impurity(const uint32_t* counts, size_t numClasses, size_t total) {
+        return InformationGainCriterion::Impurity(counts, numClasses, total);
+    }
+
+    static void AddBranch(Split& split, const uint32_t* counts, const uint32_t*, size_t numClasses, size_t rows) {
+        double sum = 0.0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            sum += NLog2N::Get(counts[c]);
+        }
+        split.weighted += NLog2N::Get(rows) - sum;
+        split.branches += NLog2N::Get(rows);
+    }
+
+    static double WeightedImpurity(const Split& split, size_t totalRows) {
+        return split.weighted / totalRows;
+    }
+
+    // Прирост делится на энтропию самого разбиения (C4.5); разбиение, оставляющее все строки
+    // в одной ветви, ничего не даёт
+    static double Score(const Split& split, double nodeImpurity, size_t totalRows) {
+        double splitInfo = (NLog2N::Get(totalRows) - split.branches) / totalRows;
+        if (splitInfo <= 1e-12)
+            return 0.0;
+        return (nodeImpurity - split.weighted / totalRows) / splitInfo;
+    }
+};
+
+class GiniCriterion {
+public:
+    static constexpr const char* NodeTitle = "Индекс Джини набора";
+    static constexpr const char* SearchTitle = "с наибольшим уменьшением индекса Джини G";
+    static constexpr const char* BestTitle = "по уменьшению индекса Джини";
+    static constexpr const char* ScoreTitle = "Уменьшение индекса Джини";
+    static constexpr const char* ImpurityTitle = "Индекс Джини";
+    static constexpr const char* BranchTitle = "индекс Джини";
+    static constexpr bool Entropy = false;
+
+    struct Split {
+        double weighted = 0.0;
+    };
+
+    // Только умножения и деления: Gini = 1 - сумма c^2 / n^2
+    static double Impurity(const uint32_t* counts, size_t numClasses, size_t total) {
+        if (total == 0)
+            return 0.0;
+        double squares = 0.0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            squares += static_cast<double>(counts[c]) * counts[c];
+        }
+        return 1.0 - squares / (static_cast<double>(total) * total);
+    }
+
+    static void AddBranch(Split& split, const uint32_t* counts, const uint32_t*, size_t numClasses, size_t rows) {
+        if (rows == 0)
+            return;
+        double squares = 0.0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            squares += static_cast<double>(counts[c]) * counts[c];
+        }
+        split.weighted += rows - squares / rows;
+    }
+
+    static double WeightedImpurity(const Split& split, size_t totalRows) {
+        return split.weighted / totalRows;
+    }
+
+    static double Score(const Split& split, double nodeImpurity, size_t totalRows) {
+        return nodeImpurity - split.weighted / totalRows;
+    }
+};
+
+class ChiSquareCriterion {
+public:
+    static constexpr const char* NodeTitle = nullptr;
+    static constexpr const char* SearchTitle = "с наибольшей статистикой хи-квадрат на степень свободы X2/df";
+    static constexpr const char* BestTitle = "по статистике хи-квадрат на степень свободы";
+    static constexpr const char* ScoreTitle = "Статистика хи-квадрат на степень свободы";
+    static constexpr const char* ImpurityTitle = nullptr;
+    static constexpr const char* BranchTitle = nullptr;
+    static constexpr bool Entropy = false;
+
+    struct Split {
+        double ratio = 0.0;
+        size_t branches = 0;
+        size_t classes = 0;
+    };
+
+    static double Impurity(const uint32_t*, size_t, size_t) {
+        return 0.0;
+    }
+
+    // X2 = сумма (O - E)^2 / E при E = n(ветви) * n(класса) / n = n * (сумма O^2 / (n(ветви) * n(класса)) - 1)
+    static void AddBranch(Split& split, const uint32_t* counts, const uint32_t* totalCounts, size_t numClasses, size_t rows) {
+        if (rows == 0)
+            return;
+        double sum = 0.0;
+        size_t classes = 0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            if (totalCounts[c] != 0) {
+                sum += static_cast<double>(counts[c]) * counts[c] / totalCounts[c];
+                ++classes;
+            }
+        }
+        split.ratio += sum / rows;
+        split.branches++;
+        split.classes = classes;
+    }
+
+    static double WeightedImpurity(const Split&, size_t) {
+        return 0.0;
+    }
+
+    // Сырая X2 растёт с числом ветвей, и признаки с многими значениями выигрывали бы всегда.
+    // Статистика делится на число степеней свободы (непустые ветви - 1) * (классы узла - 1):
+    // это ожидаемое значение X2, когда признак и класс независимы.
+    // Разбиение с одной непустой ветвью или узел с одним классом ничего не дают
+    static double Score(const Split& split, double, size_t totalRows) {
+        if (split.branches < 2 || split.classes < 2)
+            return 0.0;
+        return totalRows * (split.ratio - 1.0) / ((split.branches - 1) * (split.classes - 1));
+    }
+};
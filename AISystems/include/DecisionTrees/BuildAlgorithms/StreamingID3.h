@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+#include "DecisionTrees/DTRowSource.h"
+
+class StreamingID3 {
+public:
+    struct Options {
+        size_t chunkRows = 65536;
+        size_t maxCountBytes = size_t(256) << 20;
+    };
+
+private:
+    enum class NodeState : uint8_t {
+        Pending,
+        Leaf,
+        Split
+    };
+
+    struct StreamNode {
+        NodeState state = NodeState::Pending;
+        uint32_t feature = 0;
+        uint32_t slot = UINT32_MAX;
+        std::string label;
+        std::vector<uint32_t> children;
+        std::vector<uint32_t> activeFeatures;
+    };
+
+    struct TrainContext {
+        DTRowSource& source;
+        size_t targetColumn;
+        size_t numClasses;
+        std::vector<size_t> cardinalities;
+        const Options& options;
+    };
+
+    static constexpr uint32_t NoChild = UINT32_MAX;
+
+    static uint32_t Route(const std::vector<StreamNode>& nodes, const DTCodeChunk& chunk, size_t row);
+
+    static size_t CountSize(const StreamNode& node, const TrainContext& context);
+
+    [[noreturn]] static void ThrowInvalidCode(const TrainContext& context, size_t column);
+
+    static void CountGroup
+    (
+        std::vector<StreamNode>& nodes,
+        const std::vector<size_t>& nodeOffsets,
+        std::vector<uint32_t>& counts,
+        const TrainContext& context
+    );
+
+    static void DecideNode
+    (
+        std::vector<StreamNode>& nodes,
+        uint32_t index,
+        const uint32_t* counts,
+        const TrainContext& context,
+        std::vector<uint32_t>& nextLevel
+    );
+
+    static const Node* BuildNodes(const DTRowSource& source, const std::vector<StreamNode>& nodes, uint32_t index, NodeArena& arena);
+
+public:
+    static DecisionTree Train(DTRowSource& source, size_t targetColumn);
+    static DecisionTree Train(DTRowSource& source, size_t targetColumn, const Options& options);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+#include "DecisionTrees/DTDataset.h"
+#include "DecisionTrees/DTDatasetView.h"
+
+class TreePruner {
+public:
+    struct Options {
+        const DTDataset* validation = nullptr;
+        size_t maxLeaves = 0;
+    };
+
+private:
+    struct PruneNode {
+        const Node* node = nullptr;
+        uint32_t parent = NoNode;
+        std::vector<uint32_t> children;
+        uint32_t majority = DTDictionary::NoCode;
+        size_t leafErrors = 0;
+        size_t treeErrors = 0;
+        size_t validationLeafErrors = 0;
+        size_t validationTreeErrors = 0;
+        size_t leaves = 1;
+        bool pruned = false;
+    };
+
+    struct PruneContext {
+        const DTDataset& training;
+        const DTDataset* validation;
+        std::vector<uint32_t> validationClasses;
+        std::vector<PruneNode> nodes;
+    };
+
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    static size_t FindColumn(const DTDataset& dataset, std::string_view header);
+    static size_t CountErrors(const DTDatasetView* view, uint32_t classCode, const PruneContext& context, bool validation);
+
+    static uint32_t Collect
+    (
+        const Node* node,
+        DTDatasetView* training,
+        DTDatasetView* validation,
+        uint32_t parent,
+        PruneContext& context
+    );
+
+    static void LimitLeaves(std::vector<PruneNode>& nodes, size_t maxLeaves);
+    static const Node* CopyNodes(const PruneContext& context, uint32_t index, NodeArena& arena);
+
+public:
+    static DecisionTree Prune(const DecisionTree& tree, const DTDataset& training, const Options& options);
+    static DecisionTree Prune(const DecisionTree& tree, DTDatasetView& training, const Options& options);
+};
@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Utils/MappedFile.h"
+
+struct DTStringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const noexcept {
+        return std::hash<std::string_view>{}(value);
+    }
+};
+
+// Разбор числа целиком: пробелы, хвосты и пустые строки числом не считаются
+inline bool DTParseNumber(std::string_view text, float& value) {
+    if (!text.empty() && text.front() == '+')
+        text.remove_prefix(1);
+    if (text.empty())
+        return false;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size() && !std::isnan(value);
+}
+
+// Кратчайшая запись числа, которая читается обратно в то же значение
+inline std::string DTFormatNumber(float value) {
+    char buffer[32];
+    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, end);
+}
+
+// Порог между соседними значениями - их середина, как в C4.5; если середина округлилась
+// до большего значения, порогом становится меньшее - оно всё равно разделяет их
+inline float DTSplitThreshold(float below, float above) {
+    float threshold = static_cast<float>((static_cast<double>(below) + above) / 2.0);
+    return threshold < above ? threshold : below;
+}
+
+class DTDictionary {
+private:
+    std::vector<std::string> _values;
+    std::unordered_map<std::string, uint32_t, DTStringHash, std::equal_to<>> _codes;
+
+public:
+    static constexpr uint32_t NoCode = std::numeric_limits<uint32_t>::max();
+
+    uint32_t Intern(std::string_view value);
+    uint32_t Find(std::string_view value) const;
+    const std::string& GetValue(uint32_t code) const;
+    const std::vector<std::string>& GetValues() const;
+    size_t Size() const;
+    size_t MemoryUsage() const;
+
+    void Serialize(std::string& out) const;
+    static DTDictionary Deserialize(std::string_view data, size_t size);
+};
+
+class DTLazyDictionary {
+private:
+    std::once_flag _once;
+    std::atomic<bool> _loaded{ false };
+    std::shared_ptr<const MappedFile> _mapping;
+    std::string_view _source;
+    size_t _size;
+    std::shared_ptr<DTDictionary> _dictionary;
+
+public:
+    DTLazyDictionary(std::shared_ptr<const MappedFile> mapping, std::string_view source, size_t size);
+
+    size_t Size() const;
+    bool IsLoaded() const;
+    const std::shared_ptr<DTDictionary>& Get();
+};
+
+// Отложенная проверка отображённых кодов: выполняется один раз на все копии столбца
+class DTMappedCodesCheck {
+private:
+    std::once_flag _once;
+    std::atomic<bool> _done{ false };
+
+public:
+    bool IsDone() const {
+        return _done.load(std::memory_order_acquire);
+    }
+
+    template <typename Fn>
+    void Run(Fn&& check) {
+        std::call_once(_once, [&]() {
+            check();
+            _done.store(true, std::memory_order_release);
+        });
+    }
+};
+
+class DTColumn {
+private:
+    std::shared_ptr<DTDictionary> _dictionary;
+    std::shared_ptr<DTLazyDictionary> _lazyDictionary;
+    std::shared_ptr<std::vector<float>> _numbers;
+    std::vector<uint16_t> _narrowCodes;
+    std::vector<uint32_t> _wideCodes;
+    std::shared_ptr<const MappedFile> _mapping;
+    const void* _mappedCodes = nullptr;
+    size_t _mappedSize = 0;
+    std::shared_ptr<DTMappedCodesCheck> _codesCheck;
+    bool _wide = false;
+
+    void CheckMappedCodes() const;
+    void Widen();
+    void Materialize();
+    void MaterializeDictionary();
+
+    template <typename Row>
+    DTColumn GatherRows(std::span<const Row> rows) const;
+
+public:
+    DTColumn();
+    explicit DTColumn(std::shared_ptr<DTDictionary> dictionary);
+
+    static DTColumn Map
+    (
+        std::shared_ptr<const MappedFile> mapping,
+        const void* codes,
+        size_t rows,
+        bool wide,
+        std::shared_ptr<DTDictionary> dictionary,
+        std::shared_ptr<DTLazyDictionary> lazyDictionary
+    );
+
+    void Reserve(size_t rows);
+    void Append(std::string_view value);
+    void AppendCode(uint32_t code);
+
+    size_t Size() const;
+    size_t Cardinality() const;
+    bool IsWide() const;
+    bool IsNumeric() const;
+    bool IsMapped() const;
+    size_t MemoryUsage() const;
+    size_t DictionaryMemoryUsage() const;
+
+    // Отображённые коды ленивого столбца проверяются один раз; дальше - одно чтение флага.
+    // Вызывается при выдаче столбца набором (DTDataset::GetColumn) и в VisitCodes,
+    // поэтому построчное чтение GetCode проверок не содержит
+    void CheckCodes() const {
+        if (_codesCheck && !_codesCheck->IsDone())
+            CheckMappedCodes();
+    }
+
+    uint32_t GetCode(size_t row) const {
+        if (_mappedCodes != nullptr)
+            return _wide ? static_cast<const uint32_t*>(_mappedCodes)[row] : static_cast<const uint16_t*>(_mappedCodes)[row];
+        return _wide ? _wideCodes[row] : _narrowCodes[row];
+    }
+
+    const std::string& GetValue(size_t row) const {
+        return GetDictionary().GetValue(GetCode(row));
+    }
+
+    float GetNumber(size_t row) const {
+        return (*_numbers)[GetCode(row)];
+    }
+
+    const DTDictionary& GetDictionary() const;
+    const std::shared_ptr<DTDictionary>& GetSharedDictionary() const;
+
+    bool MakeNumeric();
+    void MakeCategorical();
+    const std::vector<float>& GetNumbers() const;
+
+    template <typename Fn>
+    decltype(auto) VisitCodes(Fn&& fn) const {
+        CheckCodes();
+        if (_mappedCodes != nullptr)
+            return _wide ? fn(static_cast<const uint32_t*>(_mappedCodes)) : fn(static_cast<const uint16_t*>(_mappedCodes));
+        return _wide ? fn(_wideCodes.data()) : fn(_narrowCodes.data());
+    }
+
+    std::vector<bool> GetPresentCodes() const;
+
+    DTColumn Gather(const std::vector<size_t>& rows) const;
+    DTColumn Gather(std::span<const uint32_t> rows) const;
+    void Erase(size_t first, size_t last);
+};
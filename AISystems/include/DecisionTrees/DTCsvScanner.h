@@ -0,0 +1,83 @@
+#pragma once
+#include <bit>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DT_CSV_SSE2
+#endif
+
+// Ближайший разделитель или перевод строки; с SSE2 за одно сравнение проверяются 16 байт
+inline const char* DTFindSeparator(const char* pos, const char* end, char delimiter) {
+#ifdef DT_CSV_SSE2
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i newlines = _mm_set1_epi8('\n');
+    while (end - pos >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, delimiters), _mm_cmpeq_epi8(bytes, newlines));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0)
+            return pos + std::countr_zero(mask);
+        pos += 16;
+    }
+#endif
+    while (pos < end && *pos != delimiter && *pos != '\n')
+        ++pos;
+    return pos;
+}
+
+inline std::string_view DTStripQuotes(std::string_view token) {
+    if (!token.empty() && token.front() == '\"')
+        token.remove_prefix(1);
+    if (!token.empty() && token.back() == '\"')
+        token.remove_suffix(1);
+    return token;
+}
+
+// Построчный разбор отображённого файла: значения - это срезы исходного буфера без копирования
+class DTCsvScanner {
+private:
+    const char* _pos;
+    const char* _end;
+    char _delimiter;
+
+public:
+    DTCsvScanner(const char* begin, const char* end, char delimiter)
+        : _pos(begin), _end(end), _delimiter(delimiter) {
+    }
+
+    const char* Position() const {
+        return _pos;
+    }
+
+    bool NextLine(std::vector<std::string_view>& tokens) {
+        tokens.clear();
+        if (_pos >= _end)
+            return false;
+
+        const char* tokenStart = _pos;
+        while (true) {
+            const char* separator = DTFindSeparator(_pos, _end, _delimiter);
+            tokens.emplace_back(tokenStart, static_cast<size_t>(separator - tokenStart));
+            if (separator == _end || *separator == '\n') {
+                _pos = separator == _end ? _end : separator + 1;
+                break;
+            }
+            _pos = tokenStart = separator + 1;
+        }
+
+        // Окончание строки CRLF, пустая строка и разделитель в конце строки
+        // обрабатываются так же, как при чтении через std::getline
+        std::string_view& last = tokens.back();
+        if (!last.empty() && last.back() == '\r')
+            last.remove_suffix(1);
+        if (tokens.back().empty())
+            tokens.pop_back();
+
+        for (auto& token : tokens) {
+            token = DTStripQuotes(token);
+        }
+        return true;
+    }
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -9,30 +10,102 @@
 #include <algorithm>
 #include <functional>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include "DTColumn.h"
+#include "DTFeatureBins.h"
+#include "Utils/WorkStealingPool.h"
 
 class DTDataset
 {
+public:
+    struct LoadOptions {
+        char delimiter = ',';
+        bool hasHeader = true;
+        size_t threads = 1;
+        size_t chunkBytes = 8 << 20;
+        WorkStealingPool* pool = nullptr;
+        bool detectNumeric = false;
+        size_t featureBins = 0;
+    };
+
+    struct SortKey {
+        size_t column;
+        bool descending = false;
+    };
+
 private:
+    struct RankedKey {
+        size_t column;
+        std::vector<uint32_t> rankOfCode;
+        size_t rankCount;
+    };
+
+    struct TargetStats {
+        std::once_flag once;
+        std::vector<size_t> classCounts;
+        double entropy = 0.0;
+    };
+
     std::vector<std::string> _headers;
-    std::vector<std::vector<std::string>> _data;
+    std::vector<DTColumn> _columns;
+    size_t _numRows = 0;
     size_t _numColumns = 0;
     bool _headerLoaded = false;
     size_t _targetColumn = 0;
-    double _targetEntropy = 0;
+    std::shared_ptr<TargetStats> _targetStats = std::make_shared<TargetStats>();
+    std::shared_ptr<const DTFeatureBins> _featureBins;
 
-    std::vector<std::string> Split(const std::string& line, char delimiter);
-    void ValidateRow(const std::vector<std::string>& row, size_t lineIndex) const;
+    [[noreturn]] void ThrowRowError(size_t lineIndex, size_t tokenCount, size_t emptyColumn) const;
     std::vector<size_t> CalculateColumnWidths() const;
+    void CheckColumnIndex(size_t columnIndex) const;
+    DTDataset GatherRows(const std::vector<size_t>& rows, size_t skipColumn) const;
+    const TargetStats& GetTargetStats() const;
+    void ResetTargetStats();
+
+    template <typename Less>
+    static RankedKey RankCodes(size_t columnIndex, size_t cardinality, bool descending, const Less& less) {
+        // Ранг кода - место его значения в порядке сортировки; равные значения получают один ранг
+        std::vector<uint32_t> codes(cardinality);
+        std::iota(codes.begin(), codes.end(), 0u);
+        std::sort(codes.begin(), codes.end(), less);
+
+        RankedKey key{ columnIndex, std::vector<uint32_t>(cardinality), 0 };
+        for (size_t i = 0; i < codes.size(); ++i) {
+            if (i > 0 && less(codes[i - 1], codes[i]))
+                key.rankCount++;
+            key.rankOfCode[codes[i]] = static_cast<uint32_t>(key.rankCount);
+        }
+        if (!codes.empty())
+            key.rankCount++;
+        if (descending) {
+            for (uint32_t& rank : key.rankOfCode) {
+                rank = static_cast<uint32_t>(key.rankCount - 1 - rank);
+            }
+        }
+        return key;
+    }
+
+    RankedKey RankColumn(const SortKey& key) const;
+    std::vector<uint32_t> OrderRows(const std::vector<RankedKey>& keys) const;
 
 public:
     void LoadFromFile(const std::string& filename, char delimiter, bool hasHeader);
+    void LoadFromFile(const std::string& filename, const LoadOptions& options);
+    void SaveToBinaryFile(const std::string& filename) const;
+    void LoadFromBinaryFile(const std::string& filename, bool lazyColumns);
 
     const std::vector<std::string>& GetHeaders() const;
-    const std::vector<std::vector<std::string>>& GetData() const;
+    std::vector<std::vector<std::string>> GetData() const;
+    std::vector<std::string> GetRow(size_t rowIndex) const;
+    const std::string& GetValue(size_t rowIndex, size_t columnIndex) const;
+    const DTColumn& GetColumn(size_t columnIndex) const;
     size_t RowCount() const;
     size_t ColumnCount() const;
     size_t GetColumnIndex(const std::string& columnName) const;
     std::string GetColumnHeader(size_t columnIndex) const;
+    size_t MemoryUsage() const;
 
     void PrintSummary(size_t previewRows) const;
     void PrintDataSlice(size_t previewRows) const;
@@ -40,24 +113,57 @@ public:
     void PrintColumnStats(const std::string& columnName) const;
     void PrintDataStats() const;
 
-    void SortByColumn
-    (
-        size_t columnIndex,
-        const std::function<bool(const std::string&, const std::string&)>& comparator
-    );
-    void SortByColumn(
-        const std::string& columnName,
-        const std::function<bool(const std::string&, const std::string&)>& comparator
-    );
+    std::vector<uint32_t> GetSortOrder(const std::vector<SortKey>& keys) const;
+    void ApplyOrder(const std::vector<uint32_t>& order, WorkStealingPool* pool = nullptr);
+    void SortByColumns(const std::vector<SortKey>& keys, WorkStealingPool* pool = nullptr);
+    void SortByColumn(size_t columnIndex);
+    void SortByColumn(const std::string& columnName);
+
+    template <typename Compare>
+    void SortByColumn(size_t columnIndex, Compare comparator, WorkStealingPool* pool = nullptr) {
+        CheckColumnIndex(columnIndex);
+
+        // nullptr вместо сравнения - порядок по значению, как у SortByColumns
+        if constexpr (std::is_null_pointer_v<Compare>) {
+            SortByColumns({ { columnIndex, false } }, pool);
+        }
+        else {
+            // Сравниваются значения словаря, а не строки набора: сравнений O(k log k)
+            // по числу различных значений, после чего строки раскладываются по рангам
+            const auto& values = _columns[columnIndex].GetDictionary().GetValues();
+            auto less = [&values, &comparator](uint32_t a, uint32_t b) {
+                return comparator(values[a], values[b]);
+            };
+            ApplyOrder(OrderRows({ RankCodes(columnIndex, values.size(), false, less) }), pool);
+        }
+    }
+
+    template <typename Compare>
+    void SortByColumn(const std::string& columnName, Compare comparator, WorkStealingPool* pool = nullptr) {
+        SortByColumn(GetColumnIndex(columnName), comparator, pool);
+    }
 
     std::unordered_set<std::string> GetUniqueValues(size_t columnIndex) const;
     std::unordered_set<std::string> GetUniqueValues(const std::string& columnName) const;
 
+    void SetNumericColumn(size_t columnIndex);
+    void SetNumericColumn(const std::string& columnName);
+    void SetCategoricalColumn(size_t columnIndex);
+    bool IsNumericColumn(size_t columnIndex) const;
+    size_t DetectNumericColumns();
+
+    void BuildFeatureBins(size_t maxBins, WorkStealingPool* pool = nullptr);
+    void ClearFeatureBins();
+    const DTFeatureBins* GetFeatureBins() const;
+
     void SetTargetColumn(const std::string& columnName);
     void SetTargetColumn(size_t columnIndex);
     size_t GetTargetColumn() const;
     std::string GetTargetColumnHeader() const;
 
+    const std::vector<size_t>& GetClassCounts() const;
+    std::vector<size_t> GetClassCountsForFeature(size_t featureIndex) const;
+
     std::unordered_map<std::string, size_t> GetClassDistribution() const;
     std::unordered_map<std::string, std::unordered_map<std::string, size_t>>
         GetClassDistributionForFeature(size_t featureIndex) const;
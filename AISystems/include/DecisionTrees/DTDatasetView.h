@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "DTDataset.h"
+
+class DTDatasetView {
+private:
+    const DTDataset* _dataset = nullptr;
+    std::shared_ptr<std::vector<uint32_t>> _indexStorage;
+    std::span<uint32_t> _rows;
+    std::vector<bool> _activeFeatures;
+    size_t _numActiveFeatures = 0;
+    std::shared_ptr<std::vector<uint32_t>> _sortedStorage;
+    std::shared_ptr<const std::vector<size_t>> _sortedSlots;
+    std::vector<std::span<uint32_t>> _sortedRows;
+    mutable std::vector<size_t> _classCounts;
+    mutable bool _hasClassCounts = false;
+
+    DTDatasetView(const DTDatasetView& parent, std::span<uint32_t> rows, size_t removedFeature);
+    void InitFeatures();
+
+    template <typename ChildOf>
+    std::vector<std::vector<std::span<uint32_t>>> SplitSortedRows(const ChildOf& childOf, const std::vector<size_t>& offsets);
+
+public:
+    static constexpr size_t NoSlot = static_cast<size_t>(-1);
+
+    explicit DTDatasetView(const DTDataset& dataset);
+    DTDatasetView(const DTDataset& dataset, std::vector<uint32_t> rows);
+    DTDatasetView Clone() const;
+
+    const DTDataset& GetDataset() const;
+    std::span<const uint32_t> GetRows() const;
+    size_t RowCount() const;
+    size_t GetTargetColumn() const;
+
+    bool IsFeatureActive(size_t columnIndex) const;
+    bool IsFeatureNumeric(size_t columnIndex) const;
+    size_t ActiveFeatureCount() const;
+    size_t GetActiveFeatureRank(size_t columnIndex) const;
+
+    uint32_t GetCode(size_t viewRow, size_t columnIndex) const {
+        return _dataset->GetColumn(columnIndex).GetCode(_rows[viewRow]);
+    }
+
+    const std::vector<size_t>& GetClassCounts() const;
+    void SetClassCounts(std::vector<size_t> classCounts);
+    std::vector<size_t> GetClassCountsForFeature(size_t featureIndex) const;
+    double CalculateEntropy() const;
+    bool AllSameTargetValue() const;
+
+    void PresortNumericFeatures();
+    bool IsPresorted() const;
+    bool HasSortedRows(size_t columnIndex) const;
+    std::span<const uint32_t> GetSortedRows(size_t columnIndex) const;
+
+    std::vector<std::pair<uint32_t, DTDatasetView>> Partition(size_t featureIndex);
+    std::pair<DTDatasetView, DTDatasetView> PartitionByThreshold(size_t featureIndex, float threshold);
+    std::pair<DTDatasetView, DTDatasetView> PartitionBySubset(size_t featureIndex, const std::vector<bool>& inSubset);
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "DTColumn.h"
+#include "Utils/WorkStealingPool.h"
+
+class DTDataset;
+
+class DTFeatureBins {
+public:
+    static constexpr size_t MaxBins = 256;
+    static constexpr uint32_t GroupedValues = std::numeric_limits<uint32_t>::max();
+
+    struct ColumnBins {
+        bool numeric = false;
+        std::vector<uint8_t> binOfCode;
+        std::vector<uint32_t> codeOfBin;
+        std::vector<float> thresholds;
+        std::vector<uint8_t> rows;
+
+        size_t BinCount() const;
+    };
+
+private:
+    size_t _maxBins = 0;
+    std::vector<ColumnBins> _columns;
+
+    static void BuildCategorical(const std::vector<size_t>& counts, size_t maxBins, ColumnBins& bins);
+    static void BuildNumeric(const DTColumn& column, const std::vector<size_t>& counts, size_t maxBins, size_t numRows, ColumnBins& bins);
+
+public:
+    static DTFeatureBins Build(const DTDataset& dataset, size_t maxBins, WorkStealingPool* pool = nullptr);
+
+    size_t MaxBinCount() const;
+    size_t ColumnCount() const;
+    const ColumnBins& GetColumn(size_t columnIndex) const;
+    size_t MemoryUsage() const;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DTColumn.h"
+#include "DTCsvScanner.h"
+#include "DTDataset.h"
+#include "Utils/MappedFile.h"
+
+struct DTCodeChunk {
+    size_t rows = 0;
+    std::vector<std::vector<uint32_t>> columns;
+};
+
+class DTRowSource {
+public:
+    virtual ~DTRowSource() = default;
+
+    virtual const std::vector<std::string>& GetHeaders() const = 0;
+    virtual size_t ColumnCount() const = 0;
+    virtual const DTDictionary& GetDictionary(size_t columnIndex) const = 0;
+    virtual bool DictionariesComplete() const = 0;
+
+    virtual void Rewind() = 0;
+    virtual bool ReadChunk(DTCodeChunk& chunk, size_t maxRows) = 0;
+};
+
+class DTDatasetRowSource : public DTRowSource {
+private:
+    const DTDataset& _dataset;
+    size_t _position = 0;
+
+public:
+    explicit DTDatasetRowSource(const DTDataset& dataset)
+        : _dataset(dataset) {
+    }
+
+    const std::vector<std::string>& GetHeaders() const override;
+    size_t ColumnCount() const override;
+    const DTDictionary& GetDictionary(size_t columnIndex) const override;
+    bool DictionariesComplete() const override;
+
+    void Rewind() override;
+    bool ReadChunk(DTCodeChunk& chunk, size_t maxRows) override;
+};
+
+class DTCsvRowSource : public DTRowSource {
+private:
+    MappedFile _file;
+    char _delimiter;
+    std::vector<std::string> _headers;
+    std::vector<DTDictionary> _dictionaries;
+    const char* _dataStart = nullptr;
+    size_t _headerLines = 0;
+    DTCsvScanner _scanner;
+    size_t _lineNumber = 0;
+    bool _complete = false;
+    std::vector<std::string_view> _tokens;
+
+    [[noreturn]] void ThrowRowError(size_t tokenCount, size_t emptyColumn) const;
+
+public:
+    DTCsvRowSource(const std::string& filename, char delimiter, bool hasHeader);
+
+    const std::vector<std::string>& GetHeaders() const override;
+    size_t ColumnCount() const override;
+    const DTDictionary& GetDictionary(size_t columnIndex) const override;
+    bool DictionariesComplete() const override;
+
+    void Rewind() override;
+    bool ReadChunk(DTCodeChunk& chunk, size_t maxRows) override;
+};
@@ -1,28 +1,73 @@
 #pragma once
+#include <span>
 #include <sstream>
 #include "Nodes/Node.h"
 #include "Nodes/DecisionNode.h"
 #include "Nodes/LeafNode.h"
+#include "Nodes/ThresholdNode.h"
+#include "Nodes/SubsetNode.h"
+#include "NodeArena.h"
+#include "FlatTree.h"
 #include "../DTDataset.h"
+#include "Utils/WorkStealingPool.h"
 
 class DecisionTree {
+public:
+    struct PredictOptions {
+        size_t threads = 1;
+        size_t taskRows = 16384;
+        WorkStealingPool* pool = nullptr;
+    };
+
 private:
-    std::unique_ptr<Node> _root;
+    std::unique_ptr<NodeArena> _nodes;
     std::vector<std::string> _headers;
     size_t _targetColumn = 0;
+    FlatTree _flatTree;
     std::ostringstream _buildingProcessOSS;
 
+    void Compile();
+    void CheckSampleSize(const std::vector<std::string>& sample) const;
+    void CheckDataset(const DTDataset& dataset) const;
+    void CheckBufferSize(size_t bufferSize, size_t rowCount) const;
+
+    template <typename CodeOf, typename ValueOf, typename Store>
+    void PredictRows(size_t rowCount, const PredictOptions& options, const CodeOf& codeOf, const ValueOf& valueOf, const Store& store) const;
+
+    template <typename RowOf, typename Store>
+    void PredictDataset(const DTDataset& dataset, size_t rowCount, const RowOf& rowOf, const PredictOptions& options, const Store& store) const;
+
+    template <typename Store>
+    void PredictSamples(const std::vector<std::vector<std::string>>& samples, const PredictOptions& options, const Store& store) const;
+
     void PrintPredictionsTable(const std::vector<std::vector<std::string>>& data, const std::vector<std::string>& predictions) const;
 
 public:
-    void SetRoot(std::unique_ptr<Node> root);
+    void SetNodes(std::unique_ptr<NodeArena> nodes);
     void SetHeaders(const std::vector<std::string>& headers);
     void SetTargetColumn(size_t targetColumn);
 
+    const Node* GetRoot() const;
+    const std::vector<std::string>& GetHeaders() const;
+    size_t GetTargetColumn() const;
+    const FlatTree& GetFlatTree() const;
+
+    void Save(const std::string& filename) const;
+    static DecisionTree Load(const std::string& filename);
+
+    uint32_t PredictClass(const std::vector<std::string>& sample) const;
+    const std::string& GetClassLabel(uint32_t classId) const;
+
     std::string Predict(const std::vector<std::string>& sample) const;
     void Predict(const std::vector<std::vector<std::string>>& testData) const;
     void Predict(const DTDataset& testDataset) const;
 
+    void PredictBatch(const DTDataset& dataset, std::span<uint32_t> classIds, const PredictOptions& options) const;
+    void PredictBatch(const DTDataset& dataset, std::span<std::string> labels, const PredictOptions& options) const;
+    void PredictBatch(const DTDataset& dataset, std::span<const uint32_t> rows, std::span<uint32_t> classIds, const PredictOptions& options) const;
+    void PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<uint32_t> classIds, const PredictOptions& options) const;
+    void PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<std::string> labels, const PredictOptions& options) const;
+
     std::ostringstream& GetBuildingProcessOSS();
     void ClearBuildingProcessOSS();
     std::string GetBuildingProcessDescr() const;
@@ -0,0 +1,168 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "Nodes/Node.h"
+#include "Nodes/DecisionNode.h"
+#include "Nodes/LeafNode.h"
+#include "Nodes/ThresholdNode.h"
+#include "Nodes/SubsetNode.h"
+#include "../DTColumn.h"
+#include "Utils/MappedFile.h"
+
+class FlatTree {
+public:
+    static constexpr uint32_t LeafFeature = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NoChild = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t ThresholdSplit = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t SubsetSplit = std::numeric_limits<uint32_t>::max() - 1;
+    static constexpr size_t BlockSize = 256;
+    static constexpr uint32_t FormatVersion = 4;
+
+    struct FlatNode {
+        uint32_t feature;
+        uint32_t firstCode;
+        uint32_t codeCount;
+        uint32_t offset;
+    };
+    static_assert(sizeof(FlatNode) == 16, "Узел плоского дерева должен занимать 16 байт");
+
+private:
+    std::vector<FlatNode> _ownedNodes;
+    std::vector<uint32_t> _ownedChildTable;
+    std::shared_ptr<const MappedFile> _mapping;
+    std::span<const FlatNode> _nodes;
+    std::span<const uint32_t> _childTable;
+    std::vector<DTDictionary> _featureValues;
+    std::vector<size_t> _featureColumns;
+    std::vector<uint8_t> _featureNumeric;
+    DTDictionary _classes;
+    uint32_t _unknownClass = 0;
+
+    void BindOwned();
+    void IndexNumericFeatures();
+    void ConvertLegacyNodes(const char* nodes, size_t nodeCount);
+    void Validate() const;
+    void PrintNode(uint32_t index, const std::vector<std::string>& headers, int depth, bool isLastChild, const std::string& parentIndent) const;
+
+public:
+    FlatTree() = default;
+    FlatTree(const FlatTree&) = delete;
+    FlatTree& operator=(const FlatTree&) = delete;
+    FlatTree(FlatTree&& other) noexcept;
+    FlatTree& operator=(FlatTree&& other) noexcept;
+
+    static FlatTree Compile(const Node& root, const std::vector<std::string>& headers, size_t targetColumn);
+
+    void Save(std::ostream& out, const std::vector<std::string>& headers, size_t targetColumn) const;
+    static FlatTree Load(std::shared_ptr<const MappedFile> file, std::vector<std::string>& headers, size_t& targetColumn);
+
+    bool Empty() const;
+    size_t NodeCount() const;
+    size_t FeatureCount() const;
+    size_t ClassCount() const;
+    size_t MemoryUsage() const;
+
+    bool IsMapped() const;
+    std::span<const FlatNode> GetNodes() const;
+    std::span<const uint32_t> GetChildTable() const;
+    const DTDictionary& GetFeatureValues(size_t feature) const;
+    size_t GetFeatureColumn(size_t feature) const;
+    bool IsFeatureNumeric(size_t feature) const;
+    const DTDictionary& GetClasses() const;
+    uint32_t GetUnknownClass() const;
+    const std::string& GetClassLabel(uint32_t classId) const;
+
+    static uint32_t ThresholdBranch(float value, float threshold) {
+        // 0 - не больше порога, 1 - больше; NaN не проходит ни одно сравнение и ветви не имеет
+        return value <= threshold ? 0 : (value > threshold ? 1 : 2);
+    }
+
+    float GetThreshold(uint32_t offset) const {
+        // Порог лежит в таблице потомков за двумя ячейками потомков, узел остаётся 16-байтным
+        return std::bit_cast<float>(_childTable[offset + 2]);
+    }
+
+    uint32_t SubsetBranch(uint32_t code, uint32_t offset) const {
+        // За двумя ячейками потомков лежат число слов и слова битового множества кодов первой ветви.
+        // 0 - код в подмножестве, 1 - прочие, включая NoCode и значения, не встречавшиеся при обучении
+        uint32_t word = code / 32;
+        return word < _childTable[offset + 2] && ((_childTable[offset + 3 + word] >> (code % 32)) & 1) != 0 ? 0 : 1;
+    }
+
+    template <typename CodeOf, typename ValueOf>
+    uint32_t PredictClassBy(CodeOf&& codeOf, ValueOf&& valueOf) const {
+        uint32_t index = 0;
+        while (true) {
+            const FlatNode& node = _nodes[index];
+            if (node.feature == LeafFeature)
+                return node.offset;
+
+            // NoCode и значения вне диапазона узла дают переполнение и отсекаются одним сравнением
+            uint32_t local;
+            if (node.firstCode == ThresholdSplit)
+                local = ThresholdBranch(valueOf(node.feature), GetThreshold(node.offset));
+            else if (node.firstCode == SubsetSplit)
+                local = SubsetBranch(codeOf(node.feature), node.offset);
+            else
+                local = codeOf(node.feature) - node.firstCode;
+            if (local >= node.codeCount)
+                return _unknownClass;
+
+            uint32_t child = _childTable[node.offset + local];
+            if (child == NoChild)
+                return _unknownClass;
+            index = child;
+        }
+    }
+
+    template <typename CodeOf, typename ValueOf>
+    void PredictBlock(size_t count, CodeOf&& codeOf, ValueOf&& valueOf, uint32_t* classIds) const {
+        uint32_t nodes[BlockSize];
+        uint16_t active[BlockSize];
+        for (size_t row = 0; row < count; ++row) {
+            nodes[row] = 0;
+            active[row] = static_cast<uint16_t>(row);
+        }
+
+        // Все строки блока спускаются на один уровень за проход: верхние узлы
+        // остаются в кэше, а дошедшие до листа строки выбывают из списка
+        size_t activeCount = count;
+        while (activeCount != 0) {
+            size_t next = 0;
+            for (size_t i = 0; i < activeCount; ++i) {
+                uint16_t row = active[i];
+                const FlatNode& node = _nodes[nodes[row]];
+                if (node.feature == LeafFeature) {
+                    classIds[row] = node.offset;
+                    continue;
+                }
+
+                uint32_t local;
+                if (node.firstCode == ThresholdSplit)
+                    local = ThresholdBranch(valueOf(row, node.feature), GetThreshold(node.offset));
+                else if (node.firstCode == SubsetSplit)
+                    local = SubsetBranch(codeOf(row, node.feature), node.offset);
+                else
+                    local = codeOf(row, node.feature) - node.firstCode;
+                uint32_t child = local < node.codeCount ? _childTable[node.offset + local] : NoChild;
+                if (child == NoChild) {
+                    classIds[row] = _unknownClass;
+                    continue;
+                }
+
+                nodes[row] = child;
+                active[next++] = row;
+            }
+            activeCount = next;
+        }
+    }
+
+    uint32_t PredictClass(const std::vector<std::string>& sample) const;
+    void Print(const std::vector<std::string>& headers) const;
+};
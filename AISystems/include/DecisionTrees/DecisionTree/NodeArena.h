@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+class Node;
+
+class NodeArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t FirstBlockSize = 16 * 1024;
+    static constexpr size_t MaxBlockSize = 1024 * 1024;
+
+private:
+    std::vector<std::unique_ptr<std::byte[]>> _blocks;
+    std::byte* _current = nullptr;
+    size_t _remaining = 0;
+    size_t _nextBlockSize = FirstBlockSize;
+    size_t _reservedBytes = 0;
+    size_t _usedBytes = 0;
+    const Node* _root = nullptr;
+    std::mutex _mutex;
+
+    std::byte* AllocateBlock(size_t size);
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)..., this);
+    }
+
+    void SetRoot(const Node* root);
+    const Node* GetRoot() const;
+
+    size_t BlockCount() const;
+    size_t UsedBytes() const;
+    size_t MemoryUsage() const;
+};
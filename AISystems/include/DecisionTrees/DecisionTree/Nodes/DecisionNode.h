@@ -2,16 +2,22 @@
 #include "Node.h"
 
 class DecisionNode : public Node {
+public:
+    using Child = std::pair<std::pmr::string, const Node*>;
+
 private:
-    std::string _featureName;
-    std::unordered_map<std::string, std::unique_ptr<Node>> _children;
+    std::pmr::string _featureName;
+    std::pmr::vector<Child> _children;
 
 public:
-    DecisionNode(const std::string& featureName)
-        : _featureName(featureName) {
+    DecisionNode(std::string_view featureName, std::pmr::memory_resource* resource)
+        : _featureName(featureName, resource), _children(resource) {
     }
 
-    void AddChild(const std::string& value, std::unique_ptr<Node> child);
+    void ReserveChildren(size_t count);
+    void AddChild(std::string_view value, const Node* child);
+    std::string_view GetFeatureName() const;
+    const std::pmr::vector<Child>& GetChildren() const;
     std::string Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const override;
     void Print(int depth, bool isLastChild, const std::string& parentIndent) const override;
 };
\ No newline at end of file
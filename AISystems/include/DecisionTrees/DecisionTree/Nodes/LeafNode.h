@@ -3,13 +3,14 @@
 
 class LeafNode : public Node {
 private:
-    std::string _result;
+    std::pmr::string _result;
 
 public:
-    LeafNode(const std::string& result)
-        : _result(result) {
+    LeafNode(std::string_view result, std::pmr::memory_resource* resource)
+        : _result(result, resource) {
     }
 
+    std::string_view GetResult() const;
     std::string Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const override;
     void Print(int depth, bool isLastChild, const std::string& parentIndent) const override;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
 #include <iomanip>
 #include <iostream>
 
@@ -0,0 +1,31 @@
+#pragma once
+#include "Node.h"
+
+class SubsetNode : public Node {
+public:
+    static constexpr size_t PrintedValues = 8;
+
+private:
+    std::pmr::string _featureName;
+    std::pmr::vector<std::pmr::string> _values;
+    const Node* _inSubset = nullptr;
+    const Node* _other = nullptr;
+
+public:
+    SubsetNode(std::string_view featureName, std::pmr::memory_resource* resource)
+        : _featureName(featureName, resource), _values(resource) {
+    }
+
+    void ReserveValues(size_t count);
+    void AddValue(std::string_view value);
+    void SetChildren(const Node* inSubset, const Node* other);
+    std::string_view GetFeatureName() const;
+    const std::pmr::vector<std::pmr::string>& GetValues() const;
+    bool Contains(std::string_view value) const;
+    const Node* GetInSubset() const;
+    const Node* GetOther() const;
+    std::string Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const override;
+    void Print(int depth, bool isLastChild, const std::string& parentIndent) const override;
+
+    static std::string DescribeValues(const std::vector<std::string_view>& values);
+};
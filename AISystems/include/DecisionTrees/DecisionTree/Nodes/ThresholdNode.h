@@ -0,0 +1,23 @@
+#pragma once
+#include "Node.h"
+
+class ThresholdNode : public Node {
+private:
+    std::pmr::string _featureName;
+    float _threshold;
+    const Node* _lessOrEqual = nullptr;
+    const Node* _greater = nullptr;
+
+public:
+    ThresholdNode(std::string_view featureName, float threshold, std::pmr::memory_resource* resource)
+        : _featureName(featureName, resource), _threshold(threshold) {
+    }
+
+    void SetChildren(const Node* lessOrEqual, const Node* greater);
+    std::string_view GetFeatureName() const;
+    float GetThreshold() const;
+    const Node* GetLessOrEqual() const;
+    const Node* GetGreater() const;
+    std::string Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const override;
+    void Print(int depth, bool isLastChild, const std::string& parentIndent) const override;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+#include "DecisionTrees/BuildAlgorithms/ID3.h"
+#include "DecisionTrees/DTDataset.h"
+#include "Utils/WorkStealingPool.h"
+
+class CrossValidation {
+public:
+    struct Options {
+        size_t folds = 5;
+        bool stratified = true;
+        bool shuffle = true;
+        uint64_t seed = 0;
+        size_t threads = 1;
+        WorkStealingPool* pool = nullptr;
+        ID3::Options treeOptions;
+    };
+
+    struct FoldResult {
+        size_t trainRows = 0;
+        size_t testRows = 0;
+        size_t correct = 0;
+        double accuracy = 0.0;
+        size_t nodes = 0;
+        std::vector<size_t> confusion;
+        double trainSeconds = 0.0;
+        double predictSeconds = 0.0;
+    };
+
+    struct Result {
+        std::vector<std::string> classes;
+        std::vector<FoldResult> folds;
+        std::vector<size_t> confusion;
+        size_t testRows = 0;
+        size_t correct = 0;
+        double accuracy = 0.0;
+        double meanAccuracy = 0.0;
+        double stdAccuracy = 0.0;
+        double seconds = 0.0;
+    };
+
+private:
+    static void CheckOptions(const DTDataset& dataset, const Options& options);
+
+public:
+    static std::vector<std::vector<uint32_t>> MakeFolds(const DTDataset& dataset, const Options& options);
+    static std::vector<uint32_t> MakeHoldout(const DTDataset& dataset, double testFraction, const Options& options);
+
+    // Один блок: обучение на копии training, проверка на testRows. Перебор параметров
+    // готовит обучающее представление блока один раз и оценивает на нём все испытания
+    static DTDatasetView MakeTrainingView(const DTDataset& dataset, const std::vector<uint32_t>& testRows);
+    static FoldResult EvaluateFold
+    (
+        const DTDatasetView& training,
+        const std::vector<uint32_t>& testRows,
+        const Options& options,
+        WorkStealingPool* pool,
+        const DTFeatureBins* bins
+    );
+
+    static Result Evaluate(const DTDataset& dataset);
+    static Result Evaluate(const DTDataset& dataset, const Options& options);
+    static Result Evaluate(const DTDataset& dataset, const std::vector<std::vector<uint32_t>>& testSets, const Options& options);
+    static Result Holdout(const DTDataset& dataset, double testFraction, const Options& options);
+
+    static void PrintResult(const Result& result);
+};
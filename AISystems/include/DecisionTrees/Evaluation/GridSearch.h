@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DecisionTrees/BuildAlgorithms/ID3.h"
+#include "DecisionTrees/DTDataset.h"
+#include "CrossValidation.h"
+#include "Utils/WorkStealingPool.h"
+
+class GridSearch {
+public:
+    struct Grid {
+        std::vector<size_t> maxDepth = { 0 };
+        std::vector<size_t> minSamplesSplit = { 0 };
+        std::vector<double> minGain = { 0.0 };
+        std::vector<size_t> featureSubset = { 0 };
+        std::vector<SplitCriterion> criterion = { SplitCriterion::InformationGain };
+        std::vector<ID3::CategoricalSplit> categoricalSplit = { ID3::CategoricalSplit::Multiway };
+    };
+
+    struct Options {
+        CrossValidation::Options validation;
+        bool earlyStopping = true;
+        size_t minFolds = 2;
+        double stoppingMargin = 0.02;
+    };
+
+    struct Trial {
+        ID3::Options treeOptions;
+        std::vector<CrossValidation::FoldResult> folds;
+        double meanAccuracy = 0.0;
+        double stdAccuracy = 0.0;
+        double meanNodes = 0.0;
+        double seconds = 0.0;
+        bool stopped = false;
+    };
+
+    struct Result {
+        std::vector<Trial> trials;
+        size_t best = 0;
+        size_t foldsRun = 0;
+        size_t foldsSkipped = 0;
+        double seconds = 0.0;
+    };
+
+private:
+    static std::vector<ID3::Options> ExpandGrid(const Grid& grid, const ID3::Options& base);
+    static void Summarize(Trial& trial);
+    static std::string Describe(const ID3::Options& options);
+
+public:
+    static Result Search(const DTDataset& dataset, const Grid& grid);
+    static Result Search(const DTDataset& dataset, const Grid& grid, const Options& options);
+    static Result Search(const DTDataset& dataset, const std::vector<ID3::Options>& configurations, const Options& options);
+
+    static void PrintResult(const Result& result);
+};
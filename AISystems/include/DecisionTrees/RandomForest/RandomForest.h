@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "DecisionTrees/DecisionTree/DecisionTree.h"
+#include "DecisionTrees/BuildAlgorithms/ID3.h"
+#include "DecisionTrees/DTDataset.h"
+#include "Utils/WorkStealingPool.h"
+
+class RandomForest {
+public:
+    struct Options {
+        size_t treeCount = 100;
+        size_t featureSubset = 0;
+        double sampleFraction = 1.0;
+        uint64_t seed = 0;
+        size_t threads = 1;
+        WorkStealingPool* pool = nullptr;
+        ID3::Options treeOptions;
+    };
+
+    using PredictOptions = DecisionTree::PredictOptions;
+
+private:
+    std::vector<DecisionTree> _trees;
+    std::vector<std::vector<uint32_t>> _treeClasses;
+    DTDictionary _classes;
+    uint32_t _unknownClass = 0;
+
+    void CheckTrained() const;
+    void CheckBufferSize(size_t bufferSize, size_t rowCount) const;
+    uint32_t SelectClass(const uint32_t* votes) const;
+
+    template <typename PredictTree>
+    void Vote(size_t rowCount, const PredictOptions& options, const PredictTree& predictTree, std::span<uint32_t> classIds) const;
+
+public:
+    static RandomForest Train(const DTDataset& dataset);
+    static RandomForest Train(const DTDataset& dataset, const Options& options);
+
+    size_t TreeCount() const;
+    const DecisionTree& GetTree(size_t index) const;
+    const DTDictionary& GetClasses() const;
+    const std::string& GetClassLabel(uint32_t classId) const;
+
+    uint32_t PredictClass(const std::vector<std::string>& sample) const;
+    std::string Predict(const std::vector<std::string>& sample) const;
+
+    void PredictBatch(const DTDataset& dataset, std::span<uint32_t> classIds, const PredictOptions& options) const;
+    void PredictBatch(const DTDataset& dataset, std::span<std::string> labels, const PredictOptions& options) const;
+    void PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<uint32_t> classIds, const PredictOptions& options) const;
+    void PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<std::string> labels, const PredictOptions& options) const;
+};
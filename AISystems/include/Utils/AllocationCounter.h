@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class AllocationCounter {
+public:
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+private:
+    static std::atomic<uint64_t> _count;
+    static std::atomic<uint64_t> _bytes;
+    static std::atomic<bool> _installed;
+    static thread_local uint64_t _threadCount;
+    static thread_local uint64_t _threadBytes;
+
+public:
+    static void Install();
+    static bool IsInstalled();
+
+    static void Record(size_t bytes) {
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _bytes.fetch_add(bytes, std::memory_order_relaxed);
+        _threadCount++;
+        _threadBytes += bytes;
+    }
+
+    static Snapshot Current();
+    static Snapshot CurrentThread();
+};
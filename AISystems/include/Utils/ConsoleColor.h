@@ -3,7 +3,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #endif
-#include <io.h> //  isatty
+#include <io.h> // Для isatty
 
 class ConsoleColor {
 public:
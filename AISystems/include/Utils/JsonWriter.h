@@ -0,0 +1,9 @@
+#pragma once
+#include <ostream>
+#include <string>
+
+class JsonWriter {
+public:
+    // Строка в кавычках с экранированием по JSON; байты UTF-8 выводятся как есть
+    static void WriteString(std::ostream& out, const std::string& value);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+    bool _open = false;
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const;
+    const char* Data() const;
+    size_t Size() const;
+    std::string_view View() const;
+    void Prefetch(size_t offset, size_t size) const;
+};
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+
+class ProcessMemory {
+public:
+    static size_t PeakResidentBytes();
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    class TaskGroup {
+    private:
+        std::atomic<size_t> _pending{ 0 };
+        std::exception_ptr _error;
+        std::mutex _errorMutex;
+
+        friend class WorkStealingPool;
+    };
+
+private:
+    struct Task {
+        std::function<void()> function;
+        TaskGroup* group = nullptr;
+    };
+
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::atomic<size_t> _queuedTasks{ 0 };
+    std::atomic<size_t> _nextExternal{ 0 };
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    bool _stopping = false;
+
+    void WorkerLoop(size_t index);
+    bool TryPop(size_t index, Task& task);
+    bool TrySteal(size_t thief, Task& task);
+    bool TryRunOne(size_t index);
+    void Execute(Task& task);
+    size_t CurrentWorker() const;
+
+public:
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Пул вызывающего, а если его нет и работу стоит распараллелить - собственный пул на threads
+    // потоков (0 - по числу аппаратных), которым владеет own; в последовательном режиме nullptr
+    static WorkStealingPool* Resolve(WorkStealingPool* pool, size_t threads, std::unique_ptr<WorkStealingPool>& own, bool parallelWork = true);
+
+    size_t ThreadCount() const;
+
+    void Submit(TaskGroup& group, std::function<void()> task);
+    void Wait(TaskGroup& group);
+
+    template <typename Fn>
+    void ParallelFor(size_t count, Fn&& fn) {
+        TaskGroup group;
+        for (size_t i = 0; i < count; ++i) {
+            Submit(group, [&fn, i]() { fn(i); });
+        }
+        Wait(group);
+    }
+};
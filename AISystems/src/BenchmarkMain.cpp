@@ -0,0 +1,243 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include <../include/Benchmarks/BenchmarkRunner.h>
+#include <../include/Benchmarks/RegressionCheck.h>
+#include <../include/Benchmarks/SyntheticDataset.h>
+#include <../include/DecisionTrees/DTDataset.h>
+#include <../include/DecisionTrees/DTDatasetView.h>
+#include <../include/DecisionTrees/BuildAlgorithms/ID3.h>
+#include <../include/Utils/AllocationCounter.h>
+
+namespace {
+    struct BenchmarkOptions {
+        SyntheticDataset::Options dataset;
+        size_t iterations = 5;
+        size_t threads = 1;
+        size_t predictSamples = 10000;
+        std::string csvPath = "benchmark_synthetic.csv";
+        std::string outputPath;
+        std::string profilePath;
+        bool keepCsv = false;
+        bool check = false;
+    };
+
+    void PrintUsage() {
+        std::cout <<
+            "Использование: AISystemsBench [параметры]\n"
+            "  --rows N            число строк синтетического набора (100000)\n"
+            "  --features N        число признаков (10)\n"
+            "  --cardinality N     число значений каждого признака (8)\n"
+            "  --classes N         число классов (2)\n"
+            "  --imbalance R       отношение частот самого частого и самого редкого класса (1)\n"
+            "  --noise P           доля строк со случайным классом (0.1)\n"
+            "  --seed N            зерно генератора (1)\n"
+            "  --iterations N      повторов каждого замера (5)\n"
+            "  --threads N         потоков загрузки, обучения и предсказания (1, 0 - все ядра)\n"
+            "  --predict-samples N строк для замера одиночных предсказаний (10000)\n"
+            "  --csv PATH          куда записать синтетический CSV (benchmark_synthetic.csv)\n"
+            "  --keep-csv          не удалять CSV после замеров\n"
+            "  --output PATH       файл для отчёта JSON (по умолчанию - стандартный вывод)\n"
+            "  --profile PATH      записать профиль одного обучения в формате Chrome trace\n"
+            "  --check             вместо замеров проверить, что дерево не зависит от потоков,\n"
+            "                      поиска разбиений и описания, а старые модели читаются\n";
+    }
+
+    BenchmarkOptions ParseArguments(int argc, char* argv[]) {
+        BenchmarkOptions options;
+        for (int i = 1; i < argc; ++i) {
+            std::string name = argv[i];
+            if (name == "--keep-csv") {
+                options.keepCsv = true;
+                continue;
+            }
+            if (name == "--check") {
+                options.check = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Не задано значение параметра " + name);
+
+            std::string value = argv[++i];
+            if (name == "--rows") options.dataset.rows = std::stoull(value);
+            else if (name == "--features") options.dataset.features = std::stoull(value);
+            else if (name == "--cardinality") options.dataset.cardinality = std::stoull(value);
+            else if (name == "--classes") options.dataset.classes = std::stoull(value);
+            else if (name == "--imbalance") options.dataset.imbalance = std::stod(value);
+            else if (name == "--noise") options.dataset.noise = std::stod(value);
+            else if (name == "--seed") options.dataset.seed = std::stoull(value);
+            else if (name == "--iterations") options.iterations = std::stoull(value);
+            else if (name == "--threads") options.threads = std::stoull(value);
+            else if (name == "--predict-samples") options.predictSamples = std::stoull(value);
+            else if (name == "--csv") options.csvPath = value;
+            else if (name == "--output") options.outputPath = value;
+            else if (name == "--profile") options.profilePath = value;
+            else throw std::invalid_argument("Неизвестный параметр: " + name);
+        }
+        return options;
+    }
+
+    // Проверка регрессий на категориальном и числовом вариантах синтетического набора;
+    // код возврата ненулевой при любом расхождении
+    int RunChecks(const BenchmarkOptions& options) {
+        bool passed = true;
+        for (bool numeric : { false, true }) {
+            SyntheticDataset::Options synthetic = options.dataset;
+            synthetic.numeric = numeric;
+            SyntheticDataset::WriteCsv(options.csvPath, synthetic);
+
+            DTDataset::LoadOptions loadOptions;
+            loadOptions.delimiter = synthetic.delimiter;
+            loadOptions.threads = options.threads;
+            loadOptions.detectNumeric = numeric;
+            DTDataset dataset;
+            dataset.LoadFromFile(options.csvPath, loadOptions);
+
+            std::cout << (numeric ? "Числовые признаки:\n" : "Категориальные признаки:\n");
+            passed = RegressionCheck::Run(dataset, options.threads, options.csvPath + ".model", std::cout) && passed;
+            if (!numeric) {
+                passed = RegressionCheck::RunStreaming(dataset, options.csvPath, synthetic.delimiter, std::cout) && passed;
+                passed = RegressionCheck::RunIncremental(dataset, std::cout) && passed;
+            }
+
+            passed = RegressionCheck::RunCrossValidation(dataset, options.threads, std::cout) && passed;
+            passed = RegressionCheck::RunGridSearch(dataset, options.threads, std::cout) && passed;
+
+            // Проверочный набор для обрезки - те же признаки с другим зерном
+            const std::string validationPath = options.csvPath + ".validation";
+            synthetic.seed++;
+            SyntheticDataset::WriteCsv(validationPath, synthetic);
+            passed = RegressionCheck::RunPruning(dataset, validationPath, loadOptions, std::cout) && passed;
+            std::filesystem::remove(validationPath);
+        }
+        if (!options.keepCsv)
+            std::filesystem::remove(options.csvPath);
+
+        std::cout << (passed ? "Все проверки пройдены\n" : "Есть расхождения\n");
+        return passed ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    AllocationCounter::Install();
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--help") {
+            PrintUsage();
+            return 0;
+        }
+    }
+
+    try {
+        BenchmarkOptions options = ParseArguments(argc, argv);
+        if (options.check)
+            return RunChecks(options);
+
+        const SyntheticDataset::Options& synthetic = options.dataset;
+        size_t fileBytes = SyntheticDataset::WriteCsv(options.csvPath, synthetic);
+
+        BenchmarkRunner runner(options.iterations);
+        runner.AddParameter("rows", static_cast<double>(synthetic.rows));
+        runner.AddParameter("features", static_cast<double>(synthetic.features));
+        runner.AddParameter("cardinality", static_cast<double>(synthetic.cardinality));
+        runner.AddParameter("classes", static_cast<double>(synthetic.classes));
+        runner.AddParameter("imbalance", synthetic.imbalance);
+        runner.AddParameter("noise", synthetic.noise);
+        runner.AddParameter("seed", static_cast<double>(synthetic.seed));
+        runner.AddParameter("threads", static_cast<double>(options.threads));
+        runner.AddParameter("csvBytes", static_cast<double>(fileBytes));
+
+        DTDataset::LoadOptions loadOptions;
+        loadOptions.delimiter = synthetic.delimiter;
+        loadOptions.threads = options.threads;
+
+        // Результаты замеров складываются сюда, чтобы компилятор не выбросил вычисления
+        volatile double sink = 0.0;
+
+        runner.Run("LoadFromFile", synthetic.rows, [&]() {
+            DTDataset dataset;
+            dataset.LoadFromFile(options.csvPath, loadOptions);
+            sink = sink + static_cast<double>(dataset.RowCount());
+        });
+
+        DTDataset dataset;
+        dataset.LoadFromFile(options.csvPath, loadOptions);
+
+        // Энтропия набора кэшируется при первом обращении, поэтому замеряется свежее представление
+        // по явному списку строк: оно считает распределение классов заново. В замер входит
+        // и копирование списка строк
+        std::vector<uint32_t> allRows(dataset.RowCount());
+        std::iota(allRows.begin(), allRows.end(), 0u);
+        runner.Run("CalculateEntropy", dataset.RowCount(), [&]() {
+            DTDatasetView view(dataset, allRows);
+            sink = sink + view.CalculateEntropy();
+        });
+
+        runner.Run("GetClassDistributionForFeature", dataset.RowCount(), [&]() {
+            sink = sink + static_cast<double>(dataset.GetClassDistributionForFeature(0).size());
+        });
+
+        ID3::Options trainOptions;
+        trainOptions.traceLevel = TraceLevel::Off;
+        trainOptions.threads = options.threads;
+        runner.Run("ID3::Train", dataset.RowCount(), [&]() {
+            DecisionTree tree = ID3::Train(dataset, trainOptions);
+            sink = sink + static_cast<double>(tree.GetFlatTree().NodeCount());
+        });
+
+        // Профиль снимается с отдельного обучения вне замеров: учёт времени узлов их бы исказил
+        BuildProfile profile;
+        if (!options.profilePath.empty())
+            trainOptions.profile = &profile;
+        DecisionTree tree = ID3::Train(dataset, trainOptions);
+        if (!options.profilePath.empty()) {
+            profile.WriteChromeTrace(options.profilePath);
+            profile.PrintSummary(std::cerr);
+            std::cerr << "\n";
+        }
+        runner.AddParameter("treeNodes", static_cast<double>(tree.GetFlatTree().NodeCount()));
+
+        // Одиночные предсказания идут по строкам без целевого столбца, как их передаёт пользователь
+        std::vector<std::vector<std::string>> samples;
+        for (size_t row = 0; row < std::min(options.predictSamples, dataset.RowCount()); ++row) {
+            std::vector<std::string> sample = dataset.GetRow(row);
+            sample.erase(sample.begin() + dataset.GetTargetColumn());
+            samples.push_back(std::move(sample));
+        }
+        runner.Run("Predict", samples.size(), [&]() {
+            for (const auto& sample : samples) {
+                sink = sink + static_cast<double>(tree.PredictClass(sample));
+            }
+        });
+
+        DecisionTree::PredictOptions predictOptions;
+        predictOptions.threads = options.threads;
+        std::vector<uint32_t> classIds(dataset.RowCount());
+        runner.Run("PredictBatch", dataset.RowCount(), [&]() {
+            tree.PredictBatch(dataset, std::span<uint32_t>(classIds), predictOptions);
+            sink = sink + static_cast<double>(classIds[0]);
+        });
+
+        runner.PrintTable(std::cerr);
+        if (options.outputPath.empty()) {
+            runner.WriteJson(std::cout);
+        }
+        else {
+            std::ofstream out(options.outputPath);
+            if (!out.is_open())
+                throw std::runtime_error("Не удалось открыть файл для записи отчёта: " + options.outputPath);
+            runner.WriteJson(out);
+        }
+
+        if (!options.keepCsv)
+            std::filesystem::remove(options.csvPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <../include/Benchmarks/BenchmarkRunner.h>
+#include <../include/Utils/AllocationCounter.h>
+#include <../include/Utils/JsonWriter.h>
+#include <../include/Utils/ProcessMemory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+BenchmarkRunner::BenchmarkRunner(size_t iterations)
+    : _iterations(iterations) {
+    if (iterations == 0)
+        throw std::invalid_argument("Число повторов замера должно быть больше нуля");
+}
+
+void BenchmarkRunner::AddParameter(const std::string& name, const std::string& value) {
+    std::ostringstream ss;
+    JsonWriter::WriteString(ss, value);
+    _parameters.emplace_back(name, ss.str());
+}
+
+void BenchmarkRunner::AddParameter(const std::string& name, double value) {
+    std::ostringstream ss;
+    ss << std::setprecision(15) << value;
+    _parameters.emplace_back(name, ss.str());
+}
+
+const BenchmarkResult& BenchmarkRunner::Run(const std::string& name, size_t items, const std::function<void()>& body) {
+    using Clock = std::chrono::steady_clock;
+
+    // Каждый повтор замеряется отдельно; в отчёт идут минимум и медиана,
+    // а выделения памяти усредняются по повторам
+    std::vector<double> seconds;
+    AllocationCounter::Snapshot before = AllocationCounter::Current();
+    for (size_t i = 0; i < _iterations; ++i) {
+        auto start = Clock::now();
+        body();
+        seconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    AllocationCounter::Snapshot after = AllocationCounter::Current();
+
+    std::sort(seconds.begin(), seconds.end());
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = _iterations;
+    result.items = items;
+    result.minSeconds = seconds.front();
+    result.medianSeconds = seconds[seconds.size() / 2];
+    result.itemsPerSecond = result.medianSeconds > 0.0 ? items / result.medianSeconds : 0.0;
+    result.allocations = (after.count - before.count) / _iterations;
+    result.allocatedBytes = (after.bytes - before.bytes) / _iterations;
+    result.peakResidentBytes = ProcessMemory::PeakResidentBytes();
+
+    _results.push_back(std::move(result));
+    return _results.back();
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::GetResults() const {
+    return _results;
+}
+
+void BenchmarkRunner::PrintTable(std::ostream& out) const {
+    out << std::left << std::setw(34) << "Замер"
+        << std::right << std::setw(12) << "мин, мс"
+        << std::setw(12) << "медиана, мс"
+        << std::setw(16) << "элементов/с"
+        << std::setw(12) << "выделений"
+        << std::setw(14) << "байт"
+        << std::setw(12) << "пик RSS, МБ" << "\n";
+
+    for (const auto& result : _results) {
+        out << std::left << std::setw(34) << result.name
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << result.minSeconds * 1000.0
+            << std::setw(12) << result.medianSeconds * 1000.0
+            << std::setprecision(0)
+            << std::setw(16) << result.itemsPerSecond
+            << std::setw(12) << result.allocations
+            << std::setw(14) << result.allocatedBytes
+            << std::setprecision(1)
+            << std::setw(12) << result.peakResidentBytes / (1024.0 * 1024.0) << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+void BenchmarkRunner::WriteJson(std::ostream& out) const {
+    // Формат рассчитан на сравнение прогонов между версиями: ключи стабильны,
+    // время - в секундах, память - в байтах
+    out << "{\n  \"format\": 1,\n  \"allocationsCounted\": " << (AllocationCounter::IsInstalled() ? "true" : "false");
+    out << ",\n  \"parameters\": {";
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        out << (i == 0 ? "\n    " : ",\n    ");
+        JsonWriter::WriteString(out, _parameters[i].first);
+        out << ": " << _parameters[i].second;
+    }
+    out << (_parameters.empty() ? "}" : "\n  }");
+
+    out << ",\n  \"results\": [";
+    out << std::setprecision(9);
+    for (size_t i = 0; i < _results.size(); ++i) {
+        const BenchmarkResult& result = _results[i];
+        out << (i == 0 ? "\n    {" : ",\n    {");
+        out << "\"name\": ";
+        JsonWriter::WriteString(out, result.name);
+        out << ", \"iterations\": " << result.iterations
+            << ", \"items\": " << result.items
+            << ", \"minSeconds\": " << result.minSeconds
+            << ", \"medianSeconds\": " << result.medianSeconds
+            << ", \"itemsPerSecond\": " << result.itemsPerSecond
+            << ", \"allocations\": " << result.allocations
+            << ", \"allocatedBytes\": " << result.allocatedBytes
+            << ", \"peakResidentBytes\": " << result.peakResidentBytes << "}";
+    }
+    out << (_results.empty() ? "]" : "\n  ]");
+    out << ",\n  \"peakResidentBytes\": " << ProcessMemory::PeakResidentBytes() << "\n}\n";
+}
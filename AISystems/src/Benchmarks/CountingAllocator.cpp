@@ -0,0 +1,56 @@
+#include <../include/Utils/AllocationCounter.h>
+
+#include <cstdlib>
+#include <new>
+
+// Подмена глобальных operator new/delete для исполняемого файла замеров: каждое выделение
+// учитывается в AllocationCounter. Выровненные формы не подменяются - они парные
+// со своими стандартными delete и в счётчики не попадают
+
+void* operator new(size_t size) {
+    AllocationCounter::Record(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    AllocationCounter::Record(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    AllocationCounter::Record(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    AllocationCounter::Record(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,418 @@
+#include <../include/Benchmarks/RegressionCheck.h>
+#include <../include/DecisionTrees/BuildAlgorithms/ID3.h>
+#include <../include/DecisionTrees/BuildAlgorithms/IncrementalID3.h>
+#include <../include/DecisionTrees/BuildAlgorithms/StreamingID3.h>
+#include <../include/DecisionTrees/Evaluation/CrossValidation.h>
+#include <../include/DecisionTrees/Evaluation/GridSearch.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    // Заголовок файла модели, как его пишет FlatTree::Save
+    struct ModelHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t metadataOffset;
+        uint64_t metadataSize;
+        uint64_t nodesOffset;
+        uint64_t nodeCount;
+        uint64_t childrenOffset;
+        uint64_t childCount;
+    };
+
+    // Узел версий 2 и 3: порог хранился в самом узле, и узел занимал 20 байт
+    struct LegacyFlatNode {
+        uint32_t feature;
+        uint32_t firstCode;
+        uint32_t codeCount;
+        uint32_t offset;
+        float threshold;
+    };
+
+    constexpr uint64_t SectionAlignment = 16;
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+    }
+}
+
+std::string RegressionCheck::SaveBytes(const DecisionTree& tree) {
+    std::ostringstream out;
+    tree.GetFlatTree().Save(out, tree.GetHeaders(), tree.GetTargetColumn());
+    return out.str();
+}
+
+std::string RegressionCheck::ToLegacyFormat(const std::string& model, uint32_t version) {
+    if (version != 2 && version != 3)
+        throw std::invalid_argument("Старый формат модели - это версии 2 и 3");
+
+    ModelHeader header;
+    std::memcpy(&header, model.data(), sizeof(header));
+    std::vector<FlatTree::FlatNode> nodes(header.nodeCount);
+    std::memcpy(nodes.data(), model.data() + header.nodesOffset, nodes.size() * sizeof(FlatTree::FlatNode));
+    std::vector<uint32_t> childTable(header.childCount);
+    std::memcpy(childTable.data(), model.data() + header.childrenOffset, childTable.size() * sizeof(uint32_t));
+
+    // Порог переносится из таблицы потомков в узел. Ячейка порога в таблице старым
+    // версиям не мешает: узел читает только свои codeCount ячеек
+    std::vector<LegacyFlatNode> legacy;
+    legacy.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        const bool split = node.feature != FlatTree::LeafFeature;
+        if (split && node.firstCode == FlatTree::SubsetSplit && version == 2)
+            throw std::invalid_argument("В формате версии 2 нет узлов с подмножеством значений");
+        float threshold = split && node.firstCode == FlatTree::ThresholdSplit ? std::bit_cast<float>(childTable[node.offset + 2]) : 0.0f;
+        legacy.push_back({ node.feature, node.firstCode, node.codeCount, node.offset, threshold });
+    }
+
+    const size_t nodesSize = legacy.size() * sizeof(LegacyFlatNode);
+    ModelHeader result = header;
+    result.version = version;
+    result.childrenOffset = AlignUp(header.nodesOffset + nodesSize);
+
+    std::string out(result.childrenOffset + childTable.size() * sizeof(uint32_t), '\0');
+    std::memcpy(out.data(), &result, sizeof(result));
+    std::memcpy(out.data() + header.metadataOffset, model.data() + header.metadataOffset, header.metadataSize);
+    std::memcpy(out.data() + header.nodesOffset, legacy.data(), nodesSize);
+    std::memcpy(out.data() + result.childrenOffset, childTable.data(), childTable.size() * sizeof(uint32_t));
+    return out;
+}
+
+std::vector<uint32_t> RegressionCheck::PredictAll(const DecisionTree& tree, const DTDataset& dataset) {
+    std::vector<uint32_t> classIds(dataset.RowCount());
+    tree.PredictBatch(dataset, std::span<uint32_t>(classIds), DecisionTree::PredictOptions());
+    return classIds;
+}
+
+bool RegressionCheck::Report(std::ostream& out, bool passed, const std::string& name) {
+    out << (passed ? "  [OK]     " : "  [ОШИБКА] ") << name << "\n";
+    return passed;
+}
+
+size_t RegressionCheck::CountLeaves(const Node* node, size_t& maxBranches) {
+    if (node == nullptr)
+        return 0;
+
+    std::vector<const Node*> children;
+    if (const auto* split = dynamic_cast<const ThresholdNode*>(node))
+        children = { split->GetLessOrEqual(), split->GetGreater() };
+    else if (const auto* subset = dynamic_cast<const SubsetNode*>(node))
+        children = { subset->GetInSubset(), subset->GetOther() };
+    else if (const auto* decision = dynamic_cast<const DecisionNode*>(node)) {
+        for (const auto& child : decision->GetChildren()) {
+            children.push_back(child.second);
+        }
+    }
+    else
+        return 1;
+
+    maxBranches = std::max(maxBranches, children.size());
+    size_t leaves = 0;
+    for (const Node* child : children) {
+        leaves += CountLeaves(child, maxBranches);
+    }
+    return leaves;
+}
+
+void RegressionCheck::WriteLines(const std::string& filename, const std::vector<std::string>& lines) {
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    for (const auto& line : lines) {
+        file << line << "\n";
+    }
+    if (!file)
+        throw std::runtime_error("Ошибка записи в файл: " + filename);
+}
+
+bool RegressionCheck::Run(const DTDataset& dataset, size_t threads, const std::string& modelPath, std::ostream& out) {
+    // Эталон - последовательное точное построение без описания
+    ID3::Options reference;
+    reference.traceLevel = TraceLevel::Off;
+    reference.threads = 1;
+    reference.splitSearch = ID3::SplitSearch::Exact;
+    DecisionTree expected = ID3::Train(dataset, reference);
+    const std::vector<uint32_t> expectedClasses = PredictAll(expected, dataset);
+
+    bool passed = true;
+    const size_t parallel = threads > 1 ? threads : 4;
+    const std::pair<ID3::SplitSearch, const char*> searches[] = {
+        { ID3::SplitSearch::Exact, "точный поиск" },
+        { ID3::SplitSearch::Histogram, "гистограммы" }
+    };
+    const std::pair<TraceLevel, const char*> traces[] = {
+        { TraceLevel::Off, "без описания" },
+        { TraceLevel::Summary, "краткое описание" },
+        { TraceLevel::Full, "полное описание" }
+    };
+    for (const auto& [search, searchName] : searches) {
+        // Внутри режима поиска потоки и описание не должны менять модель ни на байт.
+        // Между режимами пороги числовых признаков могут отличаться (середина между значениями
+        // узла или между корзинами), поэтому режимы сравниваются по предсказаниям обучающих строк
+        ID3::Options options = reference;
+        options.splitSearch = search;
+        DecisionTree searchTree = ID3::Train(dataset, options);
+        const std::string searchBytes = SaveBytes(searchTree);
+        if (search != reference.splitSearch)
+            passed = Report(out, PredictAll(searchTree, dataset) == expectedClasses, std::string(searchName) + ": предсказания как у точного поиска") && passed;
+
+        for (size_t variantThreads : { size_t(1), parallel }) {
+            for (const auto& [trace, traceName] : traces) {
+                if (variantThreads == 1 && trace == TraceLevel::Off)
+                    continue;
+                options.threads = variantThreads;
+                options.traceLevel = trace;
+                DecisionTree tree = ID3::Train(dataset, options);
+
+                std::ostringstream name;
+                name << searchName << ", потоков " << variantThreads << ", " << traceName;
+                passed = Report(out, SaveBytes(tree) == searchBytes, name.str()) && passed;
+            }
+        }
+    }
+
+    // Модель записывается в каждой версии формата и читается обратно. Старые версии собираются
+    // из файла текущей; узлы с подмножеством значений появились только в версии 3. Файл
+    // отображается в память загруженной моделью, поэтому перезаписывается только после её разрушения
+    const std::string expectedBytes = SaveBytes(expected);
+    const auto& expectedNodes = expected.GetFlatTree().GetNodes();
+    const bool hasSubsets = std::any_of(expectedNodes.begin(), expectedNodes.end(), [](const FlatTree::FlatNode& node) {
+        return node.feature != FlatTree::LeafFeature && node.firstCode == FlatTree::SubsetSplit;
+    });
+    for (uint32_t version : { uint32_t(2), uint32_t(3), FlatTree::FormatVersion }) {
+        if (version == 2 && hasSubsets)
+            continue;
+        {
+            std::ofstream file(modelPath, std::ios::binary);
+            if (!file.is_open())
+                throw std::runtime_error("Не удалось открыть файл для записи: " + modelPath);
+            const std::string bytes = version == FlatTree::FormatVersion ? expectedBytes : ToLegacyFormat(expectedBytes, version);
+            file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!file)
+                throw std::runtime_error("Ошибка записи в файл: " + modelPath);
+        }
+
+        DecisionTree loaded = DecisionTree::Load(modelPath);
+        bool same = loaded.GetFlatTree().NodeCount() == expected.GetFlatTree().NodeCount()
+            && PredictAll(loaded, dataset) == expectedClasses;
+        passed = Report(out, same, "чтение модели версии " + std::to_string(version)) && passed;
+    }
+    std::filesystem::remove(modelPath);
+    return passed;
+}
+
+bool RegressionCheck::RunStreaming(const DTDataset& dataset, const std::string& csvPath, char delimiter, std::ostream& out) {
+    ID3::Options reference;
+    reference.traceLevel = TraceLevel::Off;
+    reference.threads = 1;
+    reference.splitSearch = ID3::SplitSearch::Exact;
+    const std::string expected = SaveBytes(ID3::Train(dataset, reference));
+
+    // Маленькие порции проверяют сборку счётчиков узла из нескольких порций строк
+    bool passed = true;
+    for (size_t chunkRows : { StreamingID3::Options().chunkRows, size_t(1000) }) {
+        StreamingID3::Options options;
+        options.chunkRows = chunkRows;
+        const std::string suffix = ", порции по " + std::to_string(chunkRows) + " строк";
+
+        DTCsvRowSource csv(csvPath, delimiter, true);
+        passed = Report(out, SaveBytes(StreamingID3::Train(csv, dataset.GetTargetColumn(), options)) == expected,
+            "потоковое построение из CSV" + suffix) && passed;
+
+        DTDatasetRowSource rows(dataset);
+        passed = Report(out, SaveBytes(StreamingID3::Train(rows, dataset.GetTargetColumn(), options)) == expected,
+            "потоковое построение по набору" + suffix) && passed;
+    }
+    return passed;
+}
+
+bool RegressionCheck::RunIncremental(const DTDataset& dataset, std::ostream& out) {
+    bool passed = true;
+
+    // Класс задаётся признаком A, признак B почти не связан с классом. При двух классах
+    // epsilon = sqrt(ln(1e7) / 2n): на 8 строках он больше 1 и разбиение невозможно,
+    // на 9 строках (0.946) отрыв A от B (0.984) его уже превышает
+    IncrementalID3::Options options;
+    options.gracePeriod = 1;
+    IncrementalID3 model({ "A", "B", "Class" }, 2, options);
+    const std::vector<std::vector<std::string>> rows = {
+        { "a", "x", "yes" }, { "b", "x", "no" }, { "a", "y", "yes" }, { "b", "y", "no" },
+        { "a", "x", "yes" }, { "b", "x", "no" }, { "a", "y", "yes" }, { "b", "y", "no" },
+        { "a", "x", "yes" }
+    };
+    for (size_t row = 0; row + 1 < rows.size(); ++row) {
+        model.Update(rows[row]);
+    }
+    passed = Report(out, model.NodeCount() == 1, "инкрементное дерево: 8 строк не дают разбиения") && passed;
+    model.Update(rows.back());
+    passed = Report(out, model.NodeCount() == 3 && model.Predict({ "a", "y" }) == "yes" && model.Predict({ "b", "x" }) == "no",
+        "инкрементное дерево: разбиение по A на 9-й строке") && passed;
+
+    // Порции набора проходят по дереву в том же порядке, что и строки по одной
+    IncrementalID3 byDataset(dataset.GetHeaders(), dataset.GetTargetColumn());
+    byDataset.Update(dataset);
+    IncrementalID3 byRows(dataset.GetHeaders(), dataset.GetTargetColumn());
+    for (size_t row = 0; row < dataset.RowCount(); ++row) {
+        byRows.Update(dataset.GetRow(row));
+    }
+    passed = Report(out, byDataset.NodeCount() > 1 && SaveBytes(byDataset.GetTree()) == SaveBytes(byRows.GetTree()),
+        "инкрементное дерево: обновление набором как по строкам") && passed;
+    return passed;
+}
+
+bool RegressionCheck::RunCrossValidation(const DTDataset& dataset, size_t threads, std::ostream& out) {
+    bool passed = true;
+    CrossValidation::Options options;
+    options.seed = 7;
+    options.treeOptions.traceLevel = TraceLevel::Off;
+
+    // Каждая строка попадает ровно в один блок; при стратификации число строк каждого
+    // класса в блоках, как и размеры блоков, отличается не больше чем на одну
+    const auto folds = CrossValidation::MakeFolds(dataset, options);
+    const DTColumn& target = dataset.GetColumn(dataset.GetTargetColumn());
+    std::vector<size_t> seen(dataset.RowCount(), 0);
+    std::vector<std::vector<size_t>> classCounts(target.Cardinality(), std::vector<size_t>(folds.size(), 0));
+    size_t minRows = dataset.RowCount();
+    size_t maxRows = 0;
+    for (size_t fold = 0; fold < folds.size(); ++fold) {
+        minRows = std::min(minRows, folds[fold].size());
+        maxRows = std::max(maxRows, folds[fold].size());
+        for (uint32_t row : folds[fold]) {
+            seen[row]++;
+            classCounts[target.GetCode(row)][fold]++;
+        }
+    }
+    const bool partition = std::all_of(seen.begin(), seen.end(), [](size_t count) { return count == 1; });
+    passed = Report(out, folds.size() == options.folds && partition && maxRows - minRows <= 1,
+        "перекрёстная проверка: блоки разбивают строки поровну") && passed;
+    const bool stratified = std::all_of(classCounts.begin(), classCounts.end(), [](const std::vector<size_t>& counts) {
+        auto [least, most] = std::minmax_element(counts.begin(), counts.end());
+        return *most - *least <= 1;
+    });
+    passed = Report(out, stratified, "перекрёстная проверка: доли классов в блоках совпадают") && passed;
+
+    const double testFraction = 0.2;
+    const double expectedTest = dataset.RowCount() * testFraction;
+    const size_t holdout = CrossValidation::MakeHoldout(dataset, testFraction, options).size();
+    passed = Report(out, holdout + 1 >= expectedTest && holdout <= expectedTest + 1,
+        "отложенная часть: " + std::to_string(holdout) + " строк из " + std::to_string(dataset.RowCount())) && passed;
+
+    // Блоки обучаются параллельно, но каждый на своих строках - итог тот же, что и последовательно
+    const CrossValidation::Result expected = CrossValidation::Evaluate(dataset, folds, options);
+    options.threads = threads > 1 ? threads : 4;
+    const CrossValidation::Result parallel = CrossValidation::Evaluate(dataset, folds, options);
+    bool same = parallel.correct == expected.correct && parallel.confusion == expected.confusion;
+    for (size_t fold = 0; same && fold < folds.size(); ++fold) {
+        same = parallel.folds[fold].correct == expected.folds[fold].correct
+            && parallel.folds[fold].nodes == expected.folds[fold].nodes;
+    }
+    passed = Report(out, same, "перекрёстная проверка: потоков " + std::to_string(options.threads) + " как 1") && passed;
+    return passed;
+}
+
+bool RegressionCheck::RunGridSearch(const DTDataset& dataset, size_t threads, std::ostream& out) {
+    bool passed = true;
+    GridSearch::Grid grid;
+    grid.maxDepth = { 1, 2, 0 };
+    grid.minGain = { 0.0, 0.01 };
+    GridSearch::Options options;
+    options.validation.seed = 7;
+    const GridSearch::Result expected = GridSearch::Search(dataset, grid, options);
+
+    // Неглубокие деревья отстают от полного и снимаются после minFolds блоков
+    const size_t folds = options.validation.folds;
+    size_t stopped = 0;
+    bool consistent = !expected.trials[expected.best].stopped
+        && expected.foldsRun + expected.foldsSkipped == expected.trials.size() * folds;
+    for (const auto& trial : expected.trials) {
+        stopped += trial.stopped ? 1 : 0;
+        consistent = consistent && (trial.stopped ? trial.folds.size() < folds : trial.folds.size() == folds);
+        if (!trial.stopped)
+            consistent = consistent && trial.meanAccuracy <= expected.trials[expected.best].meanAccuracy;
+    }
+    passed = Report(out, consistent && stopped != 0,
+        "перебор параметров: снято испытаний " + std::to_string(stopped) + " из " + std::to_string(expected.trials.size())) && passed;
+
+    // Испытания раунда считаются параллельно, а решения о снятии принимаются после раунда
+    options.validation.threads = threads > 1 ? threads : 4;
+    const GridSearch::Result parallel = GridSearch::Search(dataset, grid, options);
+    bool same = parallel.best == expected.best && parallel.foldsRun == expected.foldsRun
+        && parallel.foldsSkipped == expected.foldsSkipped && parallel.trials.size() == expected.trials.size();
+    for (size_t t = 0; same && t < expected.trials.size(); ++t) {
+        const auto& a = expected.trials[t];
+        const auto& b = parallel.trials[t];
+        same = a.stopped == b.stopped && a.folds.size() == b.folds.size();
+        for (size_t fold = 0; same && fold < a.folds.size(); ++fold) {
+            same = a.folds[fold].correct == b.folds[fold].correct && a.folds[fold].nodes == b.folds[fold].nodes;
+        }
+    }
+    passed = Report(out, same, "перебор параметров: потоков " + std::to_string(options.validation.threads) + " как 1") && passed;
+    return passed;
+}
+
+bool RegressionCheck::RunPruning(const DTDataset& training, const std::string& validationPath, const DTDataset::LoadOptions& loadOptions, std::ostream& out) {
+    bool passed = true;
+    ID3::Options options;
+    options.traceLevel = TraceLevel::Off;
+
+    // Пороги числовых признаков применяются к текстовым значениям так же, как при предсказании
+    DTDataset::LoadOptions textOptions = loadOptions;
+    textOptions.detectNumeric = false;
+    DTDataset validation;
+    validation.LoadFromFile(validationPath, loadOptions);
+    DTDataset textValidation;
+    textValidation.LoadFromFile(validationPath, textOptions);
+
+    options.validation = &validation;
+    const std::string expected = SaveBytes(ID3::Train(training, options));
+    options.validation = &textValidation;
+    passed = Report(out, SaveBytes(ID3::Train(training, options)) == expected, "обрезка по проверочному набору без распознавания чисел") && passed;
+
+    // Без перебора свернуть можно узел, все ветви которого - листья, поэтому число листьев
+    // не опускается ниже maxLeaves больше чем на ветвления узла без одной
+    options.validation = nullptr;
+    DecisionTree full = ID3::Train(training, options);
+    size_t maxBranches = 0;
+    const size_t fullLeaves = CountLeaves(full.GetRoot(), maxBranches);
+    for (size_t maxLeaves : { fullLeaves - 1, fullLeaves / 2, size_t(2) }) {
+        if (maxLeaves < 2 || maxLeaves >= fullLeaves)
+            continue;
+        options.maxLeaves = maxLeaves;
+        size_t branches = 0;
+        size_t leaves = CountLeaves(ID3::Train(training, options).GetRoot(), branches);
+        passed = Report(out, leaves <= maxLeaves && leaves + maxBranches - 1 > maxLeaves,
+            "ограничение " + std::to_string(maxLeaves) + " листьев: получено " + std::to_string(leaves)) && passed;
+    }
+    options.maxLeaves = 0;
+
+    // До ветви r не доходит ни одна проверочная строка: оценить её нечем, и она остаётся
+    // поддеревом из двух листьев, а ветвь s проверочные строки сохраняют
+    DTDataset::LoadOptions smallOptions;
+    smallOptions.delimiter = ',';
+    std::vector<std::string> lines{ "A,B,Class" };
+    const std::pair<const char*, size_t> rows[] = {
+        { "s,w,yes", 4 }, { "s,x,no", 4 }, { "r,w,no", 3 }, { "r,x,yes", 3 }, { "o,w,yes", 4 }
+    };
+    for (const auto& [row, count] : rows) {
+        lines.insert(lines.end(), count, row);
+    }
+    WriteLines(validationPath, lines);
+    DTDataset small;
+    small.LoadFromFile(validationPath, smallOptions);
+    WriteLines(validationPath, { "A,B,Class", "s,w,yes", "s,x,no" });
+    DTDataset smallValidation;
+    smallValidation.LoadFromFile(validationPath, smallOptions);
+
+    options.validation = &smallValidation;
+    size_t branches = 0;
+    size_t leaves = CountLeaves(ID3::Train(small, options).GetRoot(), branches);
+    passed = Report(out, leaves == 5, "поддерево без проверочных строк не сворачивается") && passed;
+    return passed;
+}
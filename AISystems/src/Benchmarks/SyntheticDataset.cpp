@@ -0,0 +1,92 @@
+#include <../include/Benchmarks/SyntheticDataset.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+std::vector<double> SyntheticDataset::ClassDistribution(const Options& options) {
+    // Частоты классов убывают геометрически: первый класс встречается
+    // в imbalance раз чаще последнего. Возвращается накопленное распределение
+    std::vector<double> cumulative(options.classes);
+    double total = 0.0;
+    for (size_t c = 0; c < options.classes; ++c) {
+        double position = options.classes > 1 ? static_cast<double>(c) / (options.classes - 1) : 0.0;
+        total += std::pow(options.imbalance, -position);
+        cumulative[c] = total;
+    }
+    for (double& value : cumulative) {
+        value /= total;
+    }
+    return cumulative;
+}
+
+void SyntheticDataset::Validate(const Options& options) {
+    if (options.rows == 0)
+        throw std::invalid_argument("Число строк должно быть больше нуля");
+    if (options.features == 0)
+        throw std::invalid_argument("Число признаков должно быть больше нуля");
+    if (options.cardinality == 0 || options.classes == 0)
+        throw std::invalid_argument("Число значений признака и число классов должны быть больше нуля");
+    if (!(options.imbalance >= 1.0))
+        throw std::invalid_argument("Дисбаланс классов должен быть не меньше 1");
+    if (!(options.noise >= 0.0 && options.noise <= 1.0))
+        throw std::invalid_argument("Доля шума должна быть от 0 до 1");
+}
+
+size_t SyntheticDataset::WriteCsv(const std::string& filename, const Options& options) {
+    Validate(options);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+
+    // Значения признаков равномерны; класс определяется первыми informativeFeatures
+    // признаками (через хэш их значений), а доля noise строк получает случайный класс.
+    // Так у дерева есть что выучить, а распределение классов задаётся дисбалансом
+    const std::vector<double> cumulative = ClassDistribution(options);
+    const size_t informative = std::min(options.informativeFeatures, options.features);
+    std::mt19937_64 random(options.seed);
+    std::uniform_int_distribution<size_t> pickValue(0, options.cardinality - 1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    std::string line;
+    for (size_t f = 0; f < options.features; ++f) {
+        line += "F" + std::to_string(f) + options.delimiter;
+    }
+    line += "Class\n";
+    file << line;
+
+    std::vector<size_t> values(options.features);
+    for (size_t row = 0; row < options.rows; ++row) {
+        uint64_t hash = options.seed * 0x9E3779B97F4A7C15ull;
+        line.clear();
+        for (size_t f = 0; f < options.features; ++f) {
+            values[f] = pickValue(random);
+            if (f < informative) {
+                hash = (hash ^ (values[f] + 1)) * 0xBF58476D1CE4E5B9ull;
+                hash ^= hash >> 31;
+            }
+            // Числовые значения распознаются при загрузке как числа, и дерево делит их порогами
+            if (!options.numeric)
+                line += 'v';
+            line += std::to_string(values[f]);
+            line += options.delimiter;
+        }
+
+        double u = uniform(random) < options.noise ?
+            uniform(random) :
+            static_cast<double>(hash >> 11) / static_cast<double>(uint64_t(1) << 53);
+        size_t label = std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        line += "c" + std::to_string(std::min(label, options.classes - 1));
+        line += '\n';
+        file << line;
+    }
+
+    if (!file) {
+        throw std::runtime_error("Ошибка записи в файл: " + filename);
+    }
+    return static_cast<size_t>(file.tellp());
+}
@@ -0,0 +1,264 @@
+#include <../include/DecisionTrees/BuildAlgorithms/BuildProfile.h>
+#include <../include/DecisionTrees/DTDataset.h>
+#include <../include/Utils/AllocationCounter.h>
+#include <../include/Utils/JsonWriter.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+void BuildProfile::Start(const DTDataset& dataset) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stages.clear();
+    _nodes.clear();
+    _threads.clear();
+    _totalSeconds = 0.0;
+
+    // Поток, запустивший обучение, всегда первый: на нём идут подготовительные этапы
+    _threads.push_back(std::this_thread::get_id());
+
+    _features.assign(dataset.ColumnCount(), FeatureStats());
+    for (size_t col = 0; col < dataset.ColumnCount(); ++col) {
+        _features[col].name = dataset.GetColumnHeader(col);
+        _features[col].cardinality = dataset.GetColumn(col).Cardinality();
+    }
+
+    _allocationsCounted = AllocationCounter::IsInstalled();
+    AllocationCounter::Snapshot allocations = AllocationCounter::Current();
+    _startAllocations = allocations.count;
+    _startAllocatedBytes = allocations.bytes;
+    _allocations = 0;
+    _allocatedBytes = 0;
+    _start = Clock::now();
+}
+
+void BuildProfile::Finish() {
+    double total = Now();
+    AllocationCounter::Snapshot allocations = AllocationCounter::Current();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _totalSeconds = total;
+    _allocations = allocations.count - _startAllocations;
+    _allocatedBytes = allocations.bytes - _startAllocatedBytes;
+}
+
+double BuildProfile::Now() const {
+    return std::chrono::duration<double>(Clock::now() - _start).count();
+}
+
+void BuildProfile::AddStage(const std::string& name, const Phase& phase) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stages.emplace_back(name, phase);
+}
+
+void BuildProfile::AddNode(NodeStats node, const std::vector<std::pair<size_t, double>>& gainSeconds) {
+    std::thread::id id = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = std::find(_threads.begin(), _threads.end(), id);
+    node.thread = found - _threads.begin();
+    if (found == _threads.end())
+        _threads.push_back(id);
+
+    // Время приростов копится по признакам: так видно, какой столбец
+    // (например, с огромным числом значений) съедает обучение
+    for (const auto& [feature, seconds] : gainSeconds) {
+        if (feature >= _features.size())
+            continue;
+        FeatureStats& stats = _features[feature];
+        stats.evaluations++;
+        stats.rows += node.rows;
+        stats.gainSeconds += seconds;
+    }
+    _nodes.push_back(std::move(node));
+}
+
+double BuildProfile::TotalSeconds() const {
+    return _totalSeconds;
+}
+
+bool BuildProfile::AllocationsCounted() const {
+    return _allocationsCounted;
+}
+
+uint64_t BuildProfile::Allocations() const {
+    return _allocations;
+}
+
+uint64_t BuildProfile::AllocatedBytes() const {
+    return _allocatedBytes;
+}
+
+const std::vector<std::pair<std::string, BuildProfile::Phase>>& BuildProfile::GetStages() const {
+    return _stages;
+}
+
+const std::vector<BuildProfile::NodeStats>& BuildProfile::GetNodes() const {
+    return _nodes;
+}
+
+const std::vector<BuildProfile::FeatureStats>& BuildProfile::GetFeatures() const {
+    return _features;
+}
+
+std::vector<BuildProfile::DepthStats> BuildProfile::GetDepthStats() const {
+    std::vector<DepthStats> depths;
+    for (const NodeStats& node : _nodes) {
+        if (node.depth >= depths.size()) {
+            size_t from = depths.size();
+            depths.resize(node.depth + 1);
+            for (size_t depth = from; depth < depths.size(); ++depth) {
+                depths[depth].depth = depth;
+            }
+        }
+
+        DepthStats& stats = depths[node.depth];
+        stats.nodes++;
+        if (node.children == 0)
+            stats.leaves++;
+        stats.rows += node.rows;
+        stats.countedRows += node.countedRows;
+        stats.countingSeconds += node.counting.seconds;
+        stats.gainSeconds += node.gain.seconds;
+        stats.partitionSeconds += node.partition.seconds;
+        stats.allocations += node.allocations;
+        stats.allocatedBytes += node.allocatedBytes;
+    }
+    return depths;
+}
+
+void BuildProfile::PrintSummary(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << "Обучение: " << _totalSeconds * 1000.0 << " мс, узлов: " << _nodes.size();
+    if (_allocationsCounted)
+        out << ", выделений: " << _allocations << " (" << _allocatedBytes << " байт)";
+    out << "\n";
+    for (const auto& [name, phase] : _stages) {
+        out << "  " << name << ": " << phase.seconds * 1000.0 << " мс\n";
+    }
+
+    out << "\n" << std::left << std::setw(8) << "Глубина"
+        << std::right << std::setw(10) << "узлов"
+        << std::setw(10) << "листьев"
+        << std::setw(12) << "строк"
+        << std::setw(12) << "подсчёт, мс"
+        << std::setw(12) << "прирост, мс"
+        << std::setw(12) << "разбиение, мс"
+        << std::setw(12) << "выделений" << "\n";
+    for (const DepthStats& depth : GetDepthStats()) {
+        out << std::left << std::setw(8) << depth.depth
+            << std::right << std::setw(10) << depth.nodes
+            << std::setw(10) << depth.leaves
+            << std::setw(12) << depth.rows
+            << std::setw(12) << depth.countingSeconds * 1000.0
+            << std::setw(12) << depth.gainSeconds * 1000.0
+            << std::setw(12) << depth.partitionSeconds * 1000.0
+            << std::setw(12) << depth.allocations << "\n";
+    }
+
+    // Признаки - по убыванию суммарного времени расчёта прироста
+    std::vector<const FeatureStats*> features;
+    for (const FeatureStats& feature : _features) {
+        if (feature.evaluations != 0)
+            features.push_back(&feature);
+    }
+    std::stable_sort(features.begin(), features.end(), [](const FeatureStats* a, const FeatureStats* b) {
+        return a->gainSeconds > b->gainSeconds;
+    });
+
+    out << "\n" << std::left << std::setw(24) << "Признак"
+        << std::right << std::setw(10) << "значений"
+        << std::setw(10) << "оценок"
+        << std::setw(14) << "строк"
+        << std::setw(12) << "прирост, мс" << "\n";
+    for (const FeatureStats* feature : features) {
+        out << std::left << std::setw(24) << feature->name
+            << std::right << std::setw(10) << feature->cardinality
+            << std::setw(10) << feature->evaluations
+            << std::setw(14) << feature->rows
+            << std::setw(12) << feature->gainSeconds * 1000.0 << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void BuildProfile::WriteEvent
+(
+    std::ostream& out,
+    const std::string& name,
+    const char* category,
+    const Phase& phase,
+    size_t thread,
+    bool& first
+) {
+    out << (first ? "\n    {" : ",\n    {");
+    first = false;
+    out << "\"name\": ";
+    JsonWriter::WriteString(out, name);
+    out << ", \"cat\": \"" << category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread
+        << ", \"ts\": " << phase.start * 1e6 << ", \"dur\": " << phase.seconds * 1e6;
+}
+
+void BuildProfile::WriteChromeTrace(std::ostream& out) const {
+    // Формат Trace Event (chrome://tracing, Perfetto): события "X" с началом и длительностью
+    // в микросекундах. Узел охватывает своё поддерево, этапы узла вложены в него
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+    for (size_t thread = 0; thread < _threads.size(); ++thread) {
+        out << (first ? "\n    {" : ",\n    {");
+        first = false;
+        out << "\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread
+            << ", \"args\": {\"name\": \"" << (thread == 0 ? "train" : "worker " + std::to_string(thread)) << "\"}}";
+    }
+
+    for (const auto& [name, phase] : _stages) {
+        WriteEvent(out, name, "stage", phase, 0, first);
+        out << "}";
+    }
+
+    for (const NodeStats& node : _nodes) {
+        WriteEvent(out, "node " + node.path, "node", node.total, node.thread, first);
+        out << ", \"args\": {\"depth\": " << node.depth
+            << ", \"rows\": " << node.rows
+            << ", \"countedRows\": " << node.countedRows
+            << ", \"feature\": ";
+        JsonWriter::WriteString(out, node.feature);
+        out << ", \"children\": " << node.children
+            << ", \"allocations\": " << node.allocations
+            << ", \"allocatedBytes\": " << node.allocatedBytes << "}}";
+
+        const std::pair<const char*, const Phase*> phases[] = {
+            { "counting", &node.counting },
+            { "gain", &node.gain },
+            { "partition", &node.partition }
+        };
+        for (const auto& [name, phase] : phases) {
+            if (phase->seconds > 0.0) {
+                WriteEvent(out, name, "phase", *phase, node.thread, first);
+                out << "}";
+            }
+        }
+    }
+    out << (first ? "]\n}\n" : "\n  ]\n}\n");
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void BuildProfile::WriteChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для профиля обучения: " + filename);
+    }
+    WriteChromeTrace(file);
+}
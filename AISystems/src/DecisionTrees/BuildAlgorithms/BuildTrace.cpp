@@ -0,0 +1,18 @@
+#include <../include/DecisionTrees/BuildAlgorithms/BuildTrace.h>
+
+#include <stdexcept>
+
+std::ostream& OStreamTraceSink::GetStream() {
+    return _stream;
+}
+
+FileTraceSink::FileTraceSink(const std::string& filename)
+    : _file(filename) {
+    if (!_file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для описания построения: " + filename);
+    }
+}
+
+std::ostream& FileTraceSink::GetStream() {
+    return _file;
+}
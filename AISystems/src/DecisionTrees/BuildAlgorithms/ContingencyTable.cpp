@@ -0,0 +1,278 @@
+#include <../include/DecisionTrees/BuildAlgorithms/ContingencyTable.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    template <typename Code>
+    void GatherCodes(const Code* codes, const uint32_t* rows, bool contiguous, size_t count, uint32_t* out) {
+        if (contiguous) {
+            const Code* block = codes + rows[0];
+            for (size_t i = 0; i < count; ++i) out[i] = block[i];
+        }
+        else {
+            for (size_t i = 0; i < count; ++i) out[i] = codes[rows[i]];
+        }
+    }
+
+    template <typename Code>
+    void ComputeCells
+    (
+        const Code* codes,
+        const uint32_t* rows,
+        bool contiguous,
+        const uint32_t* classes,
+        size_t count,
+        uint32_t numClasses,
+        uint32_t* cells
+    ) {
+        // Отдельный проход без зависимостей по памяти - компилятор векторизует его
+        if (contiguous) {
+            const Code* block = codes + rows[0];
+            for (size_t i = 0; i < count; ++i) cells[i] = static_cast<uint32_t>(block[i]) * numClasses + classes[i];
+        }
+        else {
+            for (size_t i = 0; i < count; ++i) cells[i] = static_cast<uint32_t>(codes[rows[i]]) * numClasses + classes[i];
+        }
+    }
+
+    template <typename Code>
+    void ComputeCompactCells
+    (
+        const Code* codes,
+        const uint32_t* rows,
+        const uint32_t* classes,
+        size_t count,
+        uint32_t numClasses,
+        const uint32_t* firstCode,
+        const uint32_t* lastCode,
+        uint32_t* cells
+    ) {
+        // Строка матрицы - позиция кода среди встретившихся в узле значений
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t value = static_cast<uint32_t>(std::lower_bound(firstCode, lastCode, static_cast<uint32_t>(codes[rows[i]])) - firstCode);
+            cells[i] = value * numClasses + classes[i];
+        }
+    }
+
+    void Accumulate(const uint32_t* cells, size_t count, uint32_t* histogram) {
+        for (size_t i = 0; i < count; ++i) histogram[cells[i]]++;
+    }
+
+    void AccumulateLanes(const uint32_t* cells, size_t count, uint32_t* lanes, size_t laneStride) {
+        // Четыре копии гистограммы: соседние инкременты одной ячейки не ждут друг друга
+        uint32_t* l0 = lanes;
+        uint32_t* l1 = lanes + laneStride;
+        uint32_t* l2 = lanes + 2 * laneStride;
+        uint32_t* l3 = lanes + 3 * laneStride;
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            l0[cells[i]]++;
+            l1[cells[i + 1]]++;
+            l2[cells[i + 2]]++;
+            l3[cells[i + 3]]++;
+        }
+        for (; i < count; ++i) l0[cells[i]]++;
+    }
+
+    bool IsContiguous(std::span<const uint32_t> rows) {
+        if (rows.empty() || rows.back() < rows.front() || rows.back() - rows.front() + 1 != rows.size())
+            return false;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (rows[i] != rows[0] + i)
+                return false;
+        }
+        return true;
+    }
+}
+
+ContingencyTable ContingencyTable::Build(const DTDatasetView& dataset, WorkStealingPool* pool, const std::vector<bool>& selected) {
+    ContingencyTable table;
+    const DTDataset& source = dataset.GetDataset();
+    const DTColumn& target = source.GetColumn(dataset.GetTargetColumn());
+    table._numClasses = target.Cardinality();
+    table._totalRows = dataset.RowCount();
+
+    // Раскладка матриц всех активных категориальных признаков в одном массиве;
+    // числовые признаки разбиваются по порогу и в таблицу не входят. Если задан
+    // отбор признаков (случайное подмножество узла), считаются только отобранные
+    size_t totalCells = 0;
+    size_t laneCells = 0;
+    for (size_t i = 0; i < source.ColumnCount(); ++i) {
+        if (!dataset.IsFeatureActive(i) || dataset.IsFeatureNumeric(i) || (!selected.empty() && !selected[i]))
+            continue;
+
+        // В мелком узле строк намного меньше, чем значений признака: матрица заводится только
+        // по встретившимся в узле значениям (по возрастанию кода), а не по всему словарю
+        const DTColumn& column = source.GetColumn(i);
+        size_t values = column.Cardinality();
+        size_t codeOffset = AllCodes;
+        if (table._totalRows * CompactRatio < values) {
+            codeOffset = table._codes.size();
+            column.VisitCodes([&](const auto* codes) {
+                for (uint32_t row : dataset.GetRows()) {
+                    table._codes.push_back(codes[row]);
+                }
+            });
+            auto first = table._codes.begin() + codeOffset;
+            std::sort(first, table._codes.end());
+            table._codes.erase(std::unique(first, table._codes.end()), table._codes.end());
+            values = table._codes.size() - codeOffset;
+        }
+
+        size_t cells = values * table._numClasses;
+        if (cells > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Слишком большая таблица сопряжённости для признака \"" + source.GetColumnHeader(i) + "\"");
+        }
+
+        table._features.push_back(i);
+        table._valueCounts.push_back(values);
+        table._codeOffsets.push_back(codeOffset);
+        table._offsets.push_back(totalCells);
+        totalCells += cells;
+
+        // Копии гистограммы заводятся только для небольших таблиц, которые целиком помещаются в кэш
+        if (cells <= MaxLaneCells) {
+            table._laneOffsets.push_back(laneCells);
+            laneCells += cells * HistogramLanes;
+        }
+        else {
+            table._laneOffsets.push_back(NoLanes);
+        }
+    }
+
+    table._counts.assign(totalCells, 0);
+    table._classCounts.assign(table._numClasses, 0);
+    table._lanes.assign(laneCells, 0);
+
+    const size_t numSlots = table._features.size();
+    if (pool == nullptr || pool->ThreadCount() < 2 || numSlots < 2) {
+        table.AccumulateSlots(dataset, 0, numSlots, true);
+        for (size_t slot = 0; slot < numSlots; ++slot) {
+            table.MergeLanes(slot);
+        }
+    }
+    else {
+        // Признаки делятся на группы: каждая задача делает свой проход по строкам и пишет
+        // в непересекающиеся участки матриц, поэтому результат не зависит от числа потоков
+        const size_t numTasks = std::min(numSlots, pool->ThreadCount() * 2);
+        pool->ParallelFor(numTasks, [&](size_t task) {
+            size_t first = numSlots * task / numTasks;
+            size_t last = numSlots * (task + 1) / numTasks;
+            table.AccumulateSlots(dataset, first, last, task == 0);
+            for (size_t slot = first; slot < last; ++slot) {
+                table.MergeLanes(slot);
+            }
+        });
+    }
+
+    table._lanes.clear();
+    table._lanes.shrink_to_fit();
+    return table;
+}
+
+void ContingencyTable::AccumulateSlots(const DTDatasetView& dataset, size_t firstSlot, size_t lastSlot, bool countClasses) {
+    const DTDataset& source = dataset.GetDataset();
+    const DTColumn& target = source.GetColumn(dataset.GetTargetColumn());
+
+    auto rows = dataset.GetRows();
+    const bool contiguous = IsContiguous(rows);
+    const uint32_t numClasses = static_cast<uint32_t>(_numClasses);
+    std::vector<uint32_t> classes(BlockSize);
+    std::vector<uint32_t> cells(BlockSize);
+
+    // Один проход по строкам узла: блок строк загружается один раз и обрабатывается всеми признаками
+    for (size_t begin = 0; begin < rows.size(); begin += BlockSize) {
+        const size_t count = std::min(BlockSize, rows.size() - begin);
+        const uint32_t* blockRows = rows.data() + begin;
+
+        target.VisitCodes([&](const auto* codes) {
+            GatherCodes(codes, blockRows, contiguous, count, classes.data());
+        });
+        if (countClasses)
+            Accumulate(classes.data(), count, _classCounts.data());
+
+        for (size_t slot = firstSlot; slot < lastSlot; ++slot) {
+            const DTColumn& feature = source.GetColumn(_features[slot]);
+            if (_codeOffsets[slot] == AllCodes) {
+                feature.VisitCodes([&](const auto* codes) {
+                    ComputeCells(codes, blockRows, contiguous, classes.data(), count, numClasses, cells.data());
+                });
+            }
+            else {
+                const uint32_t* firstCode = _codes.data() + _codeOffsets[slot];
+                feature.VisitCodes([&](const auto* codes) {
+                    ComputeCompactCells(codes, blockRows, classes.data(), count, numClasses, firstCode, firstCode + _valueCounts[slot], cells.data());
+                });
+            }
+
+            if (_laneOffsets[slot] != NoLanes) {
+                size_t stride = _valueCounts[slot] * _numClasses;
+                AccumulateLanes(cells.data(), count, _lanes.data() + _laneOffsets[slot], stride);
+            }
+            else {
+                Accumulate(cells.data(), count, _counts.data() + _offsets[slot]);
+            }
+        }
+    }
+}
+
+void ContingencyTable::MergeLanes(size_t slot) {
+    // Сведение копий гистограммы признака
+    if (_laneOffsets[slot] == NoLanes)
+        return;
+
+    size_t stride = _valueCounts[slot] * _numClasses;
+    uint32_t* out = _counts.data() + _offsets[slot];
+    const uint32_t* in = _lanes.data() + _laneOffsets[slot];
+    for (size_t lane = 0; lane < HistogramLanes; ++lane) {
+        for (size_t c = 0; c < stride; ++c) {
+            out[c] += in[lane * stride + c];
+        }
+    }
+}
+
+
+
+size_t ContingencyTable::FeatureCount() const {
+    return _features.size();
+}
+
+size_t ContingencyTable::NumClasses() const {
+    return _numClasses;
+}
+
+size_t ContingencyTable::TotalRows() const {
+    return _totalRows;
+}
+
+size_t ContingencyTable::GetFeatureIndex(size_t slot) const {
+    return _features[slot];
+}
+
+size_t ContingencyTable::GetValueCount(size_t slot) const {
+    return _valueCounts[slot];
+}
+
+const uint32_t* ContingencyTable::GetValueCodes(size_t slot) const {
+    // nullptr - строки матрицы идут по всем кодам словаря
+    return _codeOffsets[slot] == AllCodes ? nullptr : _codes.data() + _codeOffsets[slot];
+}
+
+size_t ContingencyTable::FindValue(size_t slot, uint32_t code) const {
+    if (_codeOffsets[slot] == AllCodes)
+        return code;
+    const uint32_t* first = _codes.data() + _codeOffsets[slot];
+    const uint32_t* last = first + _valueCounts[slot];
+    const uint32_t* found = std::lower_bound(first, last, code);
+    return found != last && *found == code ? static_cast<size_t>(found - first) : NoValue;
+}
+
+const uint32_t* ContingencyTable::GetFeatureCounts(size_t slot) const {
+    return _counts.data() + _offsets[slot];
+}
+
+const std::vector<uint32_t>& ContingencyTable::GetClassCounts() const {
+    return _classCounts;
+}
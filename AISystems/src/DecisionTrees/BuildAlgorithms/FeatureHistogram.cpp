@@ -0,0 +1,120 @@
+#include <../include/DecisionTrees/BuildAlgorithms/FeatureHistogram.h>
+
+#include <algorithm>
+
+FeatureHistogram FeatureHistogram::Build(const DTDatasetView& dataset, const DTFeatureBins& bins, WorkStealingPool* pool) {
+    FeatureHistogram histogram;
+    const DTDataset& source = dataset.GetDataset();
+    const size_t targetColumn = dataset.GetTargetColumn();
+    histogram._numClasses = source.GetColumn(targetColumn).Cardinality();
+    histogram._totalRows = dataset.RowCount();
+
+    // Матрицы [корзина][класс] размечаются для всех нецелевых столбцов, чтобы раскладка
+    // у родителя и потомков совпадала; заполняются только активные признаки узла
+    std::vector<size_t> columns;
+    size_t totalCells = 0;
+    histogram._binCounts.assign(source.ColumnCount(), 0);
+    histogram._offsets.assign(source.ColumnCount(), 0);
+    for (size_t col = 0; col < source.ColumnCount(); ++col) {
+        histogram._offsets[col] = totalCells;
+        if (col == targetColumn)
+            continue;
+
+        histogram._binCounts[col] = bins.GetColumn(col).BinCount();
+        totalCells += histogram._binCounts[col] * histogram._numClasses;
+        if (dataset.IsFeatureActive(col))
+            columns.push_back(col);
+    }
+
+    histogram._counts.assign(totalCells, 0);
+    histogram._classCounts.assign(histogram._numClasses, 0);
+
+    const size_t numColumns = columns.size();
+    if (pool == nullptr || pool->ThreadCount() < 2 || numColumns < 2) {
+        histogram.AccumulateColumns(dataset, bins, columns, 0, numColumns, true);
+    }
+    else {
+        // Как и в ContingencyTable, каждая задача проходит по строкам со своей группой
+        // признаков и пишет в непересекающиеся участки матриц
+        const size_t numTasks = std::min(numColumns, pool->ThreadCount() * 2);
+        pool->ParallelFor(numTasks, [&](size_t task) {
+            size_t first = numColumns * task / numTasks;
+            size_t last = numColumns * (task + 1) / numTasks;
+            histogram.AccumulateColumns(dataset, bins, columns, first, last, task == 0);
+        });
+    }
+    return histogram;
+}
+
+void FeatureHistogram::AccumulateColumns
+(
+    const DTDatasetView& dataset,
+    const DTFeatureBins& bins,
+    const std::vector<size_t>& columns,
+    size_t first,
+    size_t last,
+    bool countClasses
+) {
+    const DTColumn& target = dataset.GetDataset().GetColumn(dataset.GetTargetColumn());
+    auto rows = dataset.GetRows();
+    const uint32_t numClasses = static_cast<uint32_t>(_numClasses);
+    std::vector<uint32_t> classes(BlockSize);
+    std::vector<uint32_t> cells(BlockSize);
+
+    // Блок строк: классы читаются один раз, затем для каждого признака считаются
+    // номера ячеек (этот проход векторизуется) и наращиваются счётчики
+    for (size_t begin = 0; begin < rows.size(); begin += BlockSize) {
+        const size_t count = std::min(BlockSize, rows.size() - begin);
+        const uint32_t* blockRows = rows.data() + begin;
+
+        target.VisitCodes([&](const auto* codes) {
+            for (size_t i = 0; i < count; ++i) classes[i] = codes[blockRows[i]];
+        });
+        if (countClasses) {
+            for (size_t i = 0; i < count; ++i) _classCounts[classes[i]]++;
+        }
+
+        for (size_t k = first; k < last; ++k) {
+            const uint8_t* binRows = bins.GetColumn(columns[k]).rows.data();
+            uint32_t* out = _counts.data() + _offsets[columns[k]];
+            for (size_t i = 0; i < count; ++i) cells[i] = static_cast<uint32_t>(binRows[blockRows[i]]) * numClasses + classes[i];
+            for (size_t i = 0; i < count; ++i) out[cells[i]]++;
+        }
+    }
+}
+
+void FeatureHistogram::Subtract(const FeatureHistogram& other) {
+    // Гистограмма родителя без строк одного из потомков - это гистограмма остальных потомков;
+    // разность верна для признаков, активных в обоих узлах
+    for (size_t i = 0; i < _counts.size(); ++i) {
+        _counts[i] -= other._counts[i];
+    }
+    for (size_t c = 0; c < _numClasses; ++c) {
+        _classCounts[c] -= other._classCounts[c];
+    }
+    _totalRows -= other._totalRows;
+}
+
+bool FeatureHistogram::Empty() const {
+    return _offsets.empty();
+}
+
+size_t FeatureHistogram::NumClasses() const {
+    return _numClasses;
+}
+
+size_t FeatureHistogram::TotalRows() const {
+    return _totalRows;
+}
+
+size_t FeatureHistogram::GetBinCount(size_t columnIndex) const {
+    return _binCounts[columnIndex];
+}
+
+const uint32_t* FeatureHistogram::GetFeatureCounts(size_t columnIndex) const {
+    return _counts.data() + _offsets[columnIndex];
+}
+
+const std::vector<uint32_t>& FeatureHistogram::GetClassCounts() const {
+    return _classCounts;
+}
@@ -1,172 +1,1065 @@
 #include <../include/DecisionTrees/BuildAlgorithms/ID3.h>
+#include <../include/Utils/AllocationCounter.h>
 
-bool ID3::AllSameTargetValue(const DTDataset& dataset) {
-    auto unique = dataset.GetUniqueValues(dataset.GetTargetColumn());
-    return unique.size() == 1;
+#include <limits>
+#include <random>
+
+bool ID3::AllSameTargetValue(const DTDatasetView& dataset) {
+    return dataset.AllSameTargetValue();
+}
+
+uint64_t ID3::ChildSeed(uint64_t seed, size_t child) {
+    // Зерно ветви зависит только от зерна узла и номера ветви (перемешивание SplitMix64),
+    // поэтому случайные подмножества признаков не зависят от порядка выполнения задач
+    uint64_t z = seed + (child + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::vector<bool> ID3::SampleFeatures(const DTDatasetView& dataset, size_t count, uint64_t seed) {
+    const DTDataset& source = dataset.GetDataset();
+    std::vector<size_t> features;
+    for (size_t col = 0; col < source.ColumnCount(); ++col) {
+        if (col != dataset.GetTargetColumn() && dataset.IsFeatureActive(col))
+            features.push_back(col);
+    }
+
+    // Пустой вектор означает "все признаки"
+    std::vector<bool> selected;
+    if (count >= features.size())
+        return selected;
+
+    // Частичное перемешивание Фишера-Йетса: первые count элементов - случайная выборка без повторов
+    std::mt19937_64 random(seed);
+    selected.assign(source.ColumnCount(), false);
+    for (size_t i = 0; i < count; ++i) {
+        std::uniform_int_distribution<size_t> pick(i, features.size() - 1);
+        std::swap(features[i], features[pick(random)]);
+        selected[features[i]] = true;
+    }
+    return selected;
+}
+
+double ID3::CalculateEntropy(const uint32_t* counts, size_t numClasses, size_t total) {
+    return InformationGainCriterion::Impurity(counts, numClasses, total);
 }
 
-double ID3::CalculateInformationGain
+template <typename Criterion, typename Trace>
+double ID3::CalculateFeatureScore
 (
-    const DTDataset& dataset,
+    const DTDatasetView& dataset,
     size_t featureIndex,
-    const double& totalEntropy,
-    std::ostringstream& oss,
+    const uint32_t* classDist,
+    const uint32_t* totalCounts,
+    size_t numValues,
+    size_t numClasses,
+    const uint32_t* valueCodes,
+    const double& nodeImpurity,
+    Trace& trace,
     const std::string& indent
 ) {
-    oss << "\n" << indent << "\t\t\t2." << featureIndex + 1 << ")  G   \""
-        << dataset.GetColumnHeader(featureIndex) << "\": ";
+    const DTDataset& source = dataset.GetDataset();
+    if constexpr (Trace::Full) {
+        trace.Out() << "\n" << indent << "\t\t\t2." << dataset.GetActiveFeatureRank(featureIndex) + 1 << ") Расчёт G для признака \""
+            << source.GetColumnHeader(featureIndex) << "\": ";
+    }
 
     size_t totalRows = dataset.RowCount();
 
-    //       
-    auto classDist = dataset.GetClassDistributionForFeature(featureIndex);
+    // Распределение классов для каждого значения признака уже посчитано: матрица [значение][класс].
+    // В режиме гистограмм строки матрицы - корзины; редкие значения могут делить одну корзину.
+    // Коды строк матрицы - valueCodes (nullptr - строка совпадает с кодом значения)
 
-    //  
-    double featureEntropy = 0.0;
+    // Оценка разбиения накапливается политикой критерия по ветвям-значениям
+    typename Criterion::Split split;
 
-    //      
-    for (const auto& [featureValue, targetCounts] : classDist) {
+    // Для каждого значения текущего нецелевого признака
+    for (size_t v = 0; v < numValues; ++v) {
+        const uint32_t* targetCounts = classDist + v * numClasses;
         size_t totalVCount = 0;
 
-        oss << "\n" << indent << "\t\t\t\t *  \"" << featureValue << "\": ";
+        // Вероятность встретить значение целевого признака при значении featureValue текущего признака (который по featureIndex)
+        for (size_t c = 0; c < numClasses; ++c) {
+            totalVCount += targetCounts[c];
+        }
 
-        //        featureValue   (  featureIndex)
-        for (const auto& [_, count] : targetCounts) {
-            totalVCount += count;
+        if (totalVCount == 0)
+            continue;
+
+        if constexpr (Trace::Full) {
+            uint32_t code = valueCodes != nullptr ? valueCodes[v] : static_cast<uint32_t>(v);
+            if (code == DTFeatureBins::GroupedValues) {
+                trace.Out() << "\n" << indent << "\t\t\t\t * прочие значения: ";
+            }
+            else {
+                trace.Out() << "\n" << indent << "\t\t\t\t * значение \""
+                    << source.GetColumn(featureIndex).GetDictionary().GetValue(code) << "\": ";
+            }
         }
 
-        //    
-        double featureValueEntropy = 0.0;
-        for (const auto& [targetValue, count] : targetCounts) {
-            double p = static_cast<double>(count) / totalVCount;
+        Criterion::AddBranch(split, targetCounts, totalCounts, numClasses, totalVCount);
 
-            oss << "\n" << indent << "\t\t\t\t\t <>    \""
-                << dataset.GetTargetColumnHeader() << "\" == \"" << targetValue
-                << "\": pm = " << p;
+        if constexpr (Trace::Full) {
+            for (size_t c = 0; c < numClasses; ++c) {
+                size_t count = targetCounts[c];
+                if (count == 0)
+                    continue;
 
-            double addition = 0.0;
+                double p = static_cast<double>(count) / totalVCount;
+                trace.Out() << "\n" << indent << "\t\t\t\t\t <> вероятность получить исход \""
+                    << source.GetTargetColumnHeader() << "\" == \""
+                    << source.GetColumn(dataset.GetTargetColumn()).GetDictionary().GetValue(static_cast<uint32_t>(c))
+                    << "\": pm = " << p;
+                if constexpr (Criterion::Entropy) {
+                    trace.Out() << "\n" << indent << "\t\t\t\t\t\t <> вклад в энтропию значения признака этого исхода: add = -p * log2(p) = " << -p * log2(p);
+                }
+            }
 
-            if (p > 0) {
-                addition = -p * log2(p);
-                featureValueEntropy += addition;
+            double prob = static_cast<double>(totalVCount) / totalRows;
+            trace.Out() << "\n" << indent << "\t\t\t\t\t <> вероятность получить это значение: p = " << prob;
+            if constexpr (Criterion::BranchTitle != nullptr) {
+                trace.Out() << "\n" << indent << "\t\t\t\t\t <> " << Criterion::BranchTitle << " этого значения признака: e = "
+                    << Criterion::Impurity(targetCounts, numClasses, totalVCount);
             }
+        }
+    }
 
-            oss << "\n" << indent << "\t\t\t\t\t\t <>       : add = -p * log2(p) = " << addition;
+    double score = Criterion::Score(split, nodeImpurity, totalRows);
+
+    if constexpr (Trace::Full) {
+        trace.Out() << "\n";
+        if constexpr (Criterion::ImpurityTitle != nullptr) {
+            trace.Out() << "\n" << indent << "\t\t\t   ---> " << Criterion::ImpurityTitle << " признака \""
+                << source.GetColumnHeader(featureIndex) << "\": E = " << Criterion::WeightedImpurity(split, totalRows);
         }
 
-        double prob = static_cast<double>(totalVCount) / totalRows;
-        featureEntropy += prob * featureValueEntropy;
-        oss << "\n" << indent << "\t\t\t\t\t <>    : p = " << prob;
-        oss << "\n" << indent << "\t\t\t\t\t <>    : e = " << featureValueEntropy;
+        trace.Out() << "\n" << indent << "\t\t\t   ---> " << Criterion::ScoreTitle << " признака \""
+            << source.GetColumnHeader(featureIndex) << "\": G = " << score;
+    }
+
+    return score;
+}
+
+
+template <typename Criterion>
+double ID3::CalculateSplitScore
+(
+    const uint32_t* leftCounts,
+    const uint32_t* totalCounts,
+    size_t numClasses,
+    size_t leftRows,
+    size_t totalRows,
+    const double& nodeImpurity,
+    std::vector<uint32_t>& rightCounts
+) {
+    for (size_t c = 0; c < numClasses; ++c) {
+        rightCounts[c] = totalCounts[c] - leftCounts[c];
     }
 
-    double gain = totalEntropy - featureEntropy;
+    typename Criterion::Split split;
+    Criterion::AddBranch(split, leftCounts, totalCounts, numClasses, leftRows);
+    Criterion::AddBranch(split, rightCounts.data(), totalCounts, numClasses, totalRows - leftRows);
+    return Criterion::Score(split, nodeImpurity, totalRows);
+}
+
+template <typename Criterion, typename Trace>
+double ID3::CalculateThresholdScore
+(
+    const DTDatasetView& dataset,
+    size_t featureIndex,
+    const uint32_t* totalCounts,
+    size_t numClasses,
+    const uint32_t* histogram,
+    const DTFeatureBins::ColumnBins* bins,
+    const double& nodeImpurity,
+    float& threshold,
+    Trace& trace,
+    const std::string& indent
+) {
+    const DTDataset& source = dataset.GetDataset();
+    const DTColumn& column = source.GetColumn(featureIndex);
+    const DTColumn& target = source.GetColumn(dataset.GetTargetColumn());
+    const size_t totalRows = dataset.RowCount();
+
+    std::vector<uint32_t> left(numClasses, 0);
+    std::vector<uint32_t> right(numClasses);
+    double bestGain = -std::numeric_limits<double>::infinity();
 
-    oss << "\n\n" << indent << "\t\t\t   --->   \""
-        << dataset.GetColumnHeader(featureIndex) << "\": E = " << featureEntropy;
+    if (histogram == nullptr) {
+        // Точный поиск: строки узла уже упорядочены по значению, распределение левой части
+        // наращивается по одной строке, а прирост считается на каждой границе между значениями
+        const auto& numbers = column.GetNumbers();
+        auto sorted = dataset.GetSortedRows(featureIndex);
+        column.VisitCodes([&](const auto* codes) {
+            target.VisitCodes([&](const auto* classes) {
+                for (size_t i = 0; i + 1 < sorted.size(); ++i) {
+                    left[classes[sorted[i]]]++;
+                    float value = numbers[codes[sorted[i]]];
+                    float next = numbers[codes[sorted[i + 1]]];
+                    if (!(value < next))
+                        continue;
 
-    oss << "\n" << indent << "\t\t\t   --->    \""
-        << dataset.GetColumnHeader(featureIndex) << "\": G = " << gain;
+                    double gain = CalculateSplitScore<Criterion>(left.data(), totalCounts, numClasses, i + 1, totalRows, nodeImpurity, right);
+                    if (gain > bestGain) {
+                        bestGain = gain;
+                        threshold = DTSplitThreshold(value, next);
+                    }
+                }
+            });
+        });
+    }
+    else {
+        // Приближённый поиск по гистограмме [интервал][класс] узла:
+        // кандидатами служат только границы интервалов
+        const size_t numBins = bins->BinCount();
+        size_t leftRows = 0;
+        for (size_t bin = 0; bin + 1 < numBins; ++bin) {
+            for (size_t c = 0; c < numClasses; ++c) {
+                left[c] += histogram[bin * numClasses + c];
+                leftRows += histogram[bin * numClasses + c];
+            }
+            if (leftRows == 0 || leftRows == totalRows)
+                continue;
 
-    return gain;
+            double gain = CalculateSplitScore<Criterion>(left.data(), totalCounts, numClasses, leftRows, totalRows, nodeImpurity, right);
+            if (gain > bestGain) {
+                bestGain = gain;
+                threshold = bins->thresholds[bin];
+            }
+        }
+    }
+
+    if constexpr (Trace::Full) {
+        trace.Out() << "\n" << indent << "\t\t\t2." << dataset.GetActiveFeatureRank(featureIndex) + 1 << ") Расчёт G для числового признака \""
+            << source.GetColumnHeader(featureIndex) << "\": ";
+        if (bestGain == -std::numeric_limits<double>::infinity()) {
+            trace.Out() << "\n" << indent << "\t\t\t   ---> все значения признака совпадают, разбиение по порогу невозможно";
+        }
+        else {
+            trace.Out() << "\n" << indent << "\t\t\t   ---> Лучший порог признака \""
+                << source.GetColumnHeader(featureIndex) << "\": " << DTFormatNumber(threshold);
+            trace.Out() << "\n" << indent << "\t\t\t   ---> " << Criterion::ScoreTitle << " признака \""
+                << source.GetColumnHeader(featureIndex) << "\": G = " << bestGain;
+        }
+    }
+
+    return bestGain;
 }
 
+template <typename Criterion, typename Trace>
+double ID3::CalculateSubsetScore
+(
+    const DTDatasetView& dataset,
+    size_t featureIndex,
+    const uint32_t* classDist,
+    const uint32_t* totalCounts,
+    size_t numValues,
+    size_t numClasses,
+    const DTFeatureBins::ColumnBins* bins,
+    const uint32_t* valueCodes,
+    const double& nodeImpurity,
+    std::vector<bool>& subset,
+    Trace& trace,
+    const std::string& indent
+) {
+    const DTDataset& source = dataset.GetDataset();
+    const DTColumn& column = source.GetColumn(featureIndex);
+    const size_t totalRows = dataset.RowCount();
 
-size_t ID3::FindBestFeature(const DTDataset& dataset, const double& totalEntropy, std::ostringstream& oss, const std::string& indent) {
-    size_t bestFeature = 0;
-    double maxGain = -1.0;
-    size_t targetCol = dataset.GetTargetColumn();
+    // Значения (в режиме гистограмм - корзины) упорядочиваются по доле класса, и лучшее двоичное
+    // разбиение ищется среди префиксов этого порядка: O(k log k) вместо 2^k подмножеств.
+    // Для двух классов один такой порядок даёт оптимальное разбиение (Брейман); при большем
+    // числе классов перебираются порядки по доле каждого класса узла
+    struct Item {
+        uint32_t value;
+        size_t rows;
+        double share;
+    };
+    std::vector<Item> items;
+    for (size_t v = 0; v < numValues; ++v) {
+        const uint32_t* counts = classDist + v * numClasses;
+        size_t rows = 0;
+        for (size_t c = 0; c < numClasses; ++c) {
+            rows += counts[c];
+        }
+        if (rows != 0)
+            items.push_back({ static_cast<uint32_t>(v), rows, 0.0 });
+    }
 
-    for (size_t i = 0; i < dataset.ColumnCount(); ++i) {
-        if (i == targetCol)
+    std::vector<uint32_t> left(numClasses);
+    std::vector<uint32_t> right(numClasses);
+    std::vector<uint32_t> bestOrder;
+    double bestGain = -std::numeric_limits<double>::infinity();
+    size_t bestPrefix = 0;
+    size_t presentClasses = 0;
+    for (size_t reference = 0; reference < numClasses && items.size() > 1; ++reference) {
+        if (totalCounts[reference] == 0)
             continue;
+        if (++presentClasses == 2 && numClasses == 2)
+            break;
+
+        for (auto& item : items) {
+            item.share = static_cast<double>(classDist[item.value * numClasses + reference]) / item.rows;
+        }
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+            return a.share != b.share ? a.share < b.share : a.value < b.value;
+        });
+
+        std::fill(left.begin(), left.end(), 0);
+        size_t leftRows = 0;
+        size_t prefix = 0;
+        for (size_t i = 0; i + 1 < items.size(); ++i) {
+            const uint32_t* counts = classDist + items[i].value * numClasses;
+            for (size_t c = 0; c < numClasses; ++c) {
+                left[c] += counts[c];
+            }
+            leftRows += items[i].rows;
+
+            double gain = CalculateSplitScore<Criterion>(left.data(), totalCounts, numClasses, leftRows, totalRows, nodeImpurity, right);
+            if (gain > bestGain) {
+                bestGain = gain;
+                prefix = i + 1;
+            }
+        }
+        if (prefix != 0) {
+            bestPrefix = prefix;
+            bestOrder.clear();
+            for (size_t i = 0; i < prefix; ++i) {
+                bestOrder.push_back(items[i].value);
+            }
+        }
+    }
+
+    // Подмножество задаётся по кодам значений столбца; корзина переносит в него все свои значения
+    subset.clear();
+    if (bestPrefix != 0) {
+        subset.assign(column.Cardinality(), false);
+        if (bins != nullptr) {
+            std::vector<bool> chosen(numValues, false);
+            for (uint32_t value : bestOrder) {
+                chosen[value] = true;
+            }
+            for (uint32_t code = 0; code < subset.size(); ++code) {
+                subset[code] = chosen[bins->binOfCode[code]];
+            }
+        }
+        else {
+            for (uint32_t value : bestOrder) {
+                subset[valueCodes != nullptr ? valueCodes[value] : value] = true;
+            }
+        }
+    }
+
+    if constexpr (Trace::Full) {
+        trace.Out() << "\n" << indent << "\t\t\t2." << dataset.GetActiveFeatureRank(featureIndex) + 1 << ") Расчёт G для признака \""
+            << source.GetColumnHeader(featureIndex) << "\" (двоичное разбиение): ";
+        if (bestPrefix == 0) {
+            trace.Out() << "\n" << indent << "\t\t\t   ---> все строки имеют одно значение признака, разбиение невозможно";
+        }
+        else {
+            std::vector<std::string_view> values;
+            for (uint32_t code = 0; code < subset.size(); ++code) {
+                if (subset[code])
+                    values.push_back(column.GetDictionary().GetValue(code));
+            }
+            trace.Out() << "\n" << indent << "\t\t\t   ---> Лучшее подмножество значений признака \""
+                << source.GetColumnHeader(featureIndex) << "\": " << SubsetNode::DescribeValues(values);
+            trace.Out() << "\n" << indent << "\t\t\t   ---> " << Criterion::ScoreTitle << " признака \""
+                << source.GetColumnHeader(featureIndex) << "\": G = " << bestGain;
+        }
+    }
+
+    return bestGain;
+}
+
+template <typename Criterion, typename Trace>
+ID3::SplitChoice ID3::FindBestFeature
+(
+    const DTDatasetView& dataset,
+    const ContingencyTable* table,
+    const FeatureHistogram* histogram,
+    const std::vector<bool>& selected,
+    const double& nodeImpurity,
+    Trace& trace,
+    const std::string& indent,
+    const BuildContext& context,
+    std::vector<std::pair<size_t, double>>& gainSeconds
+) {
+    // Кандидаты идут в порядке столбцов: категориальные признаки считаются по готовой
+    // матрице (слота таблицы или корзин гистограммы), числовые - поиском порога
+    const DTDataset& source = dataset.GetDataset();
+    struct Candidate {
+        size_t feature;
+        size_t slot;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t col = 0, slot = 0; col < source.ColumnCount(); ++col) {
+        if (!selected.empty() && !selected[col])
+            continue;
+        if (dataset.IsFeatureNumeric(col))
+            candidates.push_back({ col, NoFeature });
+        else if (histogram != nullptr && col != dataset.GetTargetColumn() && dataset.IsFeatureActive(col))
+            candidates.push_back({ col, col });
+        else if (table != nullptr && slot < table->FeatureCount() && table->GetFeatureIndex(slot) == col)
+            candidates.push_back({ col, slot++ });
+    }
+
+    const uint32_t* classCounts = histogram != nullptr ? histogram->GetClassCounts().data() : table->GetClassCounts().data();
+    const size_t numClasses = histogram != nullptr ? histogram->NumClasses() : table->NumClasses();
+
+    const size_t numCandidates = candidates.size();
+    std::vector<double> gains(numCandidates);
+    std::vector<float> thresholds(numCandidates, 0.0f);
+    std::vector<std::vector<bool>> subsets(numCandidates);
+    const bool binary = context.options.categoricalSplit == CategoricalSplit::Binary;
+    std::vector<double> seconds(context.options.profile != nullptr ? numCandidates : 0);
+    auto evaluate = [&](size_t i, Trace& out) {
+        const size_t feature = candidates[i].feature;
+        BuildProfile::Clock::time_point start;
+        if (!seconds.empty())
+            start = BuildProfile::Clock::now();
+        const DTFeatureBins::ColumnBins* bins = histogram != nullptr ? &context.bins->GetColumn(feature) : nullptr;
+        if (candidates[i].slot == NoFeature) {
+            gains[i] = CalculateThresholdScore<Criterion>(dataset, feature, classCounts, numClasses,
+                histogram != nullptr ? histogram->GetFeatureCounts(feature) : nullptr, bins, nodeImpurity, thresholds[i], out, indent);
+        }
+        else if (binary) {
+            if (histogram != nullptr) {
+                gains[i] = CalculateSubsetScore<Criterion>(dataset, feature, histogram->GetFeatureCounts(feature), classCounts,
+                    histogram->GetBinCount(feature), numClasses, bins, nullptr, nodeImpurity, subsets[i], out, indent);
+            }
+            else {
+                gains[i] = CalculateSubsetScore<Criterion>(dataset, feature, table->GetFeatureCounts(candidates[i].slot), classCounts,
+                    table->GetValueCount(candidates[i].slot), numClasses, nullptr, table->GetValueCodes(candidates[i].slot), nodeImpurity, subsets[i], out, indent);
+            }
+        }
+        else if (histogram != nullptr) {
+            gains[i] = CalculateFeatureScore<Criterion>(dataset, feature, histogram->GetFeatureCounts(feature), classCounts,
+                histogram->GetBinCount(feature), numClasses, bins->codeOfBin.data(), nodeImpurity, out, indent);
+        }
+        else {
+            gains[i] = CalculateFeatureScore<Criterion>(dataset, feature, table->GetFeatureCounts(candidates[i].slot), classCounts,
+                table->GetValueCount(candidates[i].slot), numClasses, table->GetValueCodes(candidates[i].slot), nodeImpurity, out, indent);
+        }
+        if (!seconds.empty())
+            seconds[i] = std::chrono::duration<double>(BuildProfile::Clock::now() - start).count();
+    };
+
+    // Для крупных узлов приросты признаков считаются параллельно, каждый в свой буфер описания;
+    // буферы склеиваются по порядку признаков, поэтому текст и выбор не зависят от числа потоков
+    if (context.pool != nullptr && numCandidates > 1 && dataset.RowCount() >= context.options.parallelCountingRows) {
+        std::vector<std::ostringstream> streams(Trace::Full ? numCandidates : 0);
+        context.pool->ParallelFor(numCandidates, [&](size_t i) {
+            if constexpr (Trace::Full) {
+                Trace candidateTrace(streams[i]);
+                evaluate(i, candidateTrace);
+            }
+            else {
+                evaluate(i, trace);
+            }
+        });
+        if constexpr (Trace::Full) {
+            for (auto& stream : streams) {
+                trace.Out() << stream.str();
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < numCandidates; ++i) {
+            // Расчёт Gain очередного признака
+            evaluate(i, trace);
+        }
+    }
+
+    for (size_t i = 0; i < seconds.size(); ++i) {
+        gainSeconds.emplace_back(candidates[i].feature, seconds[i]);
+    }
+
+    // Поиск максимального
+    SplitChoice best{ NoFeature, false, 0.0f, 0.0, {} };
+    double maxGain = -1.0;
+    for (size_t i = 0; i < numCandidates; ++i) {
+        if (gains[i] > maxGain) {
+            maxGain = gains[i];
+            best = { candidates[i].feature, candidates[i].slot == NoFeature, thresholds[i], gains[i], std::move(subsets[i]) };
+        }
+    }
+
+    if constexpr (Trace::Summary) {
+        if (best.feature == NoFeature) {
+            trace.Out() << "\n" << indent << "\t\t   ---> ни один признак не разделяет строки узла\n";
+        }
+        else {
+            trace.Out() << "\n" << indent << "\t\t   ---> итак, лучший " << Criterion::BestTitle << " признак: #"
+                << dataset.GetActiveFeatureRank(best.feature) << " - \"" << source.GetColumnHeader(best.feature) << "\"";
+            if (best.numeric)
+                trace.Out() << " с порогом " << DTFormatNumber(best.threshold);
+            if (!best.subset.empty()) {
+                std::vector<std::string_view> values;
+                const DTDictionary& dictionary = source.GetColumn(best.feature).GetDictionary();
+                for (uint32_t code = 0; code < best.subset.size(); ++code) {
+                    if (best.subset[code])
+                        values.push_back(dictionary.GetValue(code));
+                }
+                trace.Out() << " с подмножеством значений " << SubsetNode::DescribeValues(values);
+            }
+            trace.Out() << "\n";
+        }
+    }
 
-        //  Gain i- 
-        double gain = CalculateInformationGain(dataset, i, totalEntropy, oss, indent);
+    return best;
+}
 
-        //  
-        if (gain > maxGain) {
-            maxGain = gain;
-            bestFeature = i;
+void ID3::PassClassCounts
+(
+    std::vector<std::pair<uint32_t, DTDatasetView>>& children,
+    const SplitChoice& best,
+    const ContingencyTable* table,
+    const FeatureHistogram* histogram,
+    const BuildContext& context
+) {
+    // Распределения классов ветвей берутся из таблицы, по которой выбиралось разбиение,
+    // и потомкам не приходится считать их по своим строкам. Где таблица их не содержит
+    // (точный порог, сгруппированные значения), потомок посчитает их сам при обращении
+    if (table != nullptr) {
+        if (best.numeric)
+            return;
+        const size_t numClasses = table->NumClasses();
+        for (size_t slot = 0; slot < table->FeatureCount(); ++slot) {
+            if (table->GetFeatureIndex(slot) != best.feature)
+                continue;
+            const uint32_t* counts = table->GetFeatureCounts(slot);
+            if (!best.subset.empty()) {
+                // Первая ветвь - сумма строк значений подмножества, вторая - остаток узла
+                const uint32_t* codes = table->GetValueCodes(slot);
+                std::vector<bool> inSubset(table->GetValueCount(slot));
+                for (size_t value = 0; value < inSubset.size(); ++value) {
+                    inSubset[value] = best.subset[codes != nullptr ? codes[value] : value];
+                }
+                PassSubsetCounts(children, inSubset, counts, table->GetClassCounts());
+                return;
+            }
+            for (auto& [code, child] : children) {
+                size_t value = table->FindValue(slot, code);
+                if (value == ContingencyTable::NoValue)
+                    continue;
+                const uint32_t* row = counts + value * numClasses;
+                child.SetClassCounts(std::vector<size_t>(row, row + numClasses));
+            }
         }
+        return;
     }
 
-    oss << "\n" << indent << "\t\t   ---> ,     : #"
-        << bestFeature << " - \"" << dataset.GetColumnHeader(bestFeature) << "\"\n";
+    const DTFeatureBins::ColumnBins& bins = context.bins->GetColumn(best.feature);
+    const uint32_t* counts = histogram->GetFeatureCounts(best.feature);
+    const size_t numClasses = histogram->NumClasses();
+    if (!best.subset.empty()) {
+        // Корзина целиком входит в подмножество или целиком остаётся вне его
+        std::vector<bool> inSubset(histogram->GetBinCount(best.feature), false);
+        for (uint32_t code = 0; code < best.subset.size(); ++code) {
+            if (best.subset[code])
+                inSubset[bins.binOfCode[code]] = true;
+        }
+        PassSubsetCounts(children, inSubset, counts, histogram->GetClassCounts());
+        return;
+    }
+    if (best.numeric) {
+        // Левая ветвь - интервалы до выбранного порога включительно, правая - остаток узла
+        std::vector<size_t> left(numClasses, 0);
+        for (size_t bin = 0; bin + 1 < bins.BinCount() && bins.thresholds[bin] <= best.threshold; ++bin) {
+            for (size_t c = 0; c < numClasses; ++c) {
+                left[c] += counts[bin * numClasses + c];
+            }
+        }
+        const auto& total = histogram->GetClassCounts();
+        std::vector<size_t> right(numClasses);
+        for (size_t c = 0; c < numClasses; ++c) {
+            right[c] = total[c] - left[c];
+        }
+        children[0].second.SetClassCounts(std::move(left));
+        children[1].second.SetClassCounts(std::move(right));
+        return;
+    }
 
-    return bestFeature;
+    for (auto& [code, child] : children) {
+        size_t bin = bins.binOfCode[code];
+        if (bins.codeOfBin[bin] != code)
+            continue;
+        const uint32_t* row = counts + bin * numClasses;
+        child.SetClassCounts(std::vector<size_t>(row, row + numClasses));
+    }
 }
 
-std::unique_ptr<Node> ID3::BuildTree(const DTDataset& dataset, std::ostringstream& oss) {
-    oss << "\n---------------------------------------------------        ---------------------------------------------------";
-    size_t iter = 0;
-    return BuildTreeInternal(dataset, oss, iter, "");
+void ID3::PassSubsetCounts
+(
+    std::vector<std::pair<uint32_t, DTDatasetView>>& children,
+    const std::vector<bool>& inSubset,
+    const uint32_t* counts,
+    const std::vector<uint32_t>& total
+) {
+    const size_t numClasses = total.size();
+    std::vector<size_t> members(numClasses, 0);
+    for (size_t value = 0; value < inSubset.size(); ++value) {
+        if (!inSubset[value])
+            continue;
+        for (size_t c = 0; c < numClasses; ++c) {
+            members[c] += counts[value * numClasses + c];
+        }
+    }
+    std::vector<size_t> others(numClasses);
+    for (size_t c = 0; c < numClasses; ++c) {
+        others[c] = total[c] - members[c];
+    }
+    children[0].second.SetClassCounts(std::move(members));
+    children[1].second.SetClassCounts(std::move(others));
 }
 
-std::unique_ptr<Node> ID3::BuildTreeInternal(const DTDataset& dataset, std::ostringstream& oss, size_t& iteration, const std::string& indent) {
-    iteration += 1;
+template <typename Criterion, typename Trace>
+const Node* ID3::BuildTree(DTDatasetView& view, std::ostream& out, const BuildContext& context) {
+    Trace trace(out);
+    if constexpr (Trace::Summary) {
+        trace.Out() << "\n--------------------------------------------------- Построение дерева решения по переданному набору данных ---------------------------------------------------";
+    }
+
+    // Дерево строится на представлениях: подмножества - это отрезки общего массива индексов строк
+    BuildProfile* profile = context.options.profile;
+    BuildProfile::Phase stage;
+    if (profile != nullptr)
+        stage.start = profile->Now();
+    FeatureHistogram histogram;
+    // Представление может прийти уже упорядоченным (перебор параметров сортирует строки блока один раз)
+    if (context.bins != nullptr)
+        histogram = FeatureHistogram::Build(view, *context.bins, context.pool);
+    else if (!view.IsPresorted())
+        view.PresortNumericFeatures();
+    if (profile != nullptr) {
+        stage.seconds = profile->Now() - stage.start;
+        profile->AddStage(context.bins != nullptr ? "root histogram" : "presort", stage);
+    }
+    return BuildTreeInternal<Criterion>(view, std::move(histogram), context.options.seed, 0, trace, "", context, "1");
+}
+
+template <typename Criterion, typename Trace>
+const Node* ID3::BuildTreeInternal
+(
+    DTDatasetView& dataset,
+    FeatureHistogram histogram,
+    uint64_t seed,
+    size_t depth,
+    Trace& trace,
+    const std::string& indent,
+    const BuildContext& context,
+    const std::string& path
+) {
+    const DTDataset& source = dataset.GetDataset();
+    const DTColumn& targetColumn = source.GetColumn(dataset.GetTargetColumn());
+    const bool parallel = context.pool != nullptr;
+
+    // Профиль узла: время этапов, строки и выделения памяти на потоке узла без учёта поддеревьев
+    BuildProfile* profile = context.options.profile;
+    BuildProfile::NodeStats stats;
+    std::vector<std::pair<size_t, double>> gainSeconds;
+    AllocationCounter::Snapshot allocations;
+    if (profile != nullptr) {
+        stats.path = path;
+        stats.depth = std::count(path.begin(), path.end(), '.');
+        stats.rows = dataset.RowCount();
+        stats.total.start = profile->Now();
+        allocations = AllocationCounter::CurrentThread();
+    }
+    auto takeAllocations = [&]() {
+        AllocationCounter::Snapshot current = AllocationCounter::CurrentThread();
+        stats.allocations = current.count - allocations.count;
+        stats.allocatedBytes = current.bytes - allocations.bytes;
+    };
+    auto record = [&]() {
+        stats.total.seconds = profile->Now() - stats.total.start;
+        profile->AddNode(std::move(stats), gainSeconds);
+    };
+    auto makeLeaf = [&](const std::string& label) -> const Node* {
+        if (profile != nullptr) {
+            takeAllocations();
+            record();
+        }
+        return context.arena->Create<LeafNode>(label);
+    };
 
-    oss << "\n" << indent << "\t #" << iteration << ": ";
+    // Узел обозначается путём от корня: он не зависит от порядка выполнения задач,
+    // поэтому описание одинаково при любом числе потоков
+    if constexpr (Trace::Summary) {
+        trace.Out() << "\n" << indent << "\tИтерация #" << path << ": ";
+    }
 
-    //  
-    //  1:       
+    // Условия выхода
+    // Условие 1: Все примеры принадлежат одному значению целевого признака
+    // (распределение классов узла передаётся родителем при разбиении, проход по строкам не нужен)
     if (AllSameTargetValue(dataset)) {
-        oss << "\n" << indent << "\t\t3)  \" \"    ,         \n\n\n";
-        return std::make_unique<LeafNode>(dataset.GetClassDistribution().begin()->first);
+        if constexpr (Trace::Summary) {
+            trace.Out() << "\n" << indent << "\t\t3) Создаём \"замыкающий узел\" в связи с тем, что все исходы ведут к одному значению целевого признака\n\n\n";
+        }
+        return makeLeaf(targetColumn.GetValue(dataset.GetRows()[0]));
     }
 
-    //  2:     (  )
-    if (dataset.ColumnCount() <= 1) { // ,     
-        return std::make_unique<LeafNode>("()");
+    // Условие 2: Нет признаков для разбиения (остался только целевой)
+    if (dataset.ActiveFeatureCount() == 0) {
+        return makeLeaf("(неопределено)");
     }
 
-    //    
-    double totalEntropy = dataset.CalculateEntropy();
-    oss << "\n" << indent << "\t\t1)       \"" << dataset.GetTargetColumnHeader() << "\": " << totalEntropy;
+    // Условие 3: Ограничения размера дерева - узел на предельной глубине или с малым числом
+    // строк не разбивается и становится листом с преобладающим классом
+    const Options& options = context.options;
+    if ((options.maxDepth != 0 && depth >= options.maxDepth) ||
+        (options.minSamplesSplit != 0 && dataset.RowCount() < options.minSamplesSplit)) {
+        if constexpr (Trace::Summary) {
+            trace.Out() << "\n" << indent << "\t\t3) Создаём \"замыкающий узел\" с преобладающим значением целевого признака: достигнут предел глубины или числа строк\n\n\n";
+        }
+        const auto& counts = dataset.GetClassCounts();
+        auto majority = std::max_element(counts.begin(), counts.end()) - counts.begin();
+        return makeLeaf(targetColumn.GetDictionary().GetValue(static_cast<uint32_t>(majority)));
+    }
 
-    //      " "
-    oss << "\n" << indent << "\t\t2)        G: ";
-    size_t bestFeature = FindBestFeature(dataset, totalEntropy, oss, indent);
-    std::string bestFeatureName = dataset.GetHeaders()[bestFeature];
-    oss << "\n" << indent << "\t\t3)  \" \"   \n\n\n";
-    auto node = std::make_unique<DecisionNode>(bestFeatureName);
+    // Случайное подмножество признаков узла (для ансамблей); без него рассматриваются все
+    std::vector<bool> selected;
+    if (context.options.featureSubset != 0)
+        selected = SampleFeatures(dataset, context.options.featureSubset, seed);
 
-    //        
-    auto uniqueValues = dataset.GetUniqueValues(bestFeature);
-    std::vector<std::string> sortedValues(uniqueValues.begin(), uniqueValues.end());
-    std::sort(sortedValues.begin(), sortedValues.end());
+    // Таблицы сопряжённости признаков за один проход по строкам узла; в режиме гистограмм
+    // их заменяет гистограмма узла, полученная от родителя, а ветвь многопутевого
+    // разбиения строит её сама - только дойдя до поиска разбиения
+    bool parallelCounting = parallel && dataset.RowCount() >= context.options.parallelCountingRows;
+    ContingencyTable table;
+    if (context.bins == nullptr || histogram.Empty()) {
+        if (profile != nullptr)
+            stats.counting.start = profile->Now();
+        if (context.bins == nullptr)
+            table = ContingencyTable::Build(dataset, parallelCounting ? context.pool : nullptr, selected);
+        else
+            histogram = FeatureHistogram::Build(dataset, *context.bins, parallelCounting ? context.pool : nullptr);
+        if (profile != nullptr) {
+            stats.counting.seconds = profile->Now() - stats.counting.start;
+            stats.countedRows = dataset.RowCount();
+        }
+    }
+    const std::vector<uint32_t>& classCounts = context.bins == nullptr ? table.GetClassCounts() : histogram.GetClassCounts();
 
-    //        
-    size_t cILength = (iteration == 1) ? 2 : iteration + 2;
-    std::string childIndent(cILength, ' ');
-    size_t innerCounter = 1;
+    // Неоднородность всего набора данных по критерию разбиения
+    if (profile != nullptr)
+        stats.gain.start = profile->Now();
+    double nodeImpurity = Criterion::Impurity(classCounts.data(), classCounts.size(), dataset.RowCount());
+    if constexpr (Trace::Summary) {
+        if constexpr (Criterion::NodeTitle != nullptr) {
+            trace.Out() << "\n" << indent << "\t\t1) " << Criterion::NodeTitle << " по целевому признаку \"" << source.GetTargetColumnHeader() << "\": " << nodeImpurity;
+        }
+        else {
+            trace.Out() << "\n" << indent << "\t\t1) Строк в наборе: " << dataset.RowCount();
+        }
+        trace.Out() << "\n" << indent << "\t\t2) Поиск нецелевого признака " << Criterion::SearchTitle << ": ";
+    }
+
+    // Поиск лучшего признака и формирование "узла решения"
+    SplitChoice best = context.bins == nullptr ?
+        FindBestFeature<Criterion>(dataset, &table, nullptr, selected, nodeImpurity, trace, indent, context, gainSeconds) :
+        FindBestFeature<Criterion>(dataset, nullptr, &histogram, selected, nodeImpurity, trace, indent, context, gainSeconds);
+    if (profile != nullptr)
+        stats.gain.seconds = profile->Now() - stats.gain.start;
+    if (best.feature == NoFeature || (options.minGain > 0.0 && best.gain < options.minGain)) {
+        // Остались только числовые признаки, и строки узла по ним неразличимы (в режиме
+        // гистограмм - попадают в один интервал), либо прирост лучшего разбиения меньше
+        // заданного минимума. Как в C4.5, лист получает преобладающий класс
+        auto majority = std::max_element(classCounts.begin(), classCounts.end()) - classCounts.begin();
+        return makeLeaf(targetColumn.GetDictionary().GetValue(static_cast<uint32_t>(majority)));
+    }
+    std::string bestFeatureName = source.GetHeaders()[best.feature];
+    if constexpr (Trace::Summary) {
+        trace.Out() << "\n" << indent << "\t\t3) Создаём \"узел решения\" по этому признаку\n\n\n";
+    }
+
+    // Разбиение строк: по порогу на две ветви либо по значениям признака с сортировкой ветвей по значению
+    if (profile != nullptr)
+        stats.partition.start = profile->Now();
+    const DTDictionary* bestValues = nullptr;
+    std::vector<std::pair<uint32_t, DTDatasetView>> children;
+    if (best.numeric) {
+        auto [lessOrEqual, greater] = dataset.PartitionByThreshold(best.feature, best.threshold);
+        children.emplace_back(0, std::move(lessOrEqual));
+        children.emplace_back(1, std::move(greater));
+    }
+    else if (!best.subset.empty()) {
+        auto [members, others] = dataset.PartitionBySubset(best.feature, best.subset);
+        children.emplace_back(0, std::move(members));
+        children.emplace_back(1, std::move(others));
+    }
+    else {
+        bestValues = &source.GetColumn(best.feature).GetDictionary();
+        children = dataset.Partition(best.feature);
+        std::sort(children.begin(), children.end(),
+            [bestValues](const auto& a, const auto& b) {
+                return bestValues->GetValue(a.first) < bestValues->GetValue(b.first);
+            });
+    }
+    PassClassCounts(children, best, context.bins == nullptr ? &table : nullptr, context.bins != nullptr ? &histogram : nullptr, context);
+    if (profile != nullptr)
+        stats.partition.seconds = profile->Now() - stats.partition.start;
+
+    // Гистограммы ветвей нужны только тем, что будут разбиваться дальше. Если дальше разбивается
+    // самая крупная ветвь, остальные считаются по своим строкам, а крупнейшая получается
+    // вычитанием их из гистограммы узла - по её строкам проход не нужен. При многих ветвях
+    // гистограммы всех сразу заняли бы слишком много памяти, и каждая ветвь строит свою сама
+    std::vector<FeatureHistogram> childHistograms(children.size());
+    if (context.bins != nullptr && children.size() <= SubtractionFanout) {
+        double countingStart = 0.0;
+        if (profile != nullptr) {
+            countingStart = profile->Now();
+            if (stats.counting.seconds == 0.0)
+                stats.counting.start = countingStart;
+        }
+        std::vector<bool> needed(children.size());
+        size_t largest = 0;
+        for (size_t i = 0; i < children.size(); ++i) {
+            const DTDatasetView& child = children[i].second;
+            needed[i] = child.ActiveFeatureCount() != 0 && !child.AllSameTargetValue();
+            if (child.RowCount() > children[largest].second.RowCount())
+                largest = i;
+        }
+
+        for (size_t i = 0; i < children.size(); ++i) {
+            if (i == largest || !(needed[i] || needed[largest]))
+                continue;
+            const DTDatasetView& child = children[i].second;
+            bool parallelChild = parallel && child.RowCount() >= context.options.parallelCountingRows;
+            childHistograms[i] = FeatureHistogram::Build(child, *context.bins, parallelChild ? context.pool : nullptr);
+            stats.countedRows += child.RowCount();
+            if (needed[largest])
+                histogram.Subtract(childHistograms[i]);
+        }
+        if (needed[largest])
+            childHistograms[largest] = std::move(histogram);
+        if (profile != nullptr)
+            stats.counting.seconds += profile->Now() - countingStart;
+    }
+    // Поддеревья не держат гистограмму узла в памяти
+    histogram = FeatureHistogram();
+
+    if (profile != nullptr) {
+        stats.feature = bestFeatureName;
+        stats.children = children.size();
+        takeAllocations();
+    }
+
+    // Время узла в профиле охватывает всё его поддерево
+    auto makeNode = [&](const std::vector<const Node*>& results) -> const Node* {
+        if (profile != nullptr)
+            record();
+        if (best.numeric) {
+            auto* node = context.arena->Create<ThresholdNode>(bestFeatureName, best.threshold);
+            node->SetChildren(results[0], results[1]);
+            return node;
+        }
+
+        if (!best.subset.empty()) {
+            const DTDictionary& values = source.GetColumn(best.feature).GetDictionary();
+            auto* node = context.arena->Create<SubsetNode>(bestFeatureName);
+            node->ReserveValues(std::count(best.subset.begin(), best.subset.end(), true));
+            for (uint32_t code = 0; code < best.subset.size(); ++code) {
+                if (best.subset[code])
+                    node->AddValue(values.GetValue(code));
+            }
+            node->SetChildren(results[0], results[1]);
+            return node;
+        }
+
+        auto* node = context.arena->Create<DecisionNode>(bestFeatureName);
+        node->ReserveChildren(children.size());
+        for (size_t i = 0; i < children.size(); ++i) {
+            node->AddChild(bestValues->GetValue(children[i].first), results[i]);
+        }
+        return node;
+    };
+
+    // Отступ ветвей растёт с глубиной узла (а не с номером итерации, иначе описание
+    // больших деревьев растёт квадратично); без описания строка не создаётся
+    std::string childIndent;
+    if constexpr (Trace::Summary) {
+        childIndent = indent.empty() ? std::string(2, ' ') : indent + "  ";
+    }
+    const bool labelled = Trace::Summary || profile != nullptr;
+
+    std::vector<const Node*> results(children.size());
+    if (!parallel) {
+        // Построение ответвлений для каждого из значений лучшего признака
+        for (size_t i = 0; i < children.size(); ++i) {
+            results[i] = BuildTreeInternal<Criterion>(children[i].second, std::move(childHistograms[i]), ChildSeed(seed, i), depth + 1, trace,
+                childIndent, context, labelled ? path + "." + std::to_string(i + 1) : path);
+        }
+
+        return makeNode(results);
+    }
+
+    // Параллельное построение: крупные ветви уходят в пул задачами, мелкие строятся на месте.
+    // Ветви пишут описание в собственные буферы и занимают непересекающиеся отрезки
+    // общего массива индексов, поэтому общего изменяемого состояния у задач нет
+    std::vector<std::ostringstream> streams(Trace::Summary ? children.size() : 0);
+    WorkStealingPool::TaskGroup group;
+    std::exception_ptr inlineError;
+
+    for (size_t i = 0; i < children.size(); ++i) {
+        auto build = [&, i]() {
+            if constexpr (Trace::Summary) {
+                Trace childTrace(streams[i]);
+                results[i] = BuildTreeInternal<Criterion>(children[i].second, std::move(childHistograms[i]), ChildSeed(seed, i), depth + 1, childTrace,
+                    childIndent, context, path + "." + std::to_string(i + 1));
+            }
+            else {
+                results[i] = BuildTreeInternal<Criterion>(children[i].second, std::move(childHistograms[i]), ChildSeed(seed, i), depth + 1, trace,
+                    childIndent, context, labelled ? path + "." + std::to_string(i + 1) : path);
+            }
+        };
+
+        if (children[i].second.RowCount() >= context.options.parallelSubtreeRows) {
+            context.pool->Submit(group, build);
+            continue;
+        }
 
-    for (const auto& value : sortedValues) {
         try {
-            DTDataset subset = dataset.GetFeatureValueSubset(bestFeature, value);
-            subset.SetTargetColumn((dataset.GetTargetColumn() > bestFeature) ? dataset.GetTargetColumn() - 1 : dataset.GetTargetColumn());
-            auto child = BuildTreeInternal(subset, oss, iteration, childIndent);
-            node->AddChild(value, std::move(child));
+            build();
         }
-        catch (const std::invalid_argument&) {
-            auto classDist = dataset.GetClassDistribution();
-            node->AddChild(value, std::make_unique<LeafNode>(classDist.begin()->first));
+        catch (...) {
+            if (!inlineError)
+                inlineError = std::current_exception();
         }
-        innerCounter++;
     }
 
-    return node;
+    context.pool->Wait(group);
+    if (inlineError)
+        std::rethrow_exception(inlineError);
+
+    if constexpr (Trace::Summary) {
+        for (auto& stream : streams) {
+            trace.Out() << stream.str();
+        }
+    }
+
+    return makeNode(results);
 }
 
 
 
+template <typename Criterion>
+const Node* ID3::BuildTraced(DTDatasetView& view, std::ostream& out, const BuildContext& context) {
+    switch (context.options.traceLevel) {
+    case TraceLevel::Off:
+        return BuildTree<Criterion, NoTrace>(view, out, context);
+    case TraceLevel::Summary:
+        return BuildTree<Criterion, StreamTrace<TraceLevel::Summary>>(view, out, context);
+    case TraceLevel::Full:
+        return BuildTree<Criterion, StreamTrace<TraceLevel::Full>>(view, out, context);
+    }
+    return nullptr;
+}
+
 DecisionTree ID3::Train(const DTDataset& dataset) {
+    return Train(dataset, Options());
+}
+
+const DTFeatureBins* ID3::ResolveFeatureBins
+(
+    const DTDataset& dataset,
+    const Options& options,
+    WorkStealingPool* pool,
+    std::unique_ptr<DTFeatureBins>& ownBins
+) {
+    if (options.splitSearch != SplitSearch::Histogram)
+        return nullptr;
+
+    // Корзины признаков берутся из набора, если он разбит заранее (при загрузке) с тем же
+    // числом корзин, иначе строятся один раз на всё обучение
+    const DTFeatureBins* bins = dataset.GetFeatureBins();
+    if (bins == nullptr || (options.histogramBins != 0 && bins->MaxBinCount() != options.histogramBins)) {
+        size_t maxBins = options.histogramBins != 0 ? options.histogramBins : DTFeatureBins::MaxBins;
+        ownBins = std::make_unique<DTFeatureBins>(DTFeatureBins::Build(dataset, maxBins, pool));
+        bins = ownBins.get();
+    }
+    return bins;
+}
+
+DecisionTree ID3::TrainView(DTDatasetView& view, const Options& options, WorkStealingPool* pool, const DTFeatureBins* bins) {
+    const DTDataset& dataset = view.GetDataset();
     DecisionTree tree;
     tree.SetHeaders(dataset.GetHeaders());
     tree.SetTargetColumn(dataset.GetTargetColumn());
     tree.ClearBuildingProcessOSS();
 
-    auto root = BuildTree(dataset, tree.GetBuildingProcessOSS());
-    tree.SetRoot(std::move(root));
+    // Узлы создаются в арене дерева: она освобождается целиком вместе с деревом
+    auto arena = std::make_unique<NodeArena>();
+    BuildContext context{ options, pool, bins, arena.get() };
+
+    // Описание пишется в переданный приёмник (например, файл) или в буфер дерева.
+    // Уровень выбирается здесь один раз: в отключённом режиме построение
+    // инстанцируется с NoTrace и не содержит ни одного обращения к потокам
+    std::ostream& out = options.traceSink != nullptr ?
+        options.traceSink->GetStream() :
+        static_cast<std::ostream&>(tree.GetBuildingProcessOSS());
+
+    // Критерий разбиения тоже выбирается один раз: каждая политика компилируется
+    // в собственный вариант построения со встроенным расчётом оценки
+    const Node* root = nullptr;
+    switch (options.criterion) {
+    case SplitCriterion::InformationGain:
+        root = BuildTraced<InformationGainCriterion>(view, out, context);
+        break;
+    case SplitCriterion::GainRatio:
+        root = BuildTraced<GainRatioCriterion>(view, out, context);
+        break;
+    case SplitCriterion::Gini:
+        root = BuildTraced<GiniCriterion>(view, out, context);
+        break;
+    case SplitCriterion::ChiSquare:
+        root = BuildTraced<ChiSquareCriterion>(view, out, context);
+        break;
+    default:
+        throw std::invalid_argument("Неизвестный критерий разбиения");
+    }
+
+    arena->SetRoot(root);
+    tree.SetNodes(std::move(arena));
     return tree;
-}
\ No newline at end of file
+}
+
+DecisionTree ID3::Train(const DTDataset& dataset, const Options& options) {
+    BuildProfile* profile = options.profile;
+    if (profile != nullptr)
+        profile->Start(dataset);
+
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool);
+
+    BuildProfile::Phase binning;
+    if (profile != nullptr)
+        binning.start = profile->Now();
+    std::unique_ptr<DTFeatureBins> ownBins;
+    const DTFeatureBins* bins = ResolveFeatureBins(dataset, options, pool, ownBins);
+    if (profile != nullptr && bins != nullptr) {
+        binning.seconds = profile->Now() - binning.start;
+        profile->AddStage("binning", binning);
+    }
+
+    DTDatasetView view(dataset);
+    DecisionTree tree = TrainView(view, options, pool, bins);
+
+    // Пост-обрезка: по проверочному набору и/или до заданного числа листьев
+    if (options.validation != nullptr || options.maxLeaves != 0) {
+        BuildProfile::Phase pruning;
+        if (profile != nullptr)
+            pruning.start = profile->Now();
+        tree = TreePruner::Prune(tree, dataset, { options.validation, options.maxLeaves });
+        if (profile != nullptr) {
+            pruning.seconds = profile->Now() - pruning.start;
+            profile->AddStage("pruning", pruning);
+        }
+    }
+
+    if (profile != nullptr)
+        profile->Finish();
+    return tree;
+}
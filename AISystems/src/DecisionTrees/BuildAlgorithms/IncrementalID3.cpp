@@ -0,0 +1,341 @@
+#include <../include/DecisionTrees/BuildAlgorithms/IncrementalID3.h>
+#include <../include/DecisionTrees/BuildAlgorithms/ID3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+IncrementalID3::IncrementalID3(const std::vector<std::string>& headers, size_t targetColumn)
+    : IncrementalID3(headers, targetColumn, Options()) {
+}
+
+IncrementalID3::IncrementalID3(const std::vector<std::string>& headers, size_t targetColumn, const Options& options)
+    : _headers(headers), _targetColumn(targetColumn), _options(options) {
+    if (headers.empty())
+        throw std::invalid_argument("Заголовок не содержит данных");
+    if (targetColumn >= headers.size())
+        throw std::out_of_range("Некорректный индекс целевого столбца");
+    if (options.gracePeriod == 0)
+        throw std::invalid_argument("Число строк между проверками разбиения должно быть больше нуля");
+    if (!(options.splitConfidence > 0.0 && options.splitConfidence < 1.0))
+        throw std::invalid_argument("Допустимая вероятность ошибки разбиения должна быть в интервале (0, 1)");
+
+    _dictionaries.resize(headers.size());
+    _codes.resize(headers.size());
+
+    std::vector<uint32_t> features;
+    for (size_t col = 0; col < headers.size(); ++col) {
+        if (col != targetColumn)
+            features.push_back(static_cast<uint32_t>(col));
+    }
+    AddLeaf(std::move(features), NoClass);
+}
+
+uint32_t IncrementalID3::AddLeaf(std::vector<uint32_t> activeFeatures, uint32_t defaultClass) {
+    IncrementalNode leaf;
+    leaf.defaultClass = defaultClass;
+    leaf.featureCounts.resize(activeFeatures.size());
+    leaf.activeFeatures = std::move(activeFeatures);
+    _nodes.push_back(std::move(leaf));
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+uint32_t IncrementalID3::Route(const uint32_t* codes) {
+    uint32_t index = 0;
+    while (_nodes[index].feature != NoFeature) {
+        const uint32_t code = codes[_nodes[index].feature];
+        if (code < _nodes[index].children.size() && _nodes[index].children[code] != NoChild) {
+            index = _nodes[index].children[code];
+            continue;
+        }
+
+        // Значение, которого не было в листе на момент разбиения, получает новую ветвь;
+        // до накопления своих строк она предсказывает преобладающий класс родителя
+        std::vector<uint32_t> features;
+        for (uint32_t feature : _nodes[index].activeFeatures) {
+            if (feature != _nodes[index].feature)
+                features.push_back(feature);
+        }
+        uint32_t child = AddLeaf(std::move(features), _nodes[index].defaultClass);
+        if (code >= _nodes[index].children.size())
+            _nodes[index].children.resize(code + 1, NoChild);
+        _nodes[index].children[code] = child;
+        index = child;
+    }
+    return index;
+}
+
+void IncrementalID3::CountRow(IncrementalNode& leaf, const uint32_t* codes) {
+    // Достаточная статистика листа - те же матрицы [значение][класс], что строит
+    // ID3 для расчёта прироста. Если появился новый класс, матрицы перекладываются
+    // под новую ширину строки
+    const size_t numClasses = _dictionaries[_targetColumn].Size();
+    if (numClasses > leaf.classStride) {
+        for (auto& counts : leaf.featureCounts) {
+            const size_t numValues = leaf.classStride == 0 ? 0 : counts.size() / leaf.classStride;
+            std::vector<uint32_t> widened(numValues * numClasses, 0);
+            for (size_t v = 0; v < numValues; ++v) {
+                std::copy_n(counts.begin() + v * leaf.classStride, leaf.classStride, widened.begin() + v * numClasses);
+            }
+            counts = std::move(widened);
+        }
+        leaf.classCounts.resize(numClasses, 0);
+        leaf.classStride = numClasses;
+    }
+
+    const uint32_t targetCode = codes[_targetColumn];
+    ++leaf.classCounts[targetCode];
+    for (size_t i = 0; i < leaf.activeFeatures.size(); ++i) {
+        std::vector<uint32_t>& counts = leaf.featureCounts[i];
+        const size_t row = codes[leaf.activeFeatures[i]] * leaf.classStride;
+        if (row + leaf.classStride > counts.size())
+            counts.resize(row + leaf.classStride, 0);
+        ++counts[row + targetCode];
+    }
+    ++leaf.rows;
+}
+
+void IncrementalID3::AttemptSplit(uint32_t index) {
+    IncrementalNode& leaf = _nodes[index];
+    if (leaf.activeFeatures.empty())
+        return;
+
+    const size_t numClasses = leaf.classStride;
+    size_t presentClasses = 0;
+    for (uint32_t count : leaf.classCounts) {
+        if (count != 0)
+            ++presentClasses;
+    }
+    if (presentClasses < 2)
+        return;
+
+    // Приросты признаков считаются той же арифметикой, что и в ID3
+    double totalEntropy = ID3::CalculateEntropy(leaf.classCounts.data(), numClasses, leaf.rows);
+    size_t best = 0;
+    double bestGain = -1.0;
+    double secondGain = 0.0;
+    for (size_t i = 0; i < leaf.activeFeatures.size(); ++i) {
+        const std::vector<uint32_t>& counts = leaf.featureCounts[i];
+        double featureEntropy = 0.0;
+        for (size_t offset = 0; offset < counts.size(); offset += numClasses) {
+            size_t valueRows = 0;
+            for (size_t c = 0; c < numClasses; ++c) {
+                valueRows += counts[offset + c];
+            }
+            if (valueRows == 0)
+                continue;
+
+            double prob = static_cast<double>(valueRows) / leaf.rows;
+            featureEntropy += prob * ID3::CalculateEntropy(counts.data() + offset, numClasses, valueRows);
+        }
+
+        double gain = totalEntropy - featureEntropy;
+        if (gain > bestGain) {
+            secondGain = std::max(secondGain, bestGain);
+            bestGain = gain;
+            best = i;
+        }
+        else {
+            secondGain = std::max(secondGain, gain);
+        }
+    }
+
+    // Граница Хёфдинга: с вероятностью 1 - splitConfidence лучший по выборке признак
+    // остаётся лучшим и на всём потоке, если его отрыв от второго больше epsilon.
+    // Почти равные признаки разбиваются, когда epsilon становится меньше tieThreshold
+    double range = std::log2(static_cast<double>(std::max<size_t>(numClasses, 2)));
+    double epsilon = std::sqrt(range * range * std::log(1.0 / _options.splitConfidence) / (2.0 * leaf.rows));
+    if (bestGain <= 0.0 || (bestGain - secondGain <= epsilon && epsilon >= _options.tieThreshold))
+        return;
+
+    const uint32_t feature = leaf.activeFeatures[best];
+    std::vector<uint32_t> childFeatures;
+    for (uint32_t active : leaf.activeFeatures) {
+        if (active != feature)
+            childFeatures.push_back(active);
+    }
+
+    // Ветви создаются для встреченных в листе значений; каждая начинает с преобладающего
+    // класса своих строк, а статистику копит заново
+    const uint32_t defaultClass = MajorityClass(leaf.classCounts, leaf.defaultClass);
+    std::vector<uint32_t> counts = std::move(leaf.featureCounts[best]);
+    std::vector<uint32_t> children(counts.size() / numClasses, NoChild);
+    for (size_t v = 0; v < children.size(); ++v) {
+        std::vector<uint32_t> valueCounts(counts.begin() + v * numClasses, counts.begin() + (v + 1) * numClasses);
+        if (std::all_of(valueCounts.begin(), valueCounts.end(), [](uint32_t count) { return count == 0; }))
+            continue;
+        children[v] = AddLeaf(childFeatures, MajorityClass(valueCounts, defaultClass));
+    }
+
+    IncrementalNode& node = _nodes[index];
+    node.feature = feature;
+    node.defaultClass = defaultClass;
+    node.children = std::move(children);
+    node.classCounts = std::vector<uint32_t>();
+    node.featureCounts = std::vector<std::vector<uint32_t>>();
+}
+
+void IncrementalID3::Learn(const uint32_t* codes) {
+    uint32_t index = Route(codes);
+    IncrementalNode& leaf = _nodes[index];
+    CountRow(leaf, codes);
+    ++_rows;
+
+    // Разбиение проверяется не на каждой строке, а раз в gracePeriod строк листа
+    if (leaf.rows - leaf.rowsAtLastCheck >= _options.gracePeriod) {
+        leaf.rowsAtLastCheck = leaf.rows;
+        AttemptSplit(index);
+    }
+}
+
+void IncrementalID3::Update(const std::vector<std::string>& row) {
+    if (row.size() != _headers.size()) {
+        std::stringstream ss;
+        ss << "Несоответствие количества столбцов. Ожидалось " << _headers.size()
+            << ", получено " << row.size();
+        throw std::invalid_argument(ss.str());
+    }
+    for (size_t col = 0; col < row.size(); ++col) {
+        if (row[col].empty())
+            throw std::invalid_argument("Пустое значение в столбце " + _headers[col]);
+    }
+
+    for (size_t col = 0; col < row.size(); ++col) {
+        _codes[col] = _dictionaries[col].Intern(row[col]);
+    }
+    Learn(_codes.data());
+}
+
+void IncrementalID3::Update(const DTDataset& dataset) {
+    if (dataset.GetHeaders() != _headers || dataset.GetTargetColumn() != _targetColumn)
+        throw std::invalid_argument("Столбцы набора данных не совпадают со столбцами модели");
+
+    // Коды набора переводятся в коды модели один раз на значение словаря
+    const size_t numColumns = _headers.size();
+    std::vector<std::vector<uint32_t>> mapping(numColumns);
+    for (size_t col = 0; col < numColumns; ++col) {
+        for (const std::string& value : dataset.GetColumn(col).GetDictionary().GetValues()) {
+            mapping[col].push_back(_dictionaries[col].Intern(value));
+        }
+    }
+
+    // Строки обрабатываются порциями: коды порции копируются по столбцам, затем
+    // строки по одной проходят по дереву в порядке набора
+    constexpr size_t BlockRows = 4096;
+    std::vector<std::vector<uint32_t>> block(numColumns, std::vector<uint32_t>(BlockRows));
+    for (size_t begin = 0; begin < dataset.RowCount(); begin += BlockRows) {
+        const size_t rows = std::min(BlockRows, dataset.RowCount() - begin);
+        for (size_t col = 0; col < numColumns; ++col) {
+            dataset.GetColumn(col).VisitCodes([&](const auto* codes) {
+                for (size_t row = 0; row < rows; ++row) {
+                    block[col][row] = mapping[col][codes[begin + row]];
+                }
+            });
+        }
+
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t col = 0; col < numColumns; ++col) {
+                _codes[col] = block[col][row];
+            }
+            Learn(_codes.data());
+        }
+    }
+}
+
+uint32_t IncrementalID3::MajorityClass(const std::vector<uint32_t>& classCounts, uint32_t defaultClass) {
+    uint32_t best = defaultClass;
+    uint32_t bestCount = 0;
+    for (size_t c = 0; c < classCounts.size(); ++c) {
+        if (classCounts[c] > bestCount) {
+            bestCount = classCounts[c];
+            best = static_cast<uint32_t>(c);
+        }
+    }
+    return best;
+}
+
+std::string IncrementalID3::Predict(const std::vector<std::string>& sample) const {
+    if (sample.size() != _headers.size() - 1) {
+        std::stringstream ss;
+        ss << "Несоответствие количества признаков. Ожидалось " << _headers.size() - 1
+            << ", получено " << sample.size();
+        throw std::invalid_argument(ss.str());
+    }
+
+    // Пример для предсказания передаётся без целевого столбца
+    uint32_t index = 0;
+    while (_nodes[index].feature != NoFeature) {
+        const IncrementalNode& node = _nodes[index];
+        const size_t position = node.feature < _targetColumn ? node.feature : node.feature - 1;
+        uint32_t code = _dictionaries[node.feature].Find(sample[position]);
+        if (code >= node.children.size() || node.children[code] == NoChild)
+            return "(неизвестно)";
+        index = node.children[code];
+    }
+
+    uint32_t classCode = MajorityClass(_nodes[index].classCounts, _nodes[index].defaultClass);
+    return classCode == NoClass ? "(неопределено)" : _dictionaries[_targetColumn].GetValue(classCode);
+}
+
+const Node* IncrementalID3::BuildNodes(uint32_t index, NodeArena& arena) const {
+    const IncrementalNode& node = _nodes[index];
+    if (node.feature == NoFeature) {
+        uint32_t classCode = MajorityClass(node.classCounts, node.defaultClass);
+        return arena.Create<LeafNode>(classCode == NoClass ? "(неопределено)" : _dictionaries[_targetColumn].GetValue(classCode));
+    }
+
+    // Ветви упорядочиваются по значению, как в ID3
+    const DTDictionary& values = _dictionaries[node.feature];
+    std::vector<uint32_t> codes;
+    for (size_t v = 0; v < node.children.size(); ++v) {
+        if (node.children[v] != NoChild)
+            codes.push_back(static_cast<uint32_t>(v));
+    }
+    std::sort(codes.begin(), codes.end(),
+        [&values](uint32_t a, uint32_t b) {
+            return values.GetValue(a) < values.GetValue(b);
+        });
+
+    auto* result = arena.Create<DecisionNode>(_headers[node.feature]);
+    result->ReserveChildren(codes.size());
+    for (uint32_t code : codes) {
+        result->AddChild(values.GetValue(code), BuildNodes(node.children[code], arena));
+    }
+    return result;
+}
+
+DecisionTree IncrementalID3::GetTree() const {
+    DecisionTree tree;
+    tree.SetHeaders(_headers);
+    tree.SetTargetColumn(_targetColumn);
+    tree.ClearBuildingProcessOSS();
+
+    auto arena = std::make_unique<NodeArena>();
+    arena->SetRoot(BuildNodes(0, *arena));
+    tree.SetNodes(std::move(arena));
+    return tree;
+}
+
+size_t IncrementalID3::RowCount() const {
+    return _rows;
+}
+
+size_t IncrementalID3::NodeCount() const {
+    return _nodes.size();
+}
+
+size_t IncrementalID3::MemoryUsage() const {
+    size_t bytes = _nodes.capacity() * sizeof(IncrementalNode);
+    for (const IncrementalNode& node : _nodes) {
+        bytes += (node.children.capacity() + node.classCounts.capacity() + node.activeFeatures.capacity()) * sizeof(uint32_t)
+            + node.featureCounts.capacity() * sizeof(std::vector<uint32_t>);
+        for (const auto& counts : node.featureCounts) {
+            bytes += counts.capacity() * sizeof(uint32_t);
+        }
+    }
+    for (const DTDictionary& dictionary : _dictionaries) {
+        bytes += dictionary.MemoryUsage();
+    }
+    return bytes;
+}
@@ -0,0 +1,10 @@
+#include <../include/DecisionTrees/BuildAlgorithms/SplitCriteria.h>
+
+// Таблица n*log2(n) для малых счётчиков: энтропия узлов и ветвей считается без логарифмов
+const std::array<double, NLog2N::TableSize> NLog2N::_table = []() {
+    std::array<double, TableSize> table{};
+    for (size_t n = 1; n < TableSize; ++n) {
+        table[n] = static_cast<double>(n) * std::log2(static_cast<double>(n));
+    }
+    return table;
+}();
@@ -0,0 +1,279 @@
+#include <../include/DecisionTrees/BuildAlgorithms/StreamingID3.h>
+#include <../include/DecisionTrees/BuildAlgorithms/ID3.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+uint32_t StreamingID3::Route(const std::vector<StreamNode>& nodes, const DTCodeChunk& chunk, size_t row) {
+    uint32_t index = 0;
+    while (nodes[index].state == NodeState::Split) {
+        const StreamNode& node = nodes[index];
+        uint32_t code = chunk.columns[node.feature][row];
+        if (code >= node.children.size() || node.children[code] == NoChild)
+            return NoChild;
+        index = node.children[code];
+    }
+    return index;
+}
+
+size_t StreamingID3::CountSize(const StreamNode& node, const TrainContext& context) {
+    // Распределение классов узла и матрицы [значение][класс] его активных признаков
+    size_t cells = context.numClasses;
+    for (uint32_t feature : node.activeFeatures) {
+        cells += context.cardinalities[feature] * context.numClasses;
+    }
+    return cells;
+}
+
+void StreamingID3::ThrowInvalidCode(const TrainContext& context, size_t column) {
+    const auto& headers = context.source.GetHeaders();
+    std::string name = column < headers.size() ? headers[column] : std::to_string(column);
+    throw std::runtime_error("Источник данных вернул код вне словаря столбца \"" + name + "\"");
+}
+
+void StreamingID3::CountGroup
+(
+    std::vector<StreamNode>& nodes,
+    const std::vector<size_t>& nodeOffsets,
+    std::vector<uint32_t>& counts,
+    const TrainContext& context
+) {
+    const size_t numClasses = context.numClasses;
+    DTCodeChunk chunk;
+
+    // Один проход по источнику: строка спускается по уже построенной части дерева
+    // и учитывается, только если попала в узел текущей группы
+    context.source.Rewind();
+    while (context.source.ReadChunk(chunk, context.options.chunkRows)) {
+        const uint32_t* targetCodes = chunk.columns[context.targetColumn].data();
+        for (size_t row = 0; row < chunk.rows; ++row) {
+            uint32_t index = Route(nodes, chunk, row);
+            if (index == NoChild || nodes[index].slot == NoChild)
+                continue;
+
+            // Коды источника (например, повреждённого файла) не принимаются на веру:
+            // код вне словаря указывал бы за пределы матрицы узла
+            const StreamNode& node = nodes[index];
+            const uint32_t targetCode = targetCodes[row];
+            if (targetCode >= numClasses)
+                ThrowInvalidCode(context, context.targetColumn);
+            uint32_t* nodeCounts = counts.data() + nodeOffsets[node.slot];
+            ++nodeCounts[targetCode];
+
+            size_t offset = numClasses;
+            for (uint32_t feature : node.activeFeatures) {
+                const uint32_t code = chunk.columns[feature][row];
+                if (code >= context.cardinalities[feature])
+                    ThrowInvalidCode(context, feature);
+                ++nodeCounts[offset + code * numClasses + targetCode];
+                offset += context.cardinalities[feature] * numClasses;
+            }
+        }
+    }
+}
+
+void StreamingID3::DecideNode
+(
+    std::vector<StreamNode>& nodes,
+    uint32_t index,
+    const uint32_t* counts,
+    const TrainContext& context,
+    std::vector<uint32_t>& nextLevel
+) {
+    const size_t numClasses = context.numClasses;
+    const DTDictionary& targetValues = context.source.GetDictionary(context.targetColumn);
+
+    size_t totalRows = 0;
+    size_t presentClasses = 0;
+    uint32_t lastClass = 0;
+    for (size_t c = 0; c < numClasses; ++c) {
+        totalRows += counts[c];
+        if (counts[c] != 0) {
+            ++presentClasses;
+            lastClass = static_cast<uint32_t>(c);
+        }
+    }
+
+    if (totalRows == 0)
+        throw std::runtime_error("Источник данных не содержит строк");
+
+    // Условия выхода те же, что у ID3: все строки одного класса или не осталось признаков
+    if (presentClasses == 1) {
+        nodes[index].state = NodeState::Leaf;
+        nodes[index].label = targetValues.GetValue(lastClass);
+        return;
+    }
+    if (nodes[index].activeFeatures.empty()) {
+        nodes[index].state = NodeState::Leaf;
+        nodes[index].label = "(неопределено)";
+        return;
+    }
+
+    // Прирост считается той же политикой критерия, что и в ID3 по умолчанию (информационный прирост),
+    // поэтому выбор признака совпадает с обучением на наборе в памяти
+    double totalEntropy = InformationGainCriterion::Impurity(counts, numClasses, totalRows);
+    uint32_t bestFeature = 0;
+    const uint32_t* bestCounts = nullptr;
+    double maxGain = -1.0;
+
+    const uint32_t* featureCounts = counts + numClasses;
+    for (uint32_t feature : nodes[index].activeFeatures) {
+        const size_t numValues = context.cardinalities[feature];
+        InformationGainCriterion::Split split;
+        for (size_t v = 0; v < numValues; ++v) {
+            const uint32_t* targetCounts = featureCounts + v * numClasses;
+            size_t totalVCount = 0;
+            for (size_t c = 0; c < numClasses; ++c) {
+                totalVCount += targetCounts[c];
+            }
+
+            if (totalVCount == 0)
+                continue;
+
+            InformationGainCriterion::AddBranch(split, targetCounts, counts, numClasses, totalVCount);
+        }
+
+        double gain = InformationGainCriterion::Score(split, totalEntropy, totalRows);
+        if (gain > maxGain) {
+            maxGain = gain;
+            bestFeature = feature;
+            bestCounts = featureCounts;
+        }
+        featureCounts += numValues * numClasses;
+    }
+
+    // Ветви создаются для значений, встретившихся в строках узла
+    std::vector<uint32_t> childFeatures;
+    for (uint32_t feature : nodes[index].activeFeatures) {
+        if (feature != bestFeature)
+            childFeatures.push_back(feature);
+    }
+
+    const size_t numValues = context.cardinalities[bestFeature];
+    std::vector<uint32_t> children(numValues, NoChild);
+    for (size_t v = 0; v < numValues; ++v) {
+        const uint32_t* targetCounts = bestCounts + v * numClasses;
+        if (std::all_of(targetCounts, targetCounts + numClasses, [](uint32_t count) { return count == 0; }))
+            continue;
+
+        children[v] = static_cast<uint32_t>(nodes.size());
+        nextLevel.push_back(children[v]);
+        StreamNode child;
+        child.activeFeatures = childFeatures;
+        nodes.push_back(std::move(child));
+    }
+
+    StreamNode& node = nodes[index];
+    node.state = NodeState::Split;
+    node.feature = bestFeature;
+    node.children = std::move(children);
+    node.activeFeatures.clear();
+    node.activeFeatures.shrink_to_fit();
+}
+
+const Node* StreamingID3::BuildNodes(const DTRowSource& source, const std::vector<StreamNode>& nodes, uint32_t index, NodeArena& arena) {
+    const StreamNode& node = nodes[index];
+    if (node.state == NodeState::Leaf)
+        return arena.Create<LeafNode>(node.label);
+
+    const std::vector<std::string>& headers = source.GetHeaders();
+    std::string featureName = node.feature < headers.size() ? headers[node.feature] : std::to_string(node.feature);
+    auto* result = arena.Create<DecisionNode>(featureName);
+
+    // Ветви упорядочиваются по значению, как в ID3
+    const DTDictionary& values = source.GetDictionary(node.feature);
+    std::vector<uint32_t> codes;
+    for (size_t v = 0; v < node.children.size(); ++v) {
+        if (node.children[v] != NoChild)
+            codes.push_back(static_cast<uint32_t>(v));
+    }
+    std::sort(codes.begin(), codes.end(),
+        [&values](uint32_t a, uint32_t b) {
+            return values.GetValue(a) < values.GetValue(b);
+        });
+
+    result->ReserveChildren(codes.size());
+    for (uint32_t code : codes) {
+        result->AddChild(values.GetValue(code), BuildNodes(source, nodes, node.children[code], arena));
+    }
+    return result;
+}
+
+
+
+DecisionTree StreamingID3::Train(DTRowSource& source, size_t targetColumn) {
+    return Train(source, targetColumn, Options());
+}
+
+DecisionTree StreamingID3::Train(DTRowSource& source, size_t targetColumn, const Options& options) {
+    if (targetColumn >= source.ColumnCount())
+        throw std::out_of_range("Некорректный индекс целевого столбца");
+    if (options.chunkRows == 0)
+        throw std::invalid_argument("Размер порции строк должен быть больше нуля");
+
+    // Источнику без готовых словарей (CSV) нужен предварительный проход,
+    // чтобы узнать число значений каждого признака
+    DTCodeChunk chunk;
+    if (!source.DictionariesComplete()) {
+        source.Rewind();
+        while (source.ReadChunk(chunk, options.chunkRows)) {
+        }
+    }
+
+    TrainContext context{ source, targetColumn, source.GetDictionary(targetColumn).Size(), {}, options };
+    for (size_t col = 0; col < source.ColumnCount(); ++col) {
+        context.cardinalities.push_back(source.GetDictionary(col).Size());
+    }
+
+    std::vector<StreamNode> nodes(1);
+    for (size_t col = 0; col < source.ColumnCount(); ++col) {
+        if (col != targetColumn)
+            nodes[0].activeFeatures.push_back(static_cast<uint32_t>(col));
+    }
+
+    // Дерево строится по уровням: за проход по источнику считаются таблицы сопряжённости
+    // всех узлов очередного уровня. Если таблицы не помещаются в maxCountBytes,
+    // уровень обрабатывается группами, по проходу на группу
+    std::vector<uint32_t> level{ 0 };
+    std::vector<uint32_t> counts;
+    std::vector<size_t> nodeOffsets;
+    while (!level.empty()) {
+        std::vector<uint32_t> nextLevel;
+        size_t begin = 0;
+        while (begin < level.size()) {
+            size_t end = begin;
+            size_t cells = 0;
+            nodeOffsets.clear();
+            while (end < level.size()) {
+                size_t nodeCells = CountSize(nodes[level[end]], context);
+                if (end > begin && (cells + nodeCells) * sizeof(uint32_t) > options.maxCountBytes)
+                    break;
+                nodes[level[end]].slot = static_cast<uint32_t>(nodeOffsets.size());
+                nodeOffsets.push_back(cells);
+                cells += nodeCells;
+                ++end;
+            }
+
+            counts.assign(cells, 0);
+            CountGroup(nodes, nodeOffsets, counts, context);
+
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t index = level[i];
+                const uint32_t* nodeCounts = counts.data() + nodeOffsets[nodes[index].slot];
+                nodes[index].slot = NoChild;
+                DecideNode(nodes, index, nodeCounts, context, nextLevel);
+            }
+            begin = end;
+        }
+        level = std::move(nextLevel);
+    }
+
+    DecisionTree tree;
+    tree.SetHeaders(source.GetHeaders());
+    tree.SetTargetColumn(targetColumn);
+    tree.ClearBuildingProcessOSS();
+    auto arena = std::make_unique<NodeArena>();
+    arena->SetRoot(BuildNodes(source, nodes, 0, *arena));
+    tree.SetNodes(std::move(arena));
+    return tree;
+}
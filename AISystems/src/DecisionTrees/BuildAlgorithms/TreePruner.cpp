@@ -0,0 +1,389 @@
+#include <../include/DecisionTrees/BuildAlgorithms/TreePruner.h>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+size_t TreePruner::FindColumn(const DTDataset& dataset, std::string_view header) {
+    const auto& headers = dataset.GetHeaders();
+    auto it = std::find(headers.begin(), headers.end(), header);
+    if (it == headers.end())
+        throw std::invalid_argument("В наборе данных нет столбца " + std::string(header));
+    return static_cast<size_t>(it - headers.begin());
+}
+
+size_t TreePruner::CountErrors(const DTDatasetView* view, uint32_t classCode, const PruneContext& context, bool validation) {
+    if (view == nullptr)
+        return 0;
+
+    // Классы проверочного набора сравниваются с меткой через коды обучающего набора
+    const auto& counts = view->GetClassCounts();
+    size_t correct = 0;
+    for (size_t code = 0; code < counts.size(); ++code) {
+        uint32_t trainingCode = validation ? context.validationClasses[code] : static_cast<uint32_t>(code);
+        if (trainingCode == classCode && classCode != DTDictionary::NoCode)
+            correct += counts[code];
+    }
+    return view->RowCount() - correct;
+}
+
+uint32_t TreePruner::Collect
+(
+    const Node* node,
+    DTDatasetView* training,
+    DTDatasetView* validation,
+    uint32_t parent,
+    PruneContext& context
+) {
+    const uint32_t index = static_cast<uint32_t>(context.nodes.size());
+    context.nodes.emplace_back();
+    context.nodes[index].node = node;
+    context.nodes[index].parent = parent;
+
+    // Преобладающий класс обучающих строк - метка, которую узел получит, если станет листом
+    uint32_t majority = DTDictionary::NoCode;
+    if (training != nullptr && training->RowCount() != 0) {
+        const auto& counts = training->GetClassCounts();
+        majority = static_cast<uint32_t>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+    }
+    context.nodes[index].majority = majority;
+    context.nodes[index].leafErrors = CountErrors(training, majority, context, false);
+    context.nodes[index].validationLeafErrors = CountErrors(validation, majority, context, true);
+
+    const DTDictionary& classes = context.training.GetColumn(context.training.GetTargetColumn()).GetDictionary();
+    if (const auto* leaf = dynamic_cast<const LeafNode*>(node)) {
+        uint32_t label = classes.Find(leaf->GetResult());
+        context.nodes[index].treeErrors = CountErrors(training, label, context, false);
+        context.nodes[index].validationTreeErrors = CountErrors(validation, label, context, true);
+        return index;
+    }
+
+    // Строки узла раскладываются по ветвям так же, как их раскладывало обучение. Строки
+    // со значением, для которого ветви нет, дерево предсказывает как неизвестные - это ошибки
+    std::vector<const Node*> childNodes;
+    std::vector<DTDatasetView*> trainingChildren;
+    std::vector<DTDatasetView*> validationChildren;
+    std::vector<std::pair<uint32_t, DTDatasetView>> trainingParts;
+    std::vector<std::pair<uint32_t, DTDatasetView>> validationParts;
+    std::optional<std::pair<DTDatasetView, DTDatasetView>> trainingHalves;
+    std::optional<std::pair<DTDatasetView, DTDatasetView>> validationHalves;
+    size_t dropped = 0;
+    size_t validationDropped = 0;
+
+    if (const auto* split = dynamic_cast<const ThresholdNode*>(node)) {
+        childNodes = { split->GetLessOrEqual(), split->GetGreater() };
+        trainingChildren.assign(2, nullptr);
+        validationChildren.assign(2, nullptr);
+        auto assign = [&](DTDatasetView* view, const DTDataset& dataset,
+            std::optional<std::pair<DTDatasetView, DTDatasetView>>& halves, std::vector<DTDatasetView*>& targets, size_t& lost) {
+            if (view == nullptr)
+                return;
+            size_t column = FindColumn(dataset, split->GetFeatureName());
+            if (dataset.GetColumn(column).IsNumeric()) {
+                halves.emplace(view->PartitionByThreshold(column, split->GetThreshold()));
+            }
+            else {
+                // Проверочный набор мог быть загружен без распознавания чисел: значения словаря
+                // разбираются так же, как при предсказании, а нечисловые значения ветви не имеют
+                const auto& values = dataset.GetColumn(column).GetDictionary().GetValues();
+                std::vector<bool> parsed(values.size(), false);
+                std::vector<bool> lessOrEqual(values.size(), false);
+                for (size_t code = 0; code < values.size(); ++code) {
+                    float number = 0.0f;
+                    parsed[code] = DTParseNumber(values[code], number);
+                    lessOrEqual[code] = parsed[code] && number <= split->GetThreshold();
+                }
+                auto [numbers, other] = view->PartitionBySubset(column, parsed);
+                lost += other.RowCount();
+                halves.emplace(numbers.PartitionBySubset(column, lessOrEqual));
+            }
+            DTDatasetView* parts[2] = { &halves->first, &halves->second };
+            for (size_t i = 0; i < 2; ++i) {
+                if (childNodes[i] != nullptr)
+                    targets[i] = parts[i];
+                else
+                    lost += parts[i]->RowCount();
+            }
+        };
+        assign(training, context.training, trainingHalves, trainingChildren, dropped);
+        if (validation != nullptr)
+            assign(validation, *context.validation, validationHalves, validationChildren, validationDropped);
+    }
+    else if (const auto* subset = dynamic_cast<const SubsetNode*>(node)) {
+        childNodes = { subset->GetInSubset(), subset->GetOther() };
+        trainingChildren.assign(2, nullptr);
+        validationChildren.assign(2, nullptr);
+        auto assign = [&](DTDatasetView* view, const DTDataset& dataset,
+            std::optional<std::pair<DTDatasetView, DTDatasetView>>& halves, std::vector<DTDatasetView*>& targets, size_t& lost) {
+            if (view == nullptr)
+                return;
+            // Подмножество узла хранит значения строками, для набора они переводятся в его коды
+            size_t column = FindColumn(dataset, subset->GetFeatureName());
+            if (dataset.GetColumn(column).IsNumeric())
+                throw std::invalid_argument("Столбец " + std::string(subset->GetFeatureName()) + " в наборе числовой, а дерево делит его как категориальный");
+            const DTDictionary& values = dataset.GetColumn(column).GetDictionary();
+            std::vector<bool> inSubset(values.Size(), false);
+            for (const auto& value : subset->GetValues()) {
+                uint32_t code = values.Find(value);
+                if (code != DTDictionary::NoCode)
+                    inSubset[code] = true;
+            }
+            halves.emplace(view->PartitionBySubset(column, inSubset));
+            DTDatasetView* parts[2] = { &halves->first, &halves->second };
+            for (size_t i = 0; i < 2; ++i) {
+                if (childNodes[i] != nullptr)
+                    targets[i] = parts[i];
+                else
+                    lost += parts[i]->RowCount();
+            }
+        };
+        assign(training, context.training, trainingHalves, trainingChildren, dropped);
+        if (validation != nullptr)
+            assign(validation, *context.validation, validationHalves, validationChildren, validationDropped);
+    }
+    else if (const auto* decision = dynamic_cast<const DecisionNode*>(node)) {
+        const auto& children = decision->GetChildren();
+        for (const auto& child : children) {
+            childNodes.push_back(child.second);
+        }
+        trainingChildren.assign(children.size(), nullptr);
+        validationChildren.assign(children.size(), nullptr);
+        auto assign = [&](DTDatasetView* view, const DTDataset& dataset,
+            std::vector<std::pair<uint32_t, DTDatasetView>>& parts, std::vector<DTDatasetView*>& targets, size_t& lost) {
+            if (view == nullptr)
+                return;
+            size_t column = FindColumn(dataset, decision->GetFeatureName());
+            const DTDictionary& values = dataset.GetColumn(column).GetDictionary();
+            parts = view->Partition(column);
+            for (auto& [code, part] : parts) {
+                std::string_view value = values.GetValue(code);
+                auto it = std::lower_bound(children.begin(), children.end(), value,
+                    [](const DecisionNode::Child& a, std::string_view b) { return std::string_view(a.first) < b; });
+                if (it != children.end() && std::string_view(it->first) == value)
+                    targets[it - children.begin()] = &part;
+                else
+                    lost += part.RowCount();
+            }
+        };
+        assign(training, context.training, trainingParts, trainingChildren, dropped);
+        if (validation != nullptr)
+            assign(validation, *context.validation, validationParts, validationChildren, validationDropped);
+    }
+    else {
+        throw std::invalid_argument("Неизвестный тип узла дерева решений");
+    }
+
+    size_t treeErrors = dropped;
+    size_t validationTreeErrors = validationDropped;
+    size_t leaves = 0;
+    std::vector<uint32_t> children(childNodes.size(), NoNode);
+    for (size_t i = 0; i < childNodes.size(); ++i) {
+        if (childNodes[i] == nullptr)
+            continue;
+        children[i] = Collect(childNodes[i], trainingChildren[i], validationChildren[i], index, context);
+        treeErrors += context.nodes[children[i]].treeErrors;
+        validationTreeErrors += context.nodes[children[i]].validationTreeErrors;
+        leaves += context.nodes[children[i]].leaves;
+    }
+
+    PruneNode& result = context.nodes[index];
+    result.children = std::move(children);
+    result.treeErrors = treeErrors;
+    result.validationTreeErrors = validationTreeErrors;
+    result.leaves = leaves;
+
+    // Обрезка по проверочному набору (reduced-error): поддеревья обходятся снизу вверх,
+    // и узел сворачивается в лист, если на проверочных строках лист ошибается не чаще. Поддеревья,
+    // до которых не дошла ни одна проверочная строка, не оцениваются и остаются как есть
+    if (validation != nullptr && validation->RowCount() != 0 && result.validationLeafErrors <= result.validationTreeErrors) {
+        result.pruned = true;
+        result.treeErrors = result.leafErrors;
+        result.validationTreeErrors = result.validationLeafErrors;
+        result.leaves = 1;
+    }
+    return index;
+}
+
+void TreePruner::LimitLeaves(std::vector<PruneNode>& nodes, size_t maxLeaves) {
+    // Узлы под уже свёрнутыми поддеревьями в дереве не остаются
+    std::vector<bool> removed(nodes.size(), true);
+    std::vector<uint32_t> stack{ 0 };
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        removed[index] = false;
+        if (nodes[index].pruned)
+            continue;
+        for (uint32_t child : nodes[index].children) {
+            if (child != NoNode)
+                stack.push_back(child);
+        }
+    }
+
+    // Обрезка по слабейшему звену (cost-complexity): каждый раз сворачивается узел, у которого
+    // прирост ошибок на обучении в расчёте на убранный лист минимален. Изменения поддерева
+    // поднимаются к предкам, их устаревшие записи в очереди отбрасываются по номеру версии.
+    // Узел, после сворачивания которого листьев станет меньше maxLeaves, откладывается
+    using Entry = std::tuple<double, uint32_t, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::vector<uint32_t> versions(nodes.size(), 0);
+    auto push = [&](uint32_t index) {
+        const PruneNode& node = nodes[index];
+        if (node.pruned || node.leaves <= 1)
+            return;
+        double alpha = (static_cast<double>(node.leafErrors) - static_cast<double>(node.treeErrors)) / (node.leaves - 1);
+        queue.emplace(alpha, index, versions[index]);
+    };
+    for (uint32_t index = 0; index < nodes.size(); ++index) {
+        if (!removed[index])
+            push(index);
+    }
+
+    auto collapse = [&](uint32_t index) {
+        PruneNode& node = nodes[index];
+        const size_t removedLeaves = node.leaves - 1;
+        const size_t treeErrors = node.treeErrors;
+        node.pruned = true;
+        node.treeErrors = node.leafErrors;
+        node.leaves = 1;
+
+        stack.assign(node.children.begin(), node.children.end());
+        while (!stack.empty()) {
+            uint32_t child = stack.back();
+            stack.pop_back();
+            if (child == NoNode || removed[child])
+                continue;
+            removed[child] = true;
+            stack.insert(stack.end(), nodes[child].children.begin(), nodes[child].children.end());
+        }
+
+        for (uint32_t ancestor = node.parent; ancestor != NoNode; ancestor = nodes[ancestor].parent) {
+            nodes[ancestor].leaves -= removedLeaves;
+            nodes[ancestor].treeErrors = nodes[ancestor].treeErrors - treeErrors + node.leafErrors;
+            versions[ancestor]++;
+            push(ancestor);
+        }
+    };
+
+    std::vector<uint32_t> deferred;
+    while (nodes[0].leaves > maxLeaves && !queue.empty()) {
+        auto [alpha, index, version] = queue.top();
+        queue.pop();
+        if (removed[index] || nodes[index].pruned || version != versions[index])
+            continue;
+        if (nodes[0].leaves - (nodes[index].leaves - 1) < maxLeaves) {
+            deferred.push_back(index);
+            continue;
+        }
+        collapse(index);
+    }
+
+    // Если ни один узел не сворачивается без перебора (у многоветвенных узлов листья уходят
+    // сразу группой), сворачивается отложенный узел с наименьшим числом листьев
+    if (nodes[0].leaves > maxLeaves) {
+        uint32_t best = NoNode;
+        for (uint32_t index : deferred) {
+            if (removed[index] || nodes[index].pruned)
+                continue;
+            if (best == NoNode || nodes[index].leaves < nodes[best].leaves)
+                best = index;
+        }
+        if (best != NoNode)
+            collapse(best);
+    }
+}
+
+const Node* TreePruner::CopyNodes(const PruneContext& context, uint32_t index, NodeArena& arena) {
+    const PruneNode& pruneNode = context.nodes[index];
+    if (pruneNode.pruned) {
+        const DTDictionary& classes = context.training.GetColumn(context.training.GetTargetColumn()).GetDictionary();
+        return arena.Create<LeafNode>(pruneNode.majority == DTDictionary::NoCode ? "(неопределено)" : classes.GetValue(pruneNode.majority));
+    }
+
+    if (const auto* leaf = dynamic_cast<const LeafNode*>(pruneNode.node))
+        return arena.Create<LeafNode>(leaf->GetResult());
+
+    if (const auto* split = dynamic_cast<const ThresholdNode*>(pruneNode.node)) {
+        auto* node = arena.Create<ThresholdNode>(split->GetFeatureName(), split->GetThreshold());
+        const Node* children[2] = { nullptr, nullptr };
+        for (size_t i = 0; i < 2; ++i) {
+            if (pruneNode.children[i] != NoNode)
+                children[i] = CopyNodes(context, pruneNode.children[i], arena);
+        }
+        node->SetChildren(children[0], children[1]);
+        return node;
+    }
+
+    if (const auto* subset = dynamic_cast<const SubsetNode*>(pruneNode.node)) {
+        auto* node = arena.Create<SubsetNode>(subset->GetFeatureName());
+        node->ReserveValues(subset->GetValues().size());
+        for (const auto& value : subset->GetValues()) {
+            node->AddValue(value);
+        }
+        const Node* children[2] = { nullptr, nullptr };
+        for (size_t i = 0; i < 2; ++i) {
+            if (pruneNode.children[i] != NoNode)
+                children[i] = CopyNodes(context, pruneNode.children[i], arena);
+        }
+        node->SetChildren(children[0], children[1]);
+        return node;
+    }
+
+    const auto* decision = static_cast<const DecisionNode*>(pruneNode.node);
+    auto* node = arena.Create<DecisionNode>(decision->GetFeatureName());
+    node->ReserveChildren(decision->GetChildren().size());
+    for (size_t i = 0; i < decision->GetChildren().size(); ++i) {
+        node->AddChild(decision->GetChildren()[i].first, CopyNodes(context, pruneNode.children[i], arena));
+    }
+    return node;
+}
+
+
+
+DecisionTree TreePruner::Prune(const DecisionTree& tree, const DTDataset& training, const Options& options) {
+    DTDatasetView trainingView(training);
+    return Prune(tree, trainingView, options);
+}
+
+DecisionTree TreePruner::Prune(const DecisionTree& tree, DTDatasetView& trainingView, const Options& options) {
+    // Обучающие строки могут быть частью набора (например, обучающие блоки перекрёстной проверки)
+    const DTDataset& training = trainingView.GetDataset();
+    const Node* root = tree.GetRoot();
+    if (root == nullptr)
+        throw std::invalid_argument("Обрезать можно только обученное дерево: у загруженной из файла модели нет узлов");
+    if (training.GetHeaders()[training.GetTargetColumn()] != tree.GetHeaders()[tree.GetTargetColumn()])
+        throw std::invalid_argument("Целевой столбец обучающего набора не совпадает с целевым столбцом дерева");
+
+    PruneContext context{ training, options.validation, {}, {} };
+    std::optional<DTDatasetView> validationView;
+    if (options.validation != nullptr) {
+        const DTDataset& validation = *options.validation;
+        if (FindColumn(validation, tree.GetHeaders()[tree.GetTargetColumn()]) != validation.GetTargetColumn())
+            throw std::invalid_argument("Целевой столбец проверочного набора не совпадает с целевым столбцом дерева");
+
+        // Словари наборов разные: классы проверочного набора переводятся в коды обучающего
+        const DTDictionary& classes = training.GetColumn(training.GetTargetColumn()).GetDictionary();
+        for (const std::string& value : validation.GetColumn(validation.GetTargetColumn()).GetDictionary().GetValues()) {
+            context.validationClasses.push_back(classes.Find(value));
+        }
+        validationView.emplace(validation);
+    }
+
+    Collect(root, &trainingView, validationView ? &*validationView : nullptr, NoNode, context);
+    if (options.maxLeaves != 0)
+        LimitLeaves(context.nodes, options.maxLeaves);
+
+    DecisionTree result;
+    result.SetHeaders(tree.GetHeaders());
+    result.SetTargetColumn(tree.GetTargetColumn());
+    result.ClearBuildingProcessOSS();
+    result.GetBuildingProcessOSS() << tree.GetBuildingProcessDescr();
+
+    auto arena = std::make_unique<NodeArena>();
+    arena->SetRoot(CopyNodes(context, 0, *arena));
+    result.SetNodes(std::move(arena));
+    return result;
+}
@@ -0,0 +1,343 @@
+#include <../include/DecisionTrees/DTColumn.h>
+
+#include <cstring>
+#include <stdexcept>
+
+uint32_t DTDictionary::Intern(std::string_view value) {
+    auto it = _codes.find(value);
+    if (it != _codes.end())
+        return it->second;
+
+    if (_values.size() >= NoCode) {
+        throw std::length_error("Слишком много уникальных значений в столбце");
+    }
+
+    uint32_t code = static_cast<uint32_t>(_values.size());
+    _values.emplace_back(value);
+    _codes.emplace(_values.back(), code);
+    return code;
+}
+
+uint32_t DTDictionary::Find(std::string_view value) const {
+    auto it = _codes.find(value);
+    return it == _codes.end() ? NoCode : it->second;
+}
+
+const std::string& DTDictionary::GetValue(uint32_t code) const {
+    return _values[code];
+}
+
+const std::vector<std::string>& DTDictionary::GetValues() const {
+    return _values;
+}
+
+size_t DTDictionary::Size() const {
+    return _values.size();
+}
+
+size_t DTDictionary::MemoryUsage() const {
+    size_t bytes = _values.capacity() * sizeof(std::string)
+        + _codes.bucket_count() * sizeof(void*)
+        + _codes.size() * (sizeof(std::string) + sizeof(uint32_t) + 2 * sizeof(void*));
+
+    // Строки, не поместившиеся в SSO-буфер, хранятся дважды: в массиве и в ключах индекса
+    for (const auto& value : _values) {
+        if (value.capacity() > std::string().capacity())
+            bytes += 2 * (value.capacity() + 1);
+    }
+    return bytes;
+}
+
+
+
+void DTDictionary::Serialize(std::string& out) const {
+    for (const auto& value : _values) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(value);
+    }
+}
+
+DTDictionary DTDictionary::Deserialize(std::string_view data, size_t size) {
+    DTDictionary dictionary;
+    dictionary._values.reserve(size);
+    dictionary._codes.reserve(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        uint32_t length;
+        if (data.size() < sizeof(length))
+            throw std::runtime_error("Повреждён словарь столбца");
+        std::memcpy(&length, data.data(), sizeof(length));
+        data.remove_prefix(sizeof(length));
+
+        if (data.size() < length)
+            throw std::runtime_error("Повреждён словарь столбца");
+        dictionary.Intern(data.substr(0, length));
+        data.remove_prefix(length);
+    }
+
+    if (dictionary.Size() != size || !data.empty())
+        throw std::runtime_error("Повреждён словарь столбца");
+    return dictionary;
+}
+
+
+
+DTLazyDictionary::DTLazyDictionary(std::shared_ptr<const MappedFile> mapping, std::string_view source, size_t size)
+    : _mapping(std::move(mapping)), _source(source), _size(size) {
+}
+
+size_t DTLazyDictionary::Size() const {
+    return _size;
+}
+
+bool DTLazyDictionary::IsLoaded() const {
+    return _loaded.load(std::memory_order_acquire);
+}
+
+const std::shared_ptr<DTDictionary>& DTLazyDictionary::Get() {
+    // Словарь разбирается при первом обращении; столбцы-копии разделяют один и тот же объект
+    std::call_once(_once, [this]() {
+        _dictionary = std::make_shared<DTDictionary>(DTDictionary::Deserialize(_source, _size));
+        _mapping.reset();
+        _loaded.store(true, std::memory_order_release);
+    });
+    return _dictionary;
+}
+
+
+
+DTColumn::DTColumn()
+    : _dictionary(std::make_shared<DTDictionary>()) {
+}
+
+DTColumn::DTColumn(std::shared_ptr<DTDictionary> dictionary)
+    : _dictionary(std::move(dictionary)) {
+}
+
+DTColumn DTColumn::Map
+(
+    std::shared_ptr<const MappedFile> mapping,
+    const void* codes,
+    size_t rows,
+    bool wide,
+    std::shared_ptr<DTDictionary> dictionary,
+    std::shared_ptr<DTLazyDictionary> lazyDictionary
+) {
+    DTColumn column(std::move(dictionary));
+    column._lazyDictionary = std::move(lazyDictionary);
+    column._mapping = std::move(mapping);
+    column._mappedCodes = codes;
+    column._mappedSize = rows;
+    column._wide = wide;
+
+    // Коды ленивого столбца проверяются при первом обращении к ним, а не при загрузке:
+    // страницы неиспользуемых столбцов так и не читаются
+    if (column._lazyDictionary)
+        column._codesCheck = std::make_shared<DTMappedCodesCheck>();
+    return column;
+}
+
+void DTColumn::CheckMappedCodes() const {
+    // Код за пределами словаря указывал бы мимо массивов счётчиков, поэтому повреждённый
+    // столбец отвергается целиком; при ошибке каждое следующее обращение бросает исключение снова
+    _codesCheck->Run([this]() {
+        const size_t cardinality = Cardinality();
+        auto valid = [&](const auto* codes) {
+            for (size_t row = 0; row < _mappedSize; ++row) {
+                if (codes[row] >= cardinality)
+                    return false;
+            }
+            return true;
+        };
+        if (!(_wide ? valid(static_cast<const uint32_t*>(_mappedCodes)) : valid(static_cast<const uint16_t*>(_mappedCodes))))
+            throw std::runtime_error("Файл набора данных повреждён: неверный код значения в столбце");
+    });
+}
+
+void DTColumn::Materialize() {
+    // Отображённые коды только читаются; перед первым изменением они копируются в память процесса
+    if (_mappedCodes == nullptr)
+        return;
+    if (_codesCheck)
+        CheckMappedCodes();
+
+    if (_wide) {
+        const auto* codes = static_cast<const uint32_t*>(_mappedCodes);
+        _wideCodes.assign(codes, codes + _mappedSize);
+    }
+    else {
+        const auto* codes = static_cast<const uint16_t*>(_mappedCodes);
+        _narrowCodes.assign(codes, codes + _mappedSize);
+    }
+
+    _mappedCodes = nullptr;
+    _mappedSize = 0;
+    _mapping.reset();
+    _codesCheck.reset();
+}
+
+void DTColumn::MaterializeDictionary() {
+    if (_lazyDictionary) {
+        _dictionary = _lazyDictionary->Get();
+        _lazyDictionary.reset();
+    }
+}
+
+void DTColumn::Widen() {
+    _wideCodes.assign(_narrowCodes.begin(), _narrowCodes.end());
+    _narrowCodes.clear();
+    _narrowCodes.shrink_to_fit();
+    _wide = true;
+}
+
+void DTColumn::Reserve(size_t rows) {
+    Materialize();
+    if (_wide)
+        _wideCodes.reserve(rows);
+    else
+        _narrowCodes.reserve(rows);
+}
+
+void DTColumn::Append(std::string_view value) {
+    MaterializeDictionary();
+
+    // Число разбирается до добавления в словарь, чтобы при ошибке словарь не изменился
+    float number = 0.0f;
+    if (_numbers && !DTParseNumber(value, number)) {
+        throw std::invalid_argument("Нечисловое значение \"" + std::string(value) + "\" в числовом столбце");
+    }
+
+    uint32_t code = _dictionary->Intern(value);
+    if (_numbers && code == _numbers->size())
+        _numbers->push_back(number);
+    AppendCode(code);
+}
+
+void DTColumn::AppendCode(uint32_t code) {
+    Materialize();
+
+    // Коды хранятся в 16 битах, пока словарь не перерастёт 65536 значений
+    if (!_wide && code > std::numeric_limits<uint16_t>::max()) {
+        Widen();
+    }
+
+    if (_wide)
+        _wideCodes.push_back(code);
+    else
+        _narrowCodes.push_back(static_cast<uint16_t>(code));
+}
+
+size_t DTColumn::Size() const {
+    if (_mappedCodes != nullptr)
+        return _mappedSize;
+    return _wide ? _wideCodes.size() : _narrowCodes.size();
+}
+
+size_t DTColumn::Cardinality() const {
+    // Размер ленивого словаря известен из файла, сам словарь для этого не разбирается
+    return _lazyDictionary ? _lazyDictionary->Size() : _dictionary->Size();
+}
+
+bool DTColumn::IsWide() const {
+    return _wide;
+}
+
+bool DTColumn::IsNumeric() const {
+    return _numbers != nullptr;
+}
+
+bool DTColumn::IsMapped() const {
+    return _mappedCodes != nullptr;
+}
+
+size_t DTColumn::MemoryUsage() const {
+    return _wideCodes.capacity() * sizeof(uint32_t)
+        + _narrowCodes.capacity() * sizeof(uint16_t)
+        + (_numbers ? _numbers->capacity() * sizeof(float) : 0);
+}
+
+size_t DTColumn::DictionaryMemoryUsage() const {
+    if (_lazyDictionary)
+        return _lazyDictionary->IsLoaded() ? _lazyDictionary->Get()->MemoryUsage() : 0;
+    return _dictionary->MemoryUsage();
+}
+
+const DTDictionary& DTColumn::GetDictionary() const {
+    return *GetSharedDictionary();
+}
+
+const std::shared_ptr<DTDictionary>& DTColumn::GetSharedDictionary() const {
+    return _lazyDictionary ? _lazyDictionary->Get() : _dictionary;
+}
+
+bool DTColumn::MakeNumeric() {
+    // Значения остаются закодированными словарём, число хранится одно на код:
+    // сортировка, подмножества и отображение файла работают со столбцом как раньше
+    const auto& values = GetDictionary().GetValues();
+    auto numbers = std::make_shared<std::vector<float>>(values.size());
+    for (size_t code = 0; code < values.size(); ++code) {
+        if (!DTParseNumber(values[code], (*numbers)[code]))
+            return false;
+    }
+    _numbers = std::move(numbers);
+    return true;
+}
+
+void DTColumn::MakeCategorical() {
+    _numbers.reset();
+}
+
+const std::vector<float>& DTColumn::GetNumbers() const {
+    if (!_numbers)
+        throw std::logic_error("Столбец не является числовым");
+    return *_numbers;
+}
+
+std::vector<bool> DTColumn::GetPresentCodes() const {
+    std::vector<bool> present(Cardinality(), false);
+    VisitCodes([&](const auto* codes) {
+        for (size_t i = 0, n = Size(); i < n; ++i) {
+            present[codes[i]] = true;
+        }
+    });
+    return present;
+}
+
+template <typename Row>
+DTColumn DTColumn::GatherRows(std::span<const Row> rows) const {
+    // Подмножество разделяет словарь с исходным столбцом, копируются только коды
+    DTColumn result(_dictionary);
+    result._lazyDictionary = _lazyDictionary;
+    result._numbers = _numbers;
+    result._wide = _wide;
+
+    VisitCodes([&](const auto* codes) {
+        if (_wide) {
+            result._wideCodes.reserve(rows.size());
+            for (size_t row : rows) result._wideCodes.push_back(codes[row]);
+        }
+        else {
+            result._narrowCodes.reserve(rows.size());
+            for (size_t row : rows) result._narrowCodes.push_back(static_cast<uint16_t>(codes[row]));
+        }
+    });
+
+    return result;
+}
+
+DTColumn DTColumn::Gather(const std::vector<size_t>& rows) const {
+    return GatherRows(std::span<const size_t>(rows));
+}
+
+DTColumn DTColumn::Gather(std::span<const uint32_t> rows) const {
+    return GatherRows(rows);
+}
+
+void DTColumn::Erase(size_t first, size_t last) {
+    Materialize();
+    if (_wide)
+        _wideCodes.erase(_wideCodes.begin() + first, _wideCodes.begin() + last);
+    else
+        _narrowCodes.erase(_narrowCodes.begin() + first, _narrowCodes.begin() + last);
+}
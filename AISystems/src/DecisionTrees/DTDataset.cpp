@@ -1,40 +1,106 @@
 #include <../include/DecisionTrees/DTDataset.h>
+#include <../include/DecisionTrees/DTCsvScanner.h>
+#include <../include/Utils/MappedFile.h>
+
+#include <cstring>
+
+namespace {
+    struct CsvChunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        std::vector<DTColumn> columns;
+        size_t lines = 0;
+        size_t rows = 0;
+        size_t errorLine = 0;
+        size_t errorTokens = 0;
+        size_t errorColumn = 0;
+    };
+
+    void ParseChunk(CsvChunk& chunk, size_t numColumns, char delimiter) {
+        chunk.columns.resize(numColumns);
+
+        DTCsvScanner scanner(chunk.begin, chunk.end, delimiter);
+        std::vector<std::string_view> tokens;
+        while (scanner.NextLine(tokens)) {
+            ++chunk.lines;
+            if (tokens.empty())
+                continue;
+
+            // Фрагмент останавливается на первой ошибке; номер строки пересчитывается после разбора
+            if (tokens.size() != numColumns) {
+                chunk.errorLine = chunk.lines;
+                chunk.errorTokens = tokens.size();
+                return;
+            }
+            for (size_t i = 0; i < numColumns; ++i) {
+                if (tokens[i].empty()) {
+                    chunk.errorLine = chunk.lines;
+                    chunk.errorTokens = numColumns;
+                    chunk.errorColumn = i;
+                    return;
+                }
+            }
 
-std::vector<std::string> DTDataset::Split(const std::string& line, char delimiter) {
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream(line);
-    while (std::getline(tokenStream, token, delimiter)) {
-        if (!token.empty() && token.front() == '\"') {
-            token = std::string(token.begin() + 1, token.end());
-        }
-        if (!token.empty() && token.back() == '\"') {
-            token = std::string(token.begin(), token.end() - 1);
+            for (size_t i = 0; i < numColumns; ++i) {
+                chunk.columns[i].Append(tokens[i]);
+            }
+            ++chunk.rows;
         }
-        tokens.push_back(token);
     }
-    return tokens;
-}
 
-void DTDataset::ValidateRow(const std::vector<std::string>& row, size_t lineIndex) const {
-    if (row.size() != _numColumns) {
-        std::stringstream ss;
-        ss << "   " << lineIndex
-            << ":  " << _numColumns
-            << " ,  " << row.size();
-        throw std::invalid_argument(ss.str());
+    constexpr char DatasetMagic[8] = { 'D', 'T', 'D', 'A', 'T', 'A', '\0', '\0' };
+    constexpr uint32_t DatasetFormatVersion = 2;
+    constexpr uint32_t ColumnWide = 1;
+    constexpr uint32_t ColumnNumeric = 2;
+    constexpr uint32_t ByteOrderMark = 0x01020304;
+    constexpr uint64_t SectionAlignment = 16;
+
+    // Двоичный формат набора: заголовок, таблица столбцов, заголовки столбцов,
+    // затем для каждого столбца словарь и массив кодов в том же виде, что и в памяти
+    struct DatasetFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t numRows;
+        uint64_t numColumns;
+        uint64_t targetColumn;
+        uint64_t headerLoaded;
+        uint64_t columnsOffset;
+        uint64_t headersOffset;
+        uint64_t headersSize;
+    };
+
+    struct DatasetColumnEntry {
+        uint64_t dictionaryOffset;
+        uint64_t dictionarySize;
+        uint64_t codesOffset;
+        uint32_t cardinality;
+        uint32_t flags;
+    };
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
     }
 
-    for (size_t i = 0; i < row.size(); ++i) {
-        if (row[i].empty()) {
-            std::stringstream ss;
-            ss << "    " << lineIndex
-                << ",  " << (_headerLoaded ? _headers[i] : std::to_string(i));
-            throw std::invalid_argument(ss.str());
-        }
+    [[noreturn]] void ThrowCorruptedDataset(const std::string& reason) {
+        throw std::runtime_error("Файл набора данных повреждён: " + reason);
     }
 }
 
+void DTDataset::ThrowRowError(size_t lineIndex, size_t tokenCount, size_t emptyColumn) const {
+    std::stringstream ss;
+    if (tokenCount != _numColumns) {
+        ss << "Ошибка в строке " << lineIndex
+            << ": ожидалось " << _numColumns
+            << " столбцов, получено " << tokenCount;
+    }
+    else {
+        ss << "Пустое значение в строке " << lineIndex
+            << ", столбец " << (_headerLoaded ? _headers[emptyColumn] : std::to_string(emptyColumn));
+    }
+    throw std::invalid_argument(ss.str());
+}
+
 std::vector<size_t> DTDataset::CalculateColumnWidths() const {
     std::vector<size_t> widths(_numColumns, 0);
 
@@ -44,9 +110,13 @@ std::vector<size_t> DTDataset::CalculateColumnWidths() const {
         }
     }
 
-    for (const auto& row : _data) {
-        for (size_t i = 0; i < _numColumns; ++i) {
-            widths[i] = std::max(widths[i], row[i].size());
+    // Ширина считается по словарю: каждое встречающееся значение проверяется один раз
+    for (size_t i = 0; i < _numColumns; ++i) {
+        const auto& values = _columns[i].GetDictionary().GetValues();
+        auto present = _columns[i].GetPresentCodes();
+        for (size_t code = 0; code < values.size(); ++code) {
+            if (present[code])
+                widths[i] = std::max(widths[i], values[code].size());
         }
     }
 
@@ -55,70 +125,439 @@ std::vector<size_t> DTDataset::CalculateColumnWidths() const {
     return widths;
 }
 
+void DTDataset::CheckColumnIndex(size_t columnIndex) const {
+    if (columnIndex >= _numColumns) {
+        std::stringstream ss;
+        ss << "Некорректный индекс столбца: " << columnIndex
+            << " (допустимо 0-" << (_numColumns - 1) << ")";
+        throw std::out_of_range(ss.str());
+    }
+}
+
+DTDataset DTDataset::GatherRows(const std::vector<size_t>& rows, size_t skipColumn) const {
+    DTDataset subset;
+    subset._numRows = rows.size();
+    subset._headerLoaded = _headerLoaded;
+    subset._columns.reserve(_numColumns);
+
+    for (size_t i = 0; i < _numColumns; ++i) {
+        if (i == skipColumn)
+            continue;
+        subset._columns.push_back(_columns[i].Gather(rows));
+        if (_headerLoaded)
+            subset._headers.push_back(_headers[i]);
+    }
+    subset._numColumns = subset._columns.size();
+
+    subset._targetColumn = _targetColumn;
+    if (skipColumn < _numColumns) {
+        if (skipColumn == _targetColumn)
+            subset._targetColumn = 0;
+        else if (_targetColumn > skipColumn)
+            subset._targetColumn = _targetColumn - 1;
+    }
+
+    return subset;
+}
+
+const DTDataset::TargetStats& DTDataset::GetTargetStats() const {
+    // Распределение классов считается при первом обращении и хранится до изменения набора.
+    // Копии набора делят его, пока не изменятся: изменение заменяет его новым, не трогая чужие
+    std::call_once(_targetStats->once, [this]() {
+        TargetStats& stats = *_targetStats;
+        if (_targetColumn >= _columns.size())
+            return;
+
+        const DTColumn& target = _columns[_targetColumn];
+        stats.classCounts.assign(target.Cardinality(), 0);
+        target.VisitCodes([&](const auto* codes) {
+            for (size_t i = 0; i < _numRows; ++i) {
+                stats.classCounts[codes[i]]++;
+            }
+        });
+
+        if (_numRows == 0)
+            return;
+        for (size_t count : stats.classCounts) {
+            double p = static_cast<double>(count) / _numRows;
+            if (p > 0) stats.entropy -= p * log2(p);
+        }
+    });
+    return *_targetStats;
+}
+
+void DTDataset::ResetTargetStats() {
+    _targetStats = std::make_shared<TargetStats>();
+}
+
 
 
 void DTDataset::LoadFromFile(const std::string& filename, char delimiter = ',', bool hasHeader = true) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("  : " + filename);
+    LoadOptions options;
+    options.delimiter = delimiter;
+    options.hasHeader = hasHeader;
+    LoadFromFile(filename, options);
+}
+
+void DTDataset::LoadFromFile(const std::string& filename, const LoadOptions& options) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        throw std::runtime_error("Файл не найден: " + filename);
     }
 
-    _data.clear();
+    _columns.clear();
     _headers.clear();
+    _featureBins.reset();
+    _numRows = 0;
     _numColumns = 0;
     _headerLoaded = false;
 
-    std::string line;
-    size_t lineNumber = 0;
+    const char* data = file.Data();
+    const char* end = data + file.Size();
+    std::vector<std::string_view> tokens;
+    size_t headerLines = 0;
 
-    if (hasHeader) {
-        if (!std::getline(file, line)) {
-            throw std::runtime_error(" ,   ");
+    DTCsvScanner scanner(data, end, options.delimiter);
+    if (options.hasHeader) {
+        if (!scanner.NextLine(tokens)) {
+            throw std::runtime_error("Файл пуст, но ожидался заголовок");
         }
-        lineNumber++;
-        _headers = Split(line, delimiter);
+        headerLines = 1;
+        _headers.assign(tokens.begin(), tokens.end());
         _numColumns = _headers.size();
         _headerLoaded = true;
 
         if (_headers.empty()) {
-            throw std::invalid_argument("   ");
+            throw std::invalid_argument("Заголовок не содержит данных");
         }
     }
 
-    while (std::getline(file, line)) {
-        lineNumber++;
-        if (line.empty()) continue;
+    // Без заголовка число столбцов берётся из первой непустой строки, которую затем разберёт первый фрагмент
+    const char* dataStart = scanner.Position();
+    if (_numColumns == 0) {
+        DTCsvScanner probe(dataStart, end, options.delimiter);
+        while (probe.NextLine(tokens) && tokens.empty()) {
+        }
+        if (tokens.empty()) {
+            throw std::runtime_error("Файл не содержит данных");
+        }
+        _numColumns = tokens.size();
+    }
+
+    const size_t dataBytes = static_cast<size_t>(end - dataStart);
+    const size_t chunkBytes = std::max<size_t>(options.chunkBytes, 1);
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool, dataBytes > chunkBytes);
+
+    // Файл режется на фрагменты по границам строк; в последовательном режиме фрагмент один
+    size_t numChunks = pool == nullptr ? 1 : (dataBytes + chunkBytes - 1) / chunkBytes;
+    std::vector<CsvChunk> chunks;
+    const char* chunkStart = dataStart;
+    for (size_t i = 1; i <= numChunks && chunkStart < end; ++i) {
+        const char* chunkEnd = i == numChunks ? end : std::max(chunkStart, dataStart + dataBytes / numChunks * i);
+        if (chunkEnd < end) {
+            const void* newline = std::memchr(chunkEnd, '\n', static_cast<size_t>(end - chunkEnd));
+            chunkEnd = newline == nullptr ? end : static_cast<const char*>(newline) + 1;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = chunkStart;
+        chunks.back().end = chunkEnd;
+        chunkStart = chunkEnd;
+    }
 
-        auto row = Split(line, delimiter);
+    // Первый фрагмент интернирует значения прямо в словари столбцов набора,
+    // остальные - в собственные словари, которые потом сливаются по порядку
+    _columns.resize(_numColumns);
+    if (chunks.empty()) {
+        chunks.emplace_back();
+    }
+    chunks.front().columns = std::move(_columns);
+    if (pool != nullptr && chunks.size() > 1) {
+        pool->ParallelFor(chunks.size(), [&](size_t i) {
+            ParseChunk(chunks[i], _numColumns, options.delimiter);
+        });
+    }
+    else {
+        for (auto& chunk : chunks) {
+            ParseChunk(chunk, _numColumns, options.delimiter);
+        }
+    }
+    _columns = std::move(chunks.front().columns);
 
-        if (_numColumns == 0) {
-            _numColumns = row.size();
-            if (_numColumns == 0) {
-                throw std::invalid_argument("   ");
+    // Ошибка из самого раннего фрагмента соответствует первой ошибке последовательного чтения
+    size_t lineOffset = headerLines;
+    for (const auto& chunk : chunks) {
+        if (chunk.errorLine != 0) {
+            ThrowRowError(lineOffset + chunk.errorLine, chunk.errorTokens, chunk.errorColumn);
+        }
+        lineOffset += chunk.lines;
+        _numRows += chunk.rows;
+    }
+
+    if (_numRows == 0) {
+        throw std::runtime_error("Файл не содержит данных");
+    }
+
+    // Словари фрагментов сливаются в порядке файла, поэтому коды совпадают с последовательной загрузкой
+    auto mergeColumn = [&](size_t col) {
+        DTColumn& column = _columns[col];
+        DTDictionary& dictionary = *column.GetSharedDictionary();
+        column.Reserve(_numRows);
+
+        std::vector<uint32_t> remap;
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            const DTColumn& part = chunks[i].columns[col];
+            const auto& values = part.GetDictionary().GetValues();
+            remap.resize(values.size());
+            for (size_t code = 0; code < values.size(); ++code) {
+                remap[code] = dictionary.Intern(values[code]);
             }
+
+            part.VisitCodes([&](const auto* codes) {
+                for (size_t row = 0; row < chunks[i].rows; ++row) {
+                    column.AppendCode(remap[codes[row]]);
+                }
+            });
         }
+    };
 
-        ValidateRow(row, lineNumber);
-        _data.push_back(row);
+    if (pool != nullptr && chunks.size() > 1) {
+        pool->ParallelFor(_numColumns, mergeColumn);
+    }
+    else if (chunks.size() > 1) {
+        for (size_t col = 0; col < _numColumns; ++col) {
+            mergeColumn(col);
+        }
     }
 
-    if (_data.empty()) {
-        throw std::runtime_error("   ");
+    _targetColumn = _numColumns - 1;
+    ResetTargetStats();
+
+    if (options.detectNumeric)
+        DetectNumericColumns();
+
+    // Корзины для обучения по гистограммам строятся один раз, после определения типов столбцов
+    if (options.featureBins != 0)
+        BuildFeatureBins(options.featureBins, pool);
+}
+
+void DTDataset::SaveToBinaryFile(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
     }
 
-    _targetColumn = _data[0].size() - 1;
+    std::string headers;
+    for (const auto& header : _headers) {
+        uint32_t length = static_cast<uint32_t>(header.size());
+        headers.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        headers.append(header);
+    }
+
+    DatasetFileHeader header{};
+    std::memcpy(header.magic, DatasetMagic, sizeof(DatasetMagic));
+    header.version = DatasetFormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.numRows = _numRows;
+    header.numColumns = _numColumns;
+    header.targetColumn = _targetColumn;
+    header.headerLoaded = _headerLoaded ? 1 : 0;
+    header.columnsOffset = AlignUp(sizeof(header));
+    header.headersOffset = AlignUp(header.columnsOffset + _numColumns * sizeof(DatasetColumnEntry));
+    header.headersSize = headers.size();
+
+    // Смещения всех секций вычисляются заранее, затем файл пишется одним проходом
+    std::vector<std::string> dictionaries(_numColumns);
+    std::vector<DatasetColumnEntry> entries(_numColumns);
+    uint64_t offset = AlignUp(header.headersOffset + header.headersSize);
+    for (size_t col = 0; col < _numColumns; ++col) {
+        const DTColumn& column = _columns[col];
+        column.GetDictionary().Serialize(dictionaries[col]);
+
+        DatasetColumnEntry& entry = entries[col];
+        entry.cardinality = static_cast<uint32_t>(column.Cardinality());
+        entry.flags = (column.IsWide() ? ColumnWide : 0) | (column.IsNumeric() ? ColumnNumeric : 0);
+        entry.dictionaryOffset = offset;
+        entry.dictionarySize = dictionaries[col].size();
+        entry.codesOffset = AlignUp(entry.dictionaryOffset + entry.dictionarySize);
+        offset = AlignUp(entry.codesOffset + _numRows * (column.IsWide() ? sizeof(uint32_t) : sizeof(uint16_t)));
+    }
+
+    uint64_t position = 0;
+    auto writeAt = [&](uint64_t at, const void* data, size_t size) {
+        static const char zeros[SectionAlignment] = {};
+        file.write(zeros, static_cast<std::streamsize>(at - position));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position = at + size;
+    };
+
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.columnsOffset, entries.data(), entries.size() * sizeof(DatasetColumnEntry));
+    writeAt(header.headersOffset, headers.data(), headers.size());
+    for (size_t col = 0; col < _numColumns; ++col) {
+        writeAt(entries[col].dictionaryOffset, dictionaries[col].data(), dictionaries[col].size());
+        _columns[col].VisitCodes([&](const auto* codes) {
+            writeAt(entries[col].codesOffset, codes, _numRows * sizeof(*codes));
+        });
+    }
+
+    if (!file) {
+        throw std::runtime_error("Ошибка записи файла: " + filename);
+    }
+}
+
+void DTDataset::LoadFromBinaryFile(const std::string& filename, bool lazyColumns) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(filename)) {
+        throw std::runtime_error("Файл не найден: " + filename);
+    }
+
+    const char* data = file->Data();
+    const size_t size = file->Size();
+
+    DatasetFileHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Файл не является набором данных: " + filename);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, DatasetMagic, sizeof(DatasetMagic)) != 0) {
+        throw std::runtime_error("Файл не является набором данных: " + filename);
+    }
+    if (header.byteOrder != ByteOrderMark) {
+        throw std::runtime_error("Набор данных сохранён на платформе с другим порядком байтов");
+    }
+    // Версия 1 отличается только отсутствием признака числового столбца
+    if (header.version != DatasetFormatVersion && header.version != 1) {
+        std::stringstream ss;
+        ss << "Неподдерживаемая версия файла набора данных: " << header.version
+            << " (ожидалась " << DatasetFormatVersion << ")";
+        throw std::runtime_error(ss.str());
+    }
+
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!fits(header.columnsOffset, header.numColumns, sizeof(DatasetColumnEntry))
+        || !fits(header.headersOffset, header.headersSize, 1)) {
+        ThrowCorruptedDataset("секции выходят за пределы файла");
+    }
+    if (header.numColumns == 0 || header.targetColumn >= header.numColumns) {
+        ThrowCorruptedDataset("неверное описание столбцов");
+    }
+
+    std::vector<std::string> headers;
+    std::string_view headerData(data + header.headersOffset, header.headersSize);
+    while (!headerData.empty()) {
+        uint32_t length;
+        if (headerData.size() < sizeof(length))
+            ThrowCorruptedDataset("неверные заголовки столбцов");
+        std::memcpy(&length, headerData.data(), sizeof(length));
+        headerData.remove_prefix(sizeof(length));
+        if (headerData.size() < length)
+            ThrowCorruptedDataset("неверные заголовки столбцов");
+        headers.emplace_back(headerData.substr(0, length));
+        headerData.remove_prefix(length);
+    }
+    if (header.headerLoaded != 0 && headers.size() != header.numColumns) {
+        ThrowCorruptedDataset("неверные заголовки столбцов");
+    }
+
+    // Коды используются прямо из отображения. В ленивом режиме словарь столбца
+    // разбирается только при первом обращении, а его страницы до этого не читаются
+    std::vector<DTColumn> columns;
+    columns.reserve(header.numColumns);
+    for (size_t col = 0; col < header.numColumns; ++col) {
+        DatasetColumnEntry entry;
+        std::memcpy(&entry, data + header.columnsOffset + col * sizeof(entry), sizeof(entry));
+
+        const bool wide = (entry.flags & ColumnWide) != 0;
+        const size_t width = wide ? sizeof(uint32_t) : sizeof(uint16_t);
+        if (!fits(entry.dictionaryOffset, entry.dictionarySize, 1)
+            || !fits(entry.codesOffset, header.numRows, width)
+            || entry.codesOffset % width != 0) {
+            ThrowCorruptedDataset("столбец " + std::to_string(col) + " выходит за пределы файла");
+        }
+
+        std::string_view dictionary(data + entry.dictionaryOffset, entry.dictionarySize);
+        const void* codes = data + entry.codesOffset;
+        if (lazyColumns) {
+            auto lazy = std::make_shared<DTLazyDictionary>(file, dictionary, entry.cardinality);
+            columns.push_back(DTColumn::Map(file, codes, header.numRows, wide, nullptr, std::move(lazy)));
+        }
+        else {
+            // Без ленивого режима столбец подгружается сразу, и его коды проверяются на корректность
+            file->Prefetch(entry.codesOffset, header.numRows * width);
+            auto values = std::make_shared<DTDictionary>(DTDictionary::Deserialize(dictionary, entry.cardinality));
+            columns.push_back(DTColumn::Map(file, codes, header.numRows, wide, std::move(values), nullptr));
+
+            bool valid = columns.back().VisitCodes([&](const auto* values) {
+                for (size_t row = 0; row < header.numRows; ++row) {
+                    if (values[row] >= entry.cardinality)
+                        return false;
+                }
+                return true;
+            });
+            if (!valid) {
+                ThrowCorruptedDataset("неверный код значения в столбце " + std::to_string(col));
+            }
+        }
+
+        // Числам нужен словарь, поэтому числовой столбец разбирается и в ленивом режиме
+        if (header.version >= 2 && (entry.flags & ColumnNumeric) != 0 && !columns.back().MakeNumeric()) {
+            ThrowCorruptedDataset("нечисловое значение в числовом столбце " + std::to_string(col));
+        }
+    }
+
+    _columns = std::move(columns);
+    _headers = std::move(headers);
+    _featureBins.reset();
+    _numRows = header.numRows;
+    _numColumns = header.numColumns;
+    _headerLoaded = header.headerLoaded != 0;
+    _targetColumn = header.targetColumn;
+    ResetTargetStats();
 }
 
 const std::vector<std::string>& DTDataset::GetHeaders() const {
     return _headers;
 }
 
-const std::vector<std::vector<std::string>>& DTDataset::GetData() const {
-    return _data;
+std::vector<std::vector<std::string>> DTDataset::GetData() const {
+    std::vector<std::vector<std::string>> data;
+    data.reserve(_numRows);
+    for (size_t i = 0; i < _numRows; ++i) {
+        data.push_back(GetRow(i));
+    }
+    return data;
+}
+
+std::vector<std::string> DTDataset::GetRow(size_t rowIndex) const {
+    if (rowIndex >= _numRows) {
+        std::stringstream ss;
+        ss << "Индекс строки " << rowIndex << " выходит за пределы [0, " << (_numRows - 1) << "]";
+        throw std::out_of_range(ss.str());
+    }
+
+    std::vector<std::string> row;
+    row.reserve(_numColumns);
+    for (size_t col = 0; col < _columns.size(); ++col) {
+        row.push_back(GetColumn(col).GetValue(rowIndex));
+    }
+    return row;
+}
+
+const std::string& DTDataset::GetValue(size_t rowIndex, size_t columnIndex) const {
+    return GetColumn(columnIndex).GetValue(rowIndex);
+}
+
+const DTColumn& DTDataset::GetColumn(size_t columnIndex) const {
+    CheckColumnIndex(columnIndex);
+    _columns[columnIndex].CheckCodes();
+    return _columns[columnIndex];
 }
 
 size_t DTDataset::RowCount() const {
-    return _data.size();
+    return _numRows;
 }
 
 size_t DTDataset::ColumnCount() const {
@@ -127,13 +566,13 @@ size_t DTDataset::ColumnCount() const {
 
 size_t DTDataset::GetColumnIndex(const std::string& columnName) const {
     if (!_headerLoaded) {
-        throw std::logic_error("  ");
+        throw std::logic_error("Заголовки не загружены");
     }
 
     auto it = std::find(_headers.begin(), _headers.end(), columnName);
     if (it == _headers.end()) {
         std::stringstream ss;
-        ss << " '" << columnName << "'  .  : ";
+        ss << "Столбец '" << columnName << "' не найден. Доступные столбцы: ";
         for (size_t i = 0; i < _headers.size(); ++i) {
             ss << "\n  " << i << ") " << _headers[i];
         }
@@ -144,12 +583,7 @@ size_t DTDataset::GetColumnIndex(const std::string& columnName) const {
 }
 
 std::string DTDataset::GetColumnHeader(size_t columnIndex) const {
-    if (columnIndex >= _numColumns) {
-        std::stringstream ss;
-        ss << "  : " << columnIndex
-            << " ( 0-" << (_numColumns - 1) << ")";
-        throw std::out_of_range(ss.str());
-    }
+    CheckColumnIndex(columnIndex);
 
     if (!_headerLoaded)
         return "Column " + columnIndex;
@@ -157,15 +591,25 @@ std::string DTDataset::GetColumnHeader(size_t columnIndex) const {
     return _headers[columnIndex];
 }
 
+size_t DTDataset::MemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& column : _columns) {
+        bytes += column.MemoryUsage() + column.DictionaryMemoryUsage();
+    }
+    if (_featureBins)
+        bytes += _featureBins->MemoryUsage();
+    return bytes;
+}
+
 
 void DTDataset::PrintSummary(size_t previewRows = 5) const {
-    std::cout << "    : "
-        << "\n\t: " << _numColumns
-        << "\n\t: " << _data.size() << "\n";
+    std::cout << "Общая информация о наборе данных: "
+        << "\n\tСтолбцов: " << _numColumns
+        << "\n\tСтрок: " << _numRows << "\n";
 
     if (_headerLoaded) {
         size_t count = 0;
-        std::cout << "\n: ";
+        std::cout << "\nЗаголовки: ";
         for (const auto& h : _headers) {
             std::cout << '\"' << h << '\"';
             if (++count < _headers.size())
@@ -184,54 +628,49 @@ void DTDataset::PrintSummary(size_t previewRows = 5) const {
 
 void DTDataset::PrintDataSlice(size_t previewRows = 5) const {
     const size_t rowsToShow = previewRows != 0 ?
-        std::min(previewRows, _data.size()) :
-        _data.size();
+        std::min(previewRows, _numRows) :
+        _numRows;
 
     if (rowsToShow == 0) {
-        std::cout << "   \n";
+        std::cout << "Нет данных для отображения\n";
         return;
     }
 
-    std::cout << "\n ( " << rowsToShow << " ): \n";
+    std::cout << "\nДанные (первые " << rowsToShow << " строк): \n";
 
     auto widths = CalculateColumnWidths();
 
-    // 
+    // Заголовки
     if (_headerLoaded) {
         for (size_t i = 0; i < _numColumns; ++i) {
             std::cout << std::left << std::setw(widths[i]) << _headers[i] << " |";
         }
         std::cout << "\n";
 
-        //  
+        // Разделительная линия
         for (size_t i = 0; i < _numColumns; ++i) {
             std::cout << std::string(widths[i], '-') << "-+";
         }
         std::cout << "\n";
     }
 
-    // 
+    // Данные
     for (size_t i = 0; i < rowsToShow; ++i) {
         for (size_t j = 0; j < _numColumns; ++j) {
-            std::cout << std::left << std::setw(widths[j]) << _data[i][j] << " |";
+            std::cout << std::left << std::setw(widths[j]) << GetColumn(j).GetValue(i) << " |";
         }
         std::cout << "\n";
     }
 }
 
 void DTDataset::PrintColumnStats(size_t columnIndex) const {
-    if (columnIndex >= _numColumns) {
-        std::stringstream ss;
-        ss << "  : " << columnIndex
-            << " ( 0-" << (_numColumns - 1) << ")";
-        throw std::out_of_range(ss.str());
-    }
+    CheckColumnIndex(columnIndex);
 
     auto unique = GetUniqueValues(columnIndex);
-    std::cout << "   "
+    std::cout << "Статистика для столбца "
         << (_headerLoaded ? _headers[columnIndex] : std::to_string(columnIndex)) << ": \n"
-        << "\t : " << unique.size() << "\n"
-        << "\t: ";
+        << "\tУникальных значений: " << unique.size() << "\n"
+        << "\tЗначения: ";
 
     size_t count = 0;
     for (const auto& val : unique) {
@@ -249,12 +688,12 @@ void DTDataset::PrintColumnStats(const std::string& columnName) const {
 }
 
 void DTDataset::PrintDataStats() const {
-    if (_numColumns == 0 || _data.empty()) {
-        std::cout << "    \n";
+    if (_numColumns == 0 || _numRows == 0) {
+        std::cout << "Нет данных для отображения статистики\n";
         return;
     }
 
-    //      
+    // Рассчитываем ширину для колонки с названиями
     size_t nameWidth = 0;
     if (_headerLoaded) {
         for (const auto& h : _headers) {
@@ -266,20 +705,20 @@ void DTDataset::PrintDataStats() const {
     }
     nameWidth += 5;
 
-    // 
-    std::cout << "   : \n";
+    // Шапка
+    std::cout << "Статистика данных по столбцам: \n";
     std::cout << std::string(nameWidth, '-') << "-|----------------------------------------\n";
-    std::cout << std::left << std::setw(nameWidth) << " "
-        << " |  \n";
+    std::cout << std::left << std::setw(nameWidth) << "Название столбца"
+        << " | Уникальные значения\n";
     std::cout << std::string(nameWidth, '-') << "-+----------------------------------------\n";
 
-    //   
+    // Для каждого столбца
     for (size_t i = 0; i < _numColumns; ++i) {
-        //  
+        // Название столбца
         std::string colName = _headerLoaded ? _headers[i] : ("Column " + std::to_string(i));
         std::cout << std::left << std::setw(nameWidth) << colName << " | ";
 
-        //  
+        // Уникальные значения
         auto unique = GetUniqueValues(i);
         std::cout << unique.size() << ": ";
         size_t count = 0;
@@ -299,54 +738,119 @@ void DTDataset::PrintDataStats() const {
 
 
 
-void DTDataset::SortByColumn
-(
-    size_t columnIndex,
-    const std::function<bool(const std::string&, const std::string&)>& comparator = nullptr
-)
-{
-    if (columnIndex >= _numColumns) {
-        std::stringstream ss;
-        ss << "  " << columnIndex << "    [0, "
-            << (_numColumns - 1) << "]";
-        throw std::out_of_range(ss.str());
+DTDataset::RankedKey DTDataset::RankColumn(const SortKey& key) const {
+    CheckColumnIndex(key.column);
+
+    // Числовые столбцы упорядочиваются по числу, остальные - по строке значения
+    const DTColumn& column = _columns[key.column];
+    if (column.IsNumeric()) {
+        const auto& numbers = column.GetNumbers();
+        return RankCodes(key.column, numbers.size(), key.descending, [&numbers](uint32_t a, uint32_t b) {
+            return numbers[a] < numbers[b];
+        });
     }
 
-    auto default_comparator = [](const std::string& a, const std::string& b) {
-        return a < b;
-        };
+    const auto& values = column.GetDictionary().GetValues();
+    return RankCodes(key.column, values.size(), key.descending, [&values](uint32_t a, uint32_t b) {
+        return values[a] < values[b];
+    });
+}
 
-    auto& comp = comparator ? comparator : default_comparator;
+std::vector<uint32_t> DTDataset::OrderRows(const std::vector<RankedKey>& keys) const {
+    if (_numRows > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Слишком много строк для сортировки набора данных");
+    }
 
-    std::sort(_data.begin(), _data.end(),
-        [columnIndex, &comp](const std::vector<std::string>& a,
-            const std::vector<std::string>& b) {
-                return comp(a[columnIndex], b[columnIndex]);
+    std::vector<uint32_t> order(_numRows);
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<uint32_t> scratch(_numRows);
+
+    // Поразрядная сортировка (LSD) по рангам: устойчивые проходы подсчётом от последнего
+    // ключа к первому. Строки с равными ключами сохраняют исходный порядок
+    for (auto key = keys.rbegin(); key != keys.rend(); ++key) {
+        const auto& rankOfCode = key->rankOfCode;
+        std::vector<size_t> offsets(key->rankCount + 1, 0);
+        _columns[key->column].VisitCodes([&](const auto* codes) {
+            for (size_t row = 0; row < _numRows; ++row) {
+                offsets[rankOfCode[codes[row]] + 1]++;
+            }
+            for (size_t r = 1; r < offsets.size(); ++r) {
+                offsets[r] += offsets[r - 1];
+            }
+            for (uint32_t row : order) {
+                scratch[offsets[rankOfCode[codes[row]]]++] = row;
+            }
         });
+        order.swap(scratch);
+    }
+    return order;
+}
+
+std::vector<uint32_t> DTDataset::GetSortOrder(const std::vector<SortKey>& keys) const {
+    // Перестановка строк без перемещения данных: её можно применить к набору
+    // или передать в DTDatasetView, чтобы обойти строки в нужном порядке без копирования
+    std::vector<RankedKey> ranked;
+    ranked.reserve(keys.size());
+    for (const SortKey& key : keys) {
+        ranked.push_back(RankColumn(key));
+    }
+    return OrderRows(ranked);
+}
+
+void DTDataset::ApplyOrder(const std::vector<uint32_t>& order, WorkStealingPool* pool) {
+    if (order.size() != _numRows) {
+        throw std::invalid_argument("Размер перестановки не совпадает с числом строк набора данных");
+    }
+    std::vector<bool> seen(_numRows, false);
+    for (uint32_t row : order) {
+        if (row >= _numRows || seen[row])
+            throw std::invalid_argument("Порядок строк не является перестановкой строк набора данных");
+        seen[row] = true;
+    }
+
+    // Столбцы переставляются независимо друг от друга; распределение классов
+    // от перестановки не меняется, а корзины гистограмм хранят строки и сбрасываются
+    std::vector<DTColumn> columns(_numColumns);
+    auto gather = [&](size_t col) {
+        columns[col] = _columns[col].Gather(std::span<const uint32_t>(order));
+    };
+    if (pool != nullptr && _numColumns > 1) {
+        pool->ParallelFor(_numColumns, gather);
+    }
+    else {
+        for (size_t col = 0; col < _numColumns; ++col) {
+            gather(col);
+        }
+    }
+    _columns = std::move(columns);
+    _featureBins.reset();
 }
 
-void DTDataset::SortByColumn
-(
-    const std::string& columnName,
-    const std::function<bool(const std::string&, const std::string&)>& comparator = nullptr
-)
-{
-    SortByColumn(GetColumnIndex(columnName), comparator);
+void DTDataset::SortByColumns(const std::vector<SortKey>& keys, WorkStealingPool* pool) {
+    ApplyOrder(GetSortOrder(keys), pool);
+}
+
+void DTDataset::SortByColumn(size_t columnIndex) {
+    SortByColumns({ { columnIndex, false } });
+}
+
+void DTDataset::SortByColumn(const std::string& columnName) {
+    SortByColumn(GetColumnIndex(columnName));
 }
 
 
 
 std::unordered_set<std::string> DTDataset::GetUniqueValues(size_t columnIndex) const {
-    if (columnIndex >= _numColumns) {
-        std::stringstream ss;
-        ss << "  : " << columnIndex
-            << " ( 0-" << (_numColumns - 1) << ")";
-        throw std::out_of_range(ss.str());
-    }
+    CheckColumnIndex(columnIndex);
+
+    const DTColumn& column = _columns[columnIndex];
+    const auto& values = column.GetDictionary().GetValues();
+    auto present = column.GetPresentCodes();
 
     std::unordered_set<std::string> unique;
-    for (const auto& row : _data) {
-        unique.insert(row[columnIndex]);
+    for (size_t code = 0; code < values.size(); ++code) {
+        if (present[code])
+            unique.insert(values[code]);
     }
     return unique;
 }
@@ -357,16 +861,64 @@ std::unordered_set<std::string> DTDataset::GetUniqueValues(const std::string& co
 
 
 
+void DTDataset::SetNumericColumn(size_t columnIndex) {
+    CheckColumnIndex(columnIndex);
+    if (!_columns[columnIndex].MakeNumeric()) {
+        throw std::invalid_argument("Столбец \"" + GetColumnHeader(columnIndex) + "\" содержит нечисловые значения");
+    }
+    _featureBins.reset();
+    ResetTargetStats();
+}
+
+void DTDataset::SetNumericColumn(const std::string& columnName) {
+    SetNumericColumn(GetColumnIndex(columnName));
+}
+
+void DTDataset::SetCategoricalColumn(size_t columnIndex) {
+    CheckColumnIndex(columnIndex);
+    _columns[columnIndex].MakeCategorical();
+    _featureBins.reset();
+    ResetTargetStats();
+}
+
+bool DTDataset::IsNumericColumn(size_t columnIndex) const {
+    CheckColumnIndex(columnIndex);
+    return _columns[columnIndex].IsNumeric();
+}
+
+size_t DTDataset::DetectNumericColumns() {
+    // Числовыми считаются нецелевые столбцы, все значения которых разбираются как числа
+    size_t detected = 0;
+    for (size_t col = 0; col < _numColumns; ++col) {
+        if (col != _targetColumn && (_columns[col].IsNumeric() || _columns[col].MakeNumeric()))
+            detected++;
+    }
+    _featureBins.reset();
+    return detected;
+}
+
+void DTDataset::BuildFeatureBins(size_t maxBins, WorkStealingPool* pool) {
+    _featureBins = std::make_shared<const DTFeatureBins>(DTFeatureBins::Build(*this, maxBins, pool));
+}
+
+void DTDataset::ClearFeatureBins() {
+    _featureBins.reset();
+}
+
+const DTFeatureBins* DTDataset::GetFeatureBins() const {
+    return _featureBins.get();
+}
+
 void DTDataset::SetTargetColumn(const std::string& columnName) {
-    _targetColumn = GetColumnIndex(columnName);
+    SetTargetColumn(GetColumnIndex(columnName));
 }
 
 void DTDataset::SetTargetColumn(size_t columnIndex) {
     if (columnIndex >= _numColumns)
-        throw std::out_of_range("   ");
+        throw std::out_of_range("Некорректный индекс целевого столбца");
 
     _targetColumn = columnIndex;
-    _targetEntropy = CalculateEntropy();
+    ResetTargetStats();
 }
 
 size_t DTDataset::GetTargetColumn() const {
@@ -382,25 +934,57 @@ std::string DTDataset::GetTargetColumnHeader() const {
 
 
 
+const std::vector<size_t>& DTDataset::GetClassCounts() const {
+    return GetTargetStats().classCounts;
+}
+
+std::vector<size_t> DTDataset::GetClassCountsForFeature(size_t featureIndex) const {
+    if (featureIndex >= _numColumns) {
+        throw std::out_of_range("Некорректный индекс признака");
+    }
+
+    // Плоская матрица [код значения признака][код класса]
+    const DTColumn& feature = _columns[featureIndex];
+    const DTColumn& target = _columns[_targetColumn];
+    const size_t numClasses = target.Cardinality();
+    std::vector<size_t> counts(feature.Cardinality() * numClasses, 0);
+
+    feature.VisitCodes([&](const auto* featureCodes) {
+        target.VisitCodes([&](const auto* targetCodes) {
+            for (size_t i = 0; i < _numRows; ++i) {
+                counts[featureCodes[i] * numClasses + targetCodes[i]]++;
+            }
+        });
+    });
+    return counts;
+}
+
 std::unordered_map<std::string, size_t> DTDataset::GetClassDistribution() const {
+    const auto& classes = _columns[_targetColumn].GetDictionary().GetValues();
+    const auto& counts = GetClassCounts();
+
     std::unordered_map<std::string, size_t> dist;
-    for (const auto& row : _data) {
-        dist[row[_targetColumn]]++;
+    for (size_t c = 0; c < counts.size(); ++c) {
+        if (counts[c] > 0)
+            dist[classes[c]] = counts[c];
     }
     return dist;
 }
 
 std::unordered_map<std::string, std::unordered_map<std::string, size_t>>
 DTDataset::GetClassDistributionForFeature(size_t featureIndex) const {
-    if (featureIndex >= _numColumns) {
-        throw std::out_of_range("  ");
-    }
+    auto counts = GetClassCountsForFeature(featureIndex);
+    const auto& values = _columns[featureIndex].GetDictionary().GetValues();
+    const auto& classes = _columns[_targetColumn].GetDictionary().GetValues();
+    const size_t numClasses = classes.size();
 
     std::unordered_map<std::string, std::unordered_map<std::string, size_t>> dist;
-    for (const auto& row : _data) {
-        const std::string& featureValue = row[featureIndex];
-        const std::string& targetValue = row[_targetColumn];
-        dist[featureValue][targetValue]++;
+    for (size_t v = 0; v < values.size(); ++v) {
+        for (size_t c = 0; c < numClasses; ++c) {
+            size_t count = counts[v * numClasses + c];
+            if (count > 0)
+                dist[values[v]][classes[c]] = count;
+        }
     }
     return dist;
 }
@@ -408,95 +992,72 @@ DTDataset::GetClassDistributionForFeature(size_t featureIndex) const {
 
 
 double DTDataset::CalculateEntropy() const {
-    auto dist = GetClassDistribution();
-    double entropy = 0.0;
-    size_t total = _data.size();
-    if (total == 0)
-        return 0.0;
-    for (const auto& pair : dist) {
-        double p = static_cast<double>(pair.second) / total;
-        if (p > 0) entropy -= p * log2(p);
-    }
-
-    return entropy;
+    return GetTargetStats().entropy;
 }
 
 double DTDataset::GetTargetEntropy() const {
-    return _targetEntropy;
+    return GetTargetStats().entropy;
 }
 
 
 
 DTDataset DTDataset::GetFeatureValueSubset(size_t featureColumn, const std::string& value) const {
-    if (featureColumn >= _numColumns) {
-        std::stringstream ss;
-        ss << "  : " << featureColumn
-            << " ( 0-" << (_numColumns - 1) << ")";
-        throw std::out_of_range(ss.str());
-    }
+    CheckColumnIndex(featureColumn);
 
     if (featureColumn == _targetColumn) {
-        throw std::invalid_argument("   ");
+        throw std::invalid_argument("Нельзя удалить целевой столбец");
     }
 
-    DTDataset subset;
-    subset._headers = _headers;
-    subset._numColumns = _numColumns - 1;
-    subset._headerLoaded = _headerLoaded;
-
-    //  ,   featureColumn
-    for (const auto& row : _data) {
-        if (row[featureColumn] == value) {
-            std::vector<std::string> newRow = row;
-            newRow.erase(newRow.begin() + featureColumn);
-            subset._data.push_back(newRow);
-        }
-    }
+    // Отбираем строки по коду значения, без сравнения строк
+    const DTColumn& feature = _columns[featureColumn];
+    uint32_t code = feature.GetDictionary().Find(value);
 
-    //  
-    if (_headerLoaded) {
-        subset._headers = _headers;
-        subset._headers.erase(subset._headers.begin() + featureColumn);
+    std::vector<size_t> rows;
+    if (code != DTDictionary::NoCode) {
+        feature.VisitCodes([&](const auto* codes) {
+            for (size_t i = 0; i < _numRows; ++i) {
+                if (codes[i] == code)
+                    rows.push_back(i);
+            }
+        });
     }
 
-    if (subset._data.size() == 0) {
+    if (rows.empty()) {
         std::stringstream ss;
-        ss << "      ,    \""
-            << _headers[featureColumn] << "\"    \"" << value << "\"\n, "
-            << "       ";
+        ss << "Не было найдено ни одного примера данных, для которого признак \""
+            << _headers[featureColumn] << "\" имел бы значение \"" << value << "\"\nВозможно, "
+            << "неверно указан индекс признака или его искомое значение";
         throw std::invalid_argument(ss.str());
     }
 
-    return subset;
+    return GatherRows(rows, featureColumn);
 }
 
 DTDataset DTDataset::GetSubsetWithoutColumn(size_t columnIndex) const {
     if (columnIndex >= _numColumns) {
         std::stringstream ss;
-        ss << "  " << columnIndex << "    [0, " << (_numColumns - 1) << "]";
+        ss << "Индекс столбца " << columnIndex << " выходит за пределы [0, " << (_numColumns - 1) << "]";
         throw std::out_of_range(ss.str());
     }
 
-    DTDataset subset;
-    subset._headers = _headers;
-    subset._numColumns = _numColumns - 1;
-    subset._headerLoaded = _headerLoaded;
-
-    //  ,   
-    if (_headerLoaded) {
-        subset._headers.erase(subset._headers.begin() + columnIndex);
+    if (_numRows == 0) {
+        throw std::runtime_error("Результирующий набор данных пуст");
     }
 
-    //     
-    for (const auto& row : _data) {
-        std::vector<std::string> newRow = row;
-        newRow.erase(newRow.begin() + columnIndex);
-        subset._data.push_back(newRow);
-    }
-
-    if (subset._data.empty()) {
-        throw std::runtime_error("   ");
+    // Столбцы копируются целиком, без построчного пересоздания
+    DTDataset subset;
+    subset._numRows = _numRows;
+    subset._headerLoaded = _headerLoaded;
+    for (size_t i = 0; i < _numColumns; ++i) {
+        if (i == columnIndex)
+            continue;
+        subset._columns.push_back(_columns[i]);
+        if (_headerLoaded)
+            subset._headers.push_back(_headers[i]);
     }
+    subset._numColumns = subset._columns.size();
+    subset._targetColumn = (columnIndex == _targetColumn) ? 0 :
+        (_targetColumn > columnIndex ? _targetColumn - 1 : _targetColumn);
 
     return subset;
 }
@@ -506,38 +1067,45 @@ DTDataset DTDataset::GetSubsetWithoutColumn(const std::string& columnName) const
 }
 
 DTDataset DTDataset::GetSubsetWithoutRow(size_t rowIndex) const {
-    if (rowIndex >= _data.size()) {
+    if (rowIndex >= _numRows) {
         std::stringstream ss;
-        ss << "  " << rowIndex << "    [0, " << (_data.size() - 1) << "]";
+        ss << "Индекс строки " << rowIndex << " выходит за пределы [0, " << (_numRows - 1) << "]";
         throw std::out_of_range(ss.str());
     }
 
     DTDataset subset = *this;
-    subset._data.erase(subset._data.begin() + rowIndex);
+    subset._featureBins.reset();
+    subset.ResetTargetStats();
+    for (auto& column : subset._columns) {
+        column.Erase(rowIndex, rowIndex + 1);
+    }
+    subset._numRows--;
 
-    if (subset._data.empty()) {
-        throw std::runtime_error("   ");
+    if (subset._numRows == 0) {
+        throw std::runtime_error("Результирующий набор данных пуст");
     }
 
     return subset;
 }
 
 DTDataset DTDataset::GetSubsetWithoutRows(size_t startIndex, size_t endIndex) const {
-    if (startIndex > endIndex || endIndex >= _data.size()) {
+    if (startIndex > endIndex || endIndex >= _numRows) {
         std::stringstream ss;
-        ss << "  [" << startIndex << ", " << endIndex
-            << "].  [0, " << (_data.size() - 1) << "]";
+        ss << "Некорректный диапазон [" << startIndex << ", " << endIndex
+            << "]. Допустимо [0, " << (_numRows - 1) << "]";
         throw std::out_of_range(ss.str());
     }
 
     DTDataset subset = *this;
-    subset._data.erase(
-        subset._data.begin() + startIndex,
-        subset._data.begin() + endIndex + 1
-    );
+    subset._featureBins.reset();
+    subset.ResetTargetStats();
+    for (auto& column : subset._columns) {
+        column.Erase(startIndex, endIndex + 1);
+    }
+    subset._numRows -= endIndex - startIndex + 1;
 
-    if (subset._data.empty()) {
-        throw std::runtime_error("   ");
+    if (subset._numRows == 0) {
+        throw std::runtime_error("Результирующий набор данных пуст");
     }
 
     return subset;
@@ -0,0 +1,417 @@
+#include <../include/DecisionTrees/DTDatasetView.h>
+
+#include <numeric>
+
+DTDatasetView::DTDatasetView(const DTDataset& dataset)
+    : _dataset(&dataset),
+    _indexStorage(std::make_shared<std::vector<uint32_t>>()) {
+    if (dataset.RowCount() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Слишком много строк для представления набора данных");
+    }
+
+    auto& rows = *_indexStorage;
+    rows.resize(dataset.RowCount());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = static_cast<uint32_t>(i);
+    }
+    _rows = std::span<uint32_t>(rows);
+    InitFeatures();
+
+    // Представление всего набора берёт распределение классов из кэша набора
+    _classCounts = dataset.GetClassCounts();
+    _hasClassCounts = true;
+}
+
+DTDatasetView::DTDatasetView(const DTDataset& dataset, std::vector<uint32_t> rows)
+    : _dataset(&dataset),
+    _indexStorage(std::make_shared<std::vector<uint32_t>>(std::move(rows))) {
+    for (uint32_t row : *_indexStorage) {
+        if (row >= dataset.RowCount())
+            throw std::out_of_range("Индекс строки выходит за пределы набора данных");
+    }
+
+    _rows = std::span<uint32_t>(*_indexStorage);
+    InitFeatures();
+}
+
+DTDatasetView DTDatasetView::Clone() const {
+    // Копия с собственными строками и упорядоченными списками: разбиения переставляют их на месте,
+    // и обучение на копии не трогает исходное представление
+    DTDatasetView copy(*this);
+    copy._indexStorage = std::make_shared<std::vector<uint32_t>>(_rows.begin(), _rows.end());
+    copy._rows = std::span<uint32_t>(*copy._indexStorage);
+    if (!_sortedRows.empty()) {
+        copy._sortedStorage = std::make_shared<std::vector<uint32_t>>(_sortedRows.size() * _rows.size());
+        for (size_t i = 0; i < _sortedRows.size(); ++i) {
+            std::span<uint32_t> sorted(copy._sortedStorage->data() + i * _rows.size(), _sortedRows[i].size());
+            std::copy(_sortedRows[i].begin(), _sortedRows[i].end(), sorted.begin());
+            copy._sortedRows[i] = sorted;
+        }
+    }
+    return copy;
+}
+
+DTDatasetView::DTDatasetView(const DTDatasetView& parent, std::span<uint32_t> rows, size_t removedFeature)
+    : _dataset(parent._dataset),
+    _indexStorage(parent._indexStorage),
+    _rows(rows),
+    _activeFeatures(parent._activeFeatures),
+    _numActiveFeatures(parent._numActiveFeatures),
+    _sortedStorage(parent._sortedStorage),
+    _sortedSlots(parent._sortedSlots) {
+    if (removedFeature < _activeFeatures.size() && _activeFeatures[removedFeature]) {
+        _activeFeatures[removedFeature] = false;
+        _numActiveFeatures--;
+    }
+}
+
+
+
+void DTDatasetView::InitFeatures() {
+    // Активны все признаки, кроме целевого
+    _activeFeatures.assign(_dataset->ColumnCount(), true);
+    if (_dataset->ColumnCount() > 0) {
+        _activeFeatures[_dataset->GetTargetColumn()] = false;
+        _numActiveFeatures = _dataset->ColumnCount() - 1;
+    }
+}
+
+const DTDataset& DTDatasetView::GetDataset() const {
+    return *_dataset;
+}
+
+std::span<const uint32_t> DTDatasetView::GetRows() const {
+    return _rows;
+}
+
+size_t DTDatasetView::RowCount() const {
+    return _rows.size();
+}
+
+size_t DTDatasetView::GetTargetColumn() const {
+    return _dataset->GetTargetColumn();
+}
+
+bool DTDatasetView::IsFeatureActive(size_t columnIndex) const {
+    return columnIndex < _activeFeatures.size() && _activeFeatures[columnIndex];
+}
+
+bool DTDatasetView::IsFeatureNumeric(size_t columnIndex) const {
+    return IsFeatureActive(columnIndex) && _dataset->GetColumn(columnIndex).IsNumeric();
+}
+
+size_t DTDatasetView::ActiveFeatureCount() const {
+    return _numActiveFeatures;
+}
+
+size_t DTDatasetView::GetActiveFeatureRank(size_t columnIndex) const {
+    // Номер признака среди оставшихся столбцов (включая целевой), как в материализованном подмножестве
+    size_t rank = 0;
+    for (size_t i = 0; i < columnIndex && i < _activeFeatures.size(); ++i) {
+        if (_activeFeatures[i] || i == GetTargetColumn())
+            rank++;
+    }
+    return rank;
+}
+
+
+
+const std::vector<size_t>& DTDatasetView::GetClassCounts() const {
+    // Распределение считается один раз: строки представления после создания не меняются,
+    // разбиения лишь переставляют их. Кэш не синхронизирован - представление
+    // в каждый момент принадлежит одной задаче
+    if (!_hasClassCounts) {
+        const DTColumn& target = _dataset->GetColumn(GetTargetColumn());
+        _classCounts.assign(target.Cardinality(), 0);
+        target.VisitCodes([&](const auto* codes) {
+            for (uint32_t row : _rows) {
+                _classCounts[codes[row]]++;
+            }
+        });
+        _hasClassCounts = true;
+    }
+    return _classCounts;
+}
+
+void DTDatasetView::SetClassCounts(std::vector<size_t> classCounts) {
+    _classCounts = std::move(classCounts);
+    _hasClassCounts = true;
+}
+
+std::vector<size_t> DTDatasetView::GetClassCountsForFeature(size_t featureIndex) const {
+    // Плоская матрица [код значения признака][код класса]
+    const DTColumn& feature = _dataset->GetColumn(featureIndex);
+    const DTColumn& target = _dataset->GetColumn(GetTargetColumn());
+    const size_t numClasses = target.Cardinality();
+    std::vector<size_t> counts(feature.Cardinality() * numClasses, 0);
+
+    feature.VisitCodes([&](const auto* featureCodes) {
+        target.VisitCodes([&](const auto* targetCodes) {
+            for (uint32_t row : _rows) {
+                counts[featureCodes[row] * numClasses + targetCodes[row]]++;
+            }
+        });
+    });
+    return counts;
+}
+
+double DTDatasetView::CalculateEntropy() const {
+    const auto& counts = GetClassCounts();
+    double entropy = 0.0;
+    size_t total = _rows.size();
+    if (total == 0)
+        return 0.0;
+    for (size_t count : counts) {
+        double p = static_cast<double>(count) / total;
+        if (p > 0) entropy -= p * log2(p);
+    }
+
+    return entropy;
+}
+
+bool DTDatasetView::AllSameTargetValue() const {
+    if (_rows.empty())
+        return false;
+
+    // С известным распределением проход по строкам не нужен
+    if (_hasClassCounts)
+        return std::count_if(_classCounts.begin(), _classCounts.end(), [](size_t count) { return count != 0; }) == 1;
+
+    const DTColumn& target = _dataset->GetColumn(GetTargetColumn());
+    return target.VisitCodes([&](const auto* codes) {
+        const auto first = codes[_rows[0]];
+        for (uint32_t row : _rows) {
+            if (codes[row] != first)
+                return false;
+        }
+        return true;
+    });
+}
+
+
+
+void DTDatasetView::PresortNumericFeatures() {
+    std::vector<size_t> numeric;
+    for (size_t col = 0; col < _activeFeatures.size(); ++col) {
+        if (IsFeatureNumeric(col))
+            numeric.push_back(col);
+    }
+
+    // Упорядоченные списки хранятся только для числовых признаков; номер списка признака
+    // общий для всех потомков представления
+    auto slots = std::make_shared<std::vector<size_t>>(_dataset->ColumnCount(), NoSlot);
+    for (size_t i = 0; i < numeric.size(); ++i) {
+        (*slots)[numeric[i]] = i;
+    }
+    _sortedSlots = std::move(slots);
+    _sortedRows.assign(numeric.size(), {});
+    _sortedStorage = std::make_shared<std::vector<uint32_t>>(numeric.size() * _rows.size());
+    if (numeric.empty())
+        return;
+
+    // Строки упорядочиваются по значению один раз для всего обучения: сначала сортируются
+    // коды словаря (их немного), затем строки раскладываются подсчётом по рангу кода.
+    // Дальше разбиения узлов сохраняют порядок, и потомки получают готовые списки
+    for (size_t i = 0; i < numeric.size(); ++i) {
+        const DTColumn& column = _dataset->GetColumn(numeric[i]);
+        const auto& numbers = column.GetNumbers();
+
+        std::vector<uint32_t> order(numbers.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&numbers](uint32_t a, uint32_t b) {
+            return numbers[a] < numbers[b];
+        });
+        std::vector<size_t> offsets(order.size() + 1, 0);
+        std::vector<uint32_t> rank(order.size());
+        for (size_t r = 0; r < order.size(); ++r) {
+            rank[order[r]] = static_cast<uint32_t>(r);
+        }
+
+        std::span<uint32_t> sorted(_sortedStorage->data() + i * _rows.size(), _rows.size());
+        column.VisitCodes([&](const auto* codes) {
+            for (uint32_t row : _rows) {
+                offsets[rank[codes[row]] + 1]++;
+            }
+            for (size_t r = 1; r < offsets.size(); ++r) {
+                offsets[r] += offsets[r - 1];
+            }
+            for (uint32_t row : _rows) {
+                sorted[offsets[rank[codes[row]]]++] = row;
+            }
+        });
+        _sortedRows[i] = sorted;
+    }
+}
+
+bool DTDatasetView::IsPresorted() const {
+    return _sortedSlots != nullptr;
+}
+
+bool DTDatasetView::HasSortedRows(size_t columnIndex) const {
+    if (!_sortedSlots || columnIndex >= _sortedSlots->size() || _rows.empty())
+        return false;
+    size_t slot = (*_sortedSlots)[columnIndex];
+    return slot != NoSlot && slot < _sortedRows.size() && _sortedRows[slot].size() == _rows.size();
+}
+
+std::span<const uint32_t> DTDatasetView::GetSortedRows(size_t columnIndex) const {
+    if (!HasSortedRows(columnIndex))
+        throw std::logic_error("Строки признака не упорядочены заранее");
+    return _sortedRows[(*_sortedSlots)[columnIndex]];
+}
+
+template <typename ChildOf>
+std::vector<std::vector<std::span<uint32_t>>> DTDatasetView::SplitSortedRows(const ChildOf& childOf, const std::vector<size_t>& offsets) {
+    // Устойчивое разбиение упорядоченных списков: у каждого потомка строки остаются
+    // упорядоченными по значению, поэтому повторная сортировка не нужна.
+    // childOf возвращает номер непустого потомка, offsets - границы их отрезков
+    const size_t numChildren = offsets.size() - 1;
+    std::vector<std::vector<std::span<uint32_t>>> result(numChildren, std::vector<std::span<uint32_t>>(_sortedRows.size()));
+    std::vector<uint32_t> scratch;
+    for (size_t col = 0; col < _sortedRows.size(); ++col) {
+        std::span<uint32_t> sorted = _sortedRows[col];
+        if (sorted.empty())
+            continue;
+
+        scratch.resize(sorted.size());
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t row : sorted) {
+            scratch[cursor[childOf(row)]++] = row;
+        }
+        std::copy(scratch.begin(), scratch.end(), sorted.begin());
+
+        for (size_t child = 0; child < numChildren; ++child) {
+            result[child][col] = sorted.subspan(offsets[child], offsets[child + 1] - offsets[child]);
+        }
+    }
+    return result;
+}
+
+std::vector<std::pair<uint32_t, DTDatasetView>> DTDatasetView::Partition(size_t featureIndex) {
+    if (!IsFeatureActive(featureIndex)) {
+        throw std::invalid_argument("Признак уже использован или является целевым");
+    }
+
+    const DTColumn& feature = _dataset->GetColumn(featureIndex);
+    std::vector<size_t> offsets(feature.Cardinality() + 1, 0);
+    std::vector<uint32_t> scratch(_rows.size());
+
+    // Устойчивая сортировка подсчётом по коду значения: строки каждой ветви
+    // становятся непрерывным отрезком общего буфера индексов
+    feature.VisitCodes([&](const auto* codes) {
+        for (uint32_t row : _rows) {
+            offsets[codes[row] + 1]++;
+        }
+        for (size_t c = 1; c < offsets.size(); ++c) {
+            offsets[c] += offsets[c - 1];
+        }
+
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t row : _rows) {
+            scratch[cursor[codes[row]]++] = row;
+        }
+    });
+    std::copy(scratch.begin(), scratch.end(), _rows.begin());
+
+    // Потомки заводятся только для значений, встретившихся в узле
+    std::vector<std::pair<uint32_t, DTDatasetView>> children;
+    std::vector<size_t> childOffsets{ 0 };
+    for (size_t code = 0; code + 1 < offsets.size(); ++code) {
+        size_t begin = offsets[code];
+        size_t end = offsets[code + 1];
+        if (begin == end)
+            continue;
+
+        children.emplace_back(
+            static_cast<uint32_t>(code),
+            DTDatasetView(*this, _rows.subspan(begin, end - begin), featureIndex));
+        childOffsets.push_back(end);
+    }
+
+    if (!_sortedRows.empty()) {
+        // Номер непустого потомка для каждого кода; коды без строк в узле не встречаются
+        std::vector<uint32_t> childOfCode(offsets.size() - 1, 0);
+        for (size_t code = 0, child = 0; code + 1 < offsets.size(); ++code) {
+            if (offsets[code] != offsets[code + 1])
+                childOfCode[code] = static_cast<uint32_t>(child++);
+        }
+        std::vector<std::vector<std::span<uint32_t>>> sortedChildren;
+        feature.VisitCodes([&](const auto* codes) {
+            sortedChildren = SplitSortedRows([&](uint32_t row) { return childOfCode[codes[row]]; }, childOffsets);
+        });
+        for (size_t child = 0; child < children.size(); ++child) {
+            children[child].second._sortedRows = std::move(sortedChildren[child]);
+        }
+    }
+    return children;
+}
+
+std::pair<DTDatasetView, DTDatasetView> DTDatasetView::PartitionByThreshold(size_t featureIndex, float threshold) {
+    if (!IsFeatureNumeric(featureIndex)) {
+        throw std::invalid_argument("Признак не является числовым или не активен");
+    }
+
+    // Числовой признак остаётся активным: потомки могут разбиваться по нему снова
+    const DTColumn& feature = _dataset->GetColumn(featureIndex);
+    const auto& numbers = feature.GetNumbers();
+    std::vector<size_t> offsets(3, 0);
+    std::vector<std::vector<std::span<uint32_t>>> sortedChildren;
+
+    feature.VisitCodes([&](const auto* codes) {
+        auto childOf = [&](uint32_t row) -> size_t {
+            return numbers[codes[row]] <= threshold ? 0 : 1;
+        };
+
+        auto middle = std::stable_partition(_rows.begin(), _rows.end(), [&](uint32_t row) {
+            return childOf(row) == 0;
+        });
+        offsets[1] = static_cast<size_t>(middle - _rows.begin());
+        offsets[2] = _rows.size();
+
+        if (!_sortedRows.empty())
+            sortedChildren = SplitSortedRows(childOf, offsets);
+    });
+
+    DTDatasetView lessOrEqual(*this, _rows.subspan(0, offsets[1]), static_cast<size_t>(-1));
+    DTDatasetView greater(*this, _rows.subspan(offsets[1]), static_cast<size_t>(-1));
+    if (!sortedChildren.empty()) {
+        lessOrEqual._sortedRows = std::move(sortedChildren[0]);
+        greater._sortedRows = std::move(sortedChildren[1]);
+    }
+    return { std::move(lessOrEqual), std::move(greater) };
+}
+
+std::pair<DTDatasetView, DTDatasetView> DTDatasetView::PartitionBySubset(size_t featureIndex, const std::vector<bool>& inSubset) {
+    if (!IsFeatureActive(featureIndex) || IsFeatureNumeric(featureIndex)) {
+        throw std::invalid_argument("Признак не является категориальным или не активен");
+    }
+
+    // Двоичное разбиение не исчерпывает значения признака, поэтому он остаётся активным, как числовой
+    const DTColumn& feature = _dataset->GetColumn(featureIndex);
+    std::vector<size_t> offsets(3, 0);
+    std::vector<std::vector<std::span<uint32_t>>> sortedChildren;
+
+    feature.VisitCodes([&](const auto* codes) {
+        auto childOf = [&](uint32_t row) -> size_t {
+            uint32_t code = codes[row];
+            return code < inSubset.size() && inSubset[code] ? 0 : 1;
+        };
+
+        auto middle = std::stable_partition(_rows.begin(), _rows.end(), [&](uint32_t row) {
+            return childOf(row) == 0;
+        });
+        offsets[1] = static_cast<size_t>(middle - _rows.begin());
+        offsets[2] = _rows.size();
+
+        if (!_sortedRows.empty())
+            sortedChildren = SplitSortedRows(childOf, offsets);
+    });
+
+    DTDatasetView members(*this, _rows.subspan(0, offsets[1]), static_cast<size_t>(-1));
+    DTDatasetView others(*this, _rows.subspan(offsets[1]), static_cast<size_t>(-1));
+    if (!sortedChildren.empty()) {
+        members._sortedRows = std::move(sortedChildren[0]);
+        others._sortedRows = std::move(sortedChildren[1]);
+    }
+    return { std::move(members), std::move(others) };
+}
@@ -0,0 +1,139 @@
+#include <../include/DecisionTrees/DTFeatureBins.h>
+#include <../include/DecisionTrees/DTDataset.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+size_t DTFeatureBins::ColumnBins::BinCount() const {
+    return numeric ? thresholds.size() + 1 : codeOfBin.size();
+}
+
+void DTFeatureBins::BuildCategorical(const std::vector<size_t>& counts, size_t maxBins, ColumnBins& bins) {
+    const size_t cardinality = counts.size();
+    bins.binOfCode.resize(cardinality);
+
+    // Если значений не больше числа корзин, корзина совпадает с кодом значения
+    // и приросты считаются так же точно, как по таблице сопряжённости
+    if (cardinality <= maxBins) {
+        bins.codeOfBin.resize(cardinality);
+        std::iota(bins.codeOfBin.begin(), bins.codeOfBin.end(), 0u);
+        std::iota(bins.binOfCode.begin(), bins.binOfCode.end(), uint8_t(0));
+        return;
+    }
+
+    // Иначе самые частые значения получают по своей корзине, а остальные
+    // делят последнюю; внутри корзин порядок значений сохраняется
+    std::vector<uint32_t> order(cardinality);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&counts](uint32_t a, uint32_t b) {
+        return counts[a] > counts[b];
+    });
+    order.resize(maxBins - 1);
+    std::sort(order.begin(), order.end());
+
+    std::fill(bins.binOfCode.begin(), bins.binOfCode.end(), static_cast<uint8_t>(maxBins - 1));
+    for (size_t bin = 0; bin < order.size(); ++bin) {
+        bins.binOfCode[order[bin]] = static_cast<uint8_t>(bin);
+    }
+    bins.codeOfBin = std::move(order);
+    bins.codeOfBin.push_back(GroupedValues);
+}
+
+void DTFeatureBins::BuildNumeric(const DTColumn& column, const std::vector<size_t>& counts, size_t maxBins, size_t numRows, ColumnBins& bins) {
+    const auto& numbers = column.GetNumbers();
+    std::vector<uint32_t> order(numbers.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&numbers](uint32_t a, uint32_t b) {
+        return numbers[a] < numbers[b];
+    });
+    size_t distinct = order.empty() ? 0 : 1;
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (numbers[order[i - 1]] < numbers[order[i]])
+            distinct++;
+    }
+
+    // Интервалы равной частоты по строкам всего набора. Если различных значений
+    // не больше числа интервалов, у каждого значения свой интервал и поиск точный
+    bins.numeric = true;
+    bins.binOfCode.resize(numbers.size());
+    size_t filled = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && numbers[order[i - 1]] < numbers[order[i]] && bins.thresholds.size() + 1 < maxBins
+            && (distinct <= maxBins || filled * maxBins >= (bins.thresholds.size() + 1) * numRows)) {
+            bins.thresholds.push_back(DTSplitThreshold(numbers[order[i - 1]], numbers[order[i]]));
+        }
+        bins.binOfCode[order[i]] = static_cast<uint8_t>(bins.thresholds.size());
+        filled += counts[order[i]];
+    }
+}
+
+DTFeatureBins DTFeatureBins::Build(const DTDataset& dataset, size_t maxBins, WorkStealingPool* pool) {
+    if (maxBins < 2 || maxBins > MaxBins) {
+        throw std::invalid_argument("Число интервалов гистограммы должно быть от 2 до 256");
+    }
+
+    DTFeatureBins result;
+    result._maxBins = maxBins;
+    result._columns.resize(dataset.ColumnCount());
+    const size_t numRows = dataset.RowCount();
+
+    // Корзины строятся для всех столбцов, включая целевой: тогда смена целевого
+    // столбца не требует перестроения
+    auto buildColumn = [&](size_t col) {
+        const DTColumn& column = dataset.GetColumn(col);
+        ColumnBins& bins = result._columns[col];
+
+        std::vector<size_t> counts(column.Cardinality(), 0);
+        column.VisitCodes([&](const auto* codes) {
+            for (size_t row = 0; row < numRows; ++row) {
+                counts[codes[row]]++;
+            }
+        });
+
+        if (column.IsNumeric())
+            BuildNumeric(column, counts, maxBins, numRows, bins);
+        else
+            BuildCategorical(counts, maxBins, bins);
+
+        bins.rows.resize(numRows);
+        column.VisitCodes([&](const auto* codes) {
+            for (size_t row = 0; row < numRows; ++row) {
+                bins.rows[row] = bins.binOfCode[codes[row]];
+            }
+        });
+    };
+
+    if (pool != nullptr && result._columns.size() > 1) {
+        pool->ParallelFor(result._columns.size(), buildColumn);
+    }
+    else {
+        for (size_t col = 0; col < result._columns.size(); ++col) {
+            buildColumn(col);
+        }
+    }
+    return result;
+}
+
+size_t DTFeatureBins::MaxBinCount() const {
+    return _maxBins;
+}
+
+size_t DTFeatureBins::ColumnCount() const {
+    return _columns.size();
+}
+
+const DTFeatureBins::ColumnBins& DTFeatureBins::GetColumn(size_t columnIndex) const {
+    if (columnIndex >= _columns.size())
+        throw std::out_of_range("Некорректный индекс столбца");
+    return _columns[columnIndex];
+}
+
+size_t DTFeatureBins::MemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& bins : _columns) {
+        bytes += bins.rows.capacity() + bins.binOfCode.capacity()
+            + bins.codeOfBin.capacity() * sizeof(uint32_t) + bins.thresholds.capacity() * sizeof(float);
+    }
+    return bytes;
+}
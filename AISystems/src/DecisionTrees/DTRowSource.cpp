@@ -0,0 +1,155 @@
+#include <../include/DecisionTrees/DTRowSource.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+const std::vector<std::string>& DTDatasetRowSource::GetHeaders() const {
+    return _dataset.GetHeaders();
+}
+
+size_t DTDatasetRowSource::ColumnCount() const {
+    return _dataset.ColumnCount();
+}
+
+const DTDictionary& DTDatasetRowSource::GetDictionary(size_t columnIndex) const {
+    return _dataset.GetColumn(columnIndex).GetDictionary();
+}
+
+bool DTDatasetRowSource::DictionariesComplete() const {
+    return true;
+}
+
+void DTDatasetRowSource::Rewind() {
+    _position = 0;
+}
+
+bool DTDatasetRowSource::ReadChunk(DTCodeChunk& chunk, size_t maxRows) {
+    const size_t rows = std::min(maxRows, _dataset.RowCount() - _position);
+    chunk.rows = rows;
+    chunk.columns.resize(_dataset.ColumnCount());
+    if (rows == 0)
+        return false;
+
+    // Для отображённого набора копируется только текущий отрезок кодов
+    for (size_t col = 0; col < chunk.columns.size(); ++col) {
+        chunk.columns[col].resize(rows);
+        _dataset.GetColumn(col).VisitCodes([&](const auto* codes) {
+            std::copy(codes + _position, codes + _position + rows, chunk.columns[col].begin());
+        });
+    }
+    _position += rows;
+    return true;
+}
+
+
+
+DTCsvRowSource::DTCsvRowSource(const std::string& filename, char delimiter, bool hasHeader)
+    : _delimiter(delimiter), _scanner(nullptr, nullptr, delimiter) {
+    if (!_file.Open(filename)) {
+        throw std::runtime_error("Файл не найден: " + filename);
+    }
+
+    const char* end = _file.Data() + _file.Size();
+    DTCsvScanner scanner(_file.Data(), end, delimiter);
+    if (hasHeader) {
+        if (!scanner.NextLine(_tokens)) {
+            throw std::runtime_error("Файл пуст, но ожидался заголовок");
+        }
+        _headers.assign(_tokens.begin(), _tokens.end());
+        _headerLines = 1;
+
+        if (_headers.empty()) {
+            throw std::invalid_argument("Заголовок не содержит данных");
+        }
+    }
+    _dataStart = scanner.Position();
+
+    // Без заголовка число столбцов берётся из первой непустой строки
+    size_t numColumns = _headers.size();
+    if (numColumns == 0) {
+        while (scanner.NextLine(_tokens) && _tokens.empty()) {
+        }
+        if (_tokens.empty()) {
+            throw std::runtime_error("Файл не содержит данных");
+        }
+        numColumns = _tokens.size();
+    }
+
+    _dictionaries.resize(numColumns);
+    Rewind();
+}
+
+void DTCsvRowSource::ThrowRowError(size_t tokenCount, size_t emptyColumn) const {
+    std::stringstream ss;
+    if (tokenCount != _dictionaries.size()) {
+        ss << "Ошибка в строке " << _lineNumber
+            << ": ожидалось " << _dictionaries.size()
+            << " столбцов, получено " << tokenCount;
+    }
+    else {
+        ss << "Пустое значение в строке " << _lineNumber
+            << ", столбец " << (_headers.empty() ? std::to_string(emptyColumn) : _headers[emptyColumn]);
+    }
+    throw std::invalid_argument(ss.str());
+}
+
+const std::vector<std::string>& DTCsvRowSource::GetHeaders() const {
+    return _headers;
+}
+
+size_t DTCsvRowSource::ColumnCount() const {
+    return _dictionaries.size();
+}
+
+const DTDictionary& DTCsvRowSource::GetDictionary(size_t columnIndex) const {
+    if (columnIndex >= _dictionaries.size())
+        throw std::out_of_range("Некорректный индекс столбца");
+    return _dictionaries[columnIndex];
+}
+
+bool DTCsvRowSource::DictionariesComplete() const {
+    return _complete;
+}
+
+void DTCsvRowSource::Rewind() {
+    _scanner = DTCsvScanner(_dataStart, _file.Data() + _file.Size(), _delimiter);
+    _lineNumber = _headerLines;
+}
+
+bool DTCsvRowSource::ReadChunk(DTCodeChunk& chunk, size_t maxRows) {
+    const size_t numColumns = _dictionaries.size();
+    chunk.rows = 0;
+    chunk.columns.resize(numColumns);
+    for (auto& column : chunk.columns) {
+        column.resize(maxRows);
+    }
+
+    // Значения интернируются в словари источника: коды одинаковы во всех проходах по файлу
+    while (chunk.rows < maxRows && _scanner.NextLine(_tokens)) {
+        ++_lineNumber;
+        if (_tokens.empty())
+            continue;
+
+        if (_tokens.size() != numColumns)
+            ThrowRowError(_tokens.size(), 0);
+        for (size_t col = 0; col < numColumns; ++col) {
+            if (_tokens[col].empty())
+                ThrowRowError(numColumns, col);
+        }
+
+        for (size_t col = 0; col < numColumns; ++col) {
+            chunk.columns[col][chunk.rows] = _dictionaries[col].Intern(_tokens[col]);
+        }
+        ++chunk.rows;
+    }
+
+    if (chunk.rows == 0) {
+        _complete = true;
+        return false;
+    }
+    for (auto& column : chunk.columns) {
+        column.resize(chunk.rows);
+    }
+    return true;
+}
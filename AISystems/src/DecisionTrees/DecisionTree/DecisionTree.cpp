@@ -2,7 +2,7 @@
 
 void DecisionTree::PrintPredictionsTable(const std::vector<std::vector<std::string>>& data, const std::vector<std::string>& predictions) const {
     if (data.empty()) {
-        std::cout << "   " << std::endl;
+        std::cout << "Нет данных для отображения" << std::endl;
         return;
     }
 
@@ -20,7 +20,7 @@ void DecisionTree::PrintPredictionsTable(const std::vector<std::vector<std::stri
         filteredData.push_back(filteredRow);
     }
 
-    tableHeaders.emplace_back("");
+    tableHeaders.emplace_back("Предсказание");
 
     std::vector<size_t> columnWidths;
     for (size_t i = 0; i < tableHeaders.size(); ++i) {
@@ -30,7 +30,7 @@ void DecisionTree::PrintPredictionsTable(const std::vector<std::vector<std::stri
                 maxWidth = std::max(maxWidth, row[i].size());
             }
         }
-        if (i == tableHeaders.size() - 1) { //   Prediction
+        if (i == tableHeaders.size() - 1) { // Для колонки Prediction
             for (const auto& pred : predictions) {
                 maxWidth = std::max(maxWidth, pred.size());
             }
@@ -59,89 +59,295 @@ void DecisionTree::PrintPredictionsTable(const std::vector<std::vector<std::stri
 
 
 
-void DecisionTree::SetRoot(std::unique_ptr<Node> root) {
-    _root = std::move(root);
+void DecisionTree::Compile() {
+    // Плоское представление пересобирается при любом изменении дерева или заголовков.
+    // У загруженной из файла модели арены узлов нет - её плоское представление не трогается
+    if (_nodes && _nodes->GetRoot())
+        _flatTree = FlatTree::Compile(*_nodes->GetRoot(), _headers, _targetColumn);
+}
+
+void DecisionTree::CheckSampleSize(const std::vector<std::string>& sample) const {
+    if (sample.size() != _headers.size() - 1) {
+        std::stringstream ss;
+        ss << "Несоответствие количества признаков. Ожидалось " << _headers.size() - 1
+            << ", получено " << sample.size();
+        throw std::invalid_argument(ss.str());
+    }
+}
+
+void DecisionTree::SetNodes(std::unique_ptr<NodeArena> nodes) {
+    // Узлы дерева живут в арене и освобождаются вместе с ней одним действием
+    _nodes = std::move(nodes);
+    if (_nodes && _nodes->GetRoot())
+        Compile();
+    else
+        _flatTree = FlatTree();
 }
 
 void DecisionTree::SetHeaders(const std::vector<std::string>& headers) {
     _headers = headers;
+    Compile();
 }
 
 void DecisionTree::SetTargetColumn(size_t targetColumn) {
     _targetColumn = targetColumn;
+    Compile();
+}
+
+const Node* DecisionTree::GetRoot() const {
+    return _nodes ? _nodes->GetRoot() : nullptr;
+}
+
+const std::vector<std::string>& DecisionTree::GetHeaders() const {
+    return _headers;
+}
+
+size_t DecisionTree::GetTargetColumn() const {
+    return _targetColumn;
 }
 
+const FlatTree& DecisionTree::GetFlatTree() const {
+    return _flatTree;
+}
+
+
 
+void DecisionTree::Save(const std::string& filename) const {
+    if (_flatTree.Empty())
+        throw std::logic_error("Дерево не обучено");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи модели: " + filename);
+    }
+
+    _flatTree.Save(file, _headers, _targetColumn);
+    if (!file) {
+        throw std::runtime_error("Ошибка записи модели в файл: " + filename);
+    }
+}
+
+DecisionTree DecisionTree::Load(const std::string& filename) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(filename)) {
+        throw std::runtime_error("Файл не найден: " + filename);
+    }
+
+    // Узлы не восстанавливаются в куче: предсказания идут прямо по отображённому файлу
+    DecisionTree tree;
+    tree._flatTree = FlatTree::Load(std::move(file), tree._headers, tree._targetColumn);
+    return tree;
+}
+
+
+
+uint32_t DecisionTree::PredictClass(const std::vector<std::string>& sample) const {
+    if (_flatTree.Empty())
+        throw std::logic_error("Дерево не обучено");
+
+    // Проверка соответствия количества признаков
+    CheckSampleSize(sample);
+
+    return _flatTree.PredictClass(sample);
+}
+
+const std::string& DecisionTree::GetClassLabel(uint32_t classId) const {
+    return _flatTree.GetClassLabel(classId);
+}
 
 std::string DecisionTree::Predict(const std::vector<std::string>& sample) const {
-    if (!_root)
-        throw std::logic_error("  ");
+    return _flatTree.GetClassLabel(PredictClass(sample));
+}
 
-    //    
+void DecisionTree::Predict(const std::vector<std::vector<std::string>>& testData) const {
+    // Сбор предсказаний
+    std::vector<std::string> predictions(testData.size());
+    PredictBatch(testData, std::span<std::string>(predictions), PredictOptions());
 
-    if (sample.size() != _headers.size() - 1) {
+    // Вывод таблицы
+    PrintPredictionsTable(testData, predictions);
+}
+
+void DecisionTree::Predict(const DTDataset& testDataset) const {
+    // Сбор предсказаний
+    std::vector<std::string> predictions(testDataset.RowCount());
+    PredictBatch(testDataset, std::span<std::string>(predictions), PredictOptions());
+
+    // Вывод таблицы: целевой столбец убирается при печати
+    PrintPredictionsTable(testDataset.GetData(), predictions);
+}
+
+
+
+void DecisionTree::CheckDataset(const DTDataset& dataset) const {
+    // Проверка количества столбцов
+    if (dataset.ColumnCount() != _headers.size()) {
         std::stringstream ss;
-        ss << "  .  " << _headers.size() - 1
-            << ",  " << sample.size();
+        ss << "Несоответствие количества признаков. Ожидалось " << _headers.size()
+            << ", получено " << dataset.ColumnCount();
         throw std::invalid_argument(ss.str());
     }
 
-    return _root->Predict(sample, _headers);
+    // Проверка заголовков (если есть)
+    if (dataset.GetHeaders().size() > 0 && dataset.GetHeaders() != _headers) {
+        throw std::invalid_argument("Заголовки тестовых данных не совпадают с ожидаемыми");
+    }
 }
 
-void DecisionTree::Predict(const std::vector<std::vector<std::string>>& testData) const {
-    if (!_root) {
-        throw std::logic_error("  ");
+void DecisionTree::CheckBufferSize(size_t bufferSize, size_t rowCount) const {
+    if (bufferSize != rowCount) {
+        std::stringstream ss;
+        ss << "Размер буфера предсказаний не совпадает с количеством строк. Ожидалось " << rowCount
+            << ", получено " << bufferSize;
+        throw std::invalid_argument(ss.str());
     }
+}
 
-    //    
-    for (const auto& sample : testData) {
-        if (sample.size() != _headers.size() - 1) {
-            std::stringstream ss;
-            ss << "  .  " << _headers.size() - 1
-                << ",  " << sample.size();
-            throw std::invalid_argument(ss.str());
+template <typename CodeOf, typename ValueOf, typename Store>
+void DecisionTree::PredictRows(size_t rowCount, const PredictOptions& options, const CodeOf& codeOf, const ValueOf& valueOf, const Store& store) const {
+    const size_t taskRows = std::max(options.taskRows, FlatTree::BlockSize);
+    const size_t numTasks = (rowCount + taskRows - 1) / taskRows;
+
+    // Задача обрабатывает свой диапазон строк блоками, которые спускаются по дереву уровень за уровнем
+    auto runTask = [&](size_t task) {
+        uint32_t classIds[FlatTree::BlockSize];
+        const size_t last = std::min(rowCount, (task + 1) * taskRows);
+        for (size_t first = task * taskRows; first < last; first += FlatTree::BlockSize) {
+            const size_t count = std::min(FlatTree::BlockSize, last - first);
+            _flatTree.PredictBlock(count, [&](size_t row, uint32_t feature) {
+                return codeOf(first + row, feature);
+            }, [&](size_t row, uint32_t feature) {
+                return valueOf(first + row, feature);
+            }, classIds);
+
+            for (size_t i = 0; i < count; ++i) {
+                store(first + i, classIds[i]);
+            }
         }
+    };
+
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool, numTasks > 1);
+
+    if (pool == nullptr || numTasks < 2) {
+        for (size_t task = 0; task < numTasks; ++task) {
+            runTask(task);
+        }
+        return;
+    }
+
+    pool->ParallelFor(numTasks, runTask);
+}
+
+template <typename RowOf, typename Store>
+void DecisionTree::PredictDataset(const DTDataset& dataset, size_t rowCount, const RowOf& rowOf, const PredictOptions& options, const Store& store) const {
+    if (_flatTree.Empty()) {
+        throw std::logic_error("Дерево не обучено");
     }
+    CheckDataset(dataset);
+
+    // Коды словарей набора данных один раз переводятся в коды значений дерева:
+    // при спуске по дереву не остаётся ни хэширования, ни сравнения строк
+    const size_t numFeatures = _flatTree.FeatureCount();
+    std::vector<const DTColumn*> columns(numFeatures);
+    std::vector<std::vector<uint32_t>> translation(numFeatures);
+    std::vector<std::vector<float>> numbers(numFeatures);
+    for (size_t feature = 0; feature < numFeatures; ++feature) {
+        const DTColumn& column = dataset.GetColumn(_flatTree.GetFeatureColumn(feature));
+        const DTDictionary& treeValues = _flatTree.GetFeatureValues(feature);
+        const auto& values = column.GetDictionary().GetValues();
+
+        columns[feature] = &column;
+        translation[feature].resize(values.size());
+        for (size_t code = 0; code < values.size(); ++code) {
+            translation[feature][code] = treeValues.Find(values[code]);
+        }
 
-    //  
-    std::vector<std::string> predictions;
-    for (const auto& sample : testData) {
-        predictions.push_back(_root->Predict(sample, _headers));
+        // Для пороговых узлов значения словаря один раз переводятся в числа
+        if (!_flatTree.IsFeatureNumeric(feature))
+            continue;
+        if (column.IsNumeric()) {
+            numbers[feature] = column.GetNumbers();
+            continue;
+        }
+        numbers[feature].resize(values.size());
+        for (size_t code = 0; code < values.size(); ++code) {
+            if (!DTParseNumber(values[code], numbers[feature][code]))
+                numbers[feature][code] = std::numeric_limits<float>::quiet_NaN();
+        }
     }
 
-    //  
-    PrintPredictionsTable(testData, predictions);
+    PredictRows(rowCount, options, [&](size_t row, uint32_t feature) {
+        return translation[feature][columns[feature]->GetCode(rowOf(row))];
+    }, [&](size_t row, uint32_t feature) {
+        return numbers[feature][columns[feature]->GetCode(rowOf(row))];
+    }, store);
 }
 
-void DecisionTree::Predict(const DTDataset& testDataset) const {
-    if (!_root) {
-        throw std::logic_error("  ");
+template <typename Store>
+void DecisionTree::PredictSamples(const std::vector<std::vector<std::string>>& samples, const PredictOptions& options, const Store& store) const {
+    if (_flatTree.Empty()) {
+        throw std::logic_error("Дерево не обучено");
     }
 
-    //   
-    if (testDataset.ColumnCount() != _headers.size()) {
-        std::stringstream ss;
-        ss << "  .  " << _headers.size()
-            << ",  " << testDataset.ColumnCount();
-        throw std::invalid_argument(ss.str());
+    // Проверка соответствия количества признаков
+    for (const auto& sample : samples) {
+        CheckSampleSize(sample);
     }
 
-    //   ( )
-    if (testDataset.GetHeaders().size() > 0 && testDataset.GetHeaders() != _headers) {
-        throw std::invalid_argument("      ");
+    std::vector<const DTDictionary*> treeValues(_flatTree.FeatureCount());
+    for (size_t feature = 0; feature < treeValues.size(); ++feature) {
+        treeValues[feature] = &_flatTree.GetFeatureValues(feature);
     }
 
-    //    
-    auto testData = testDataset.GetSubsetWithoutColumn(testDataset.GetTargetColumn()).GetData();
+    PredictRows(samples.size(), options, [&](size_t row, uint32_t feature) {
+        return treeValues[feature]->Find(samples[row][feature]);
+    }, [&](size_t row, uint32_t feature) {
+        float value;
+        return DTParseNumber(samples[row][feature], value) ? value : std::numeric_limits<float>::quiet_NaN();
+    }, store);
+}
+
+void DecisionTree::PredictBatch(const DTDataset& dataset, std::span<uint32_t> classIds, const PredictOptions& options) const {
+    CheckBufferSize(classIds.size(), dataset.RowCount());
+    PredictDataset(dataset, dataset.RowCount(), [](size_t row) { return row; }, options, [&](size_t row, uint32_t classId) {
+        classIds[row] = classId;
+    });
+}
+
+void DecisionTree::PredictBatch(const DTDataset& dataset, std::span<std::string> labels, const PredictOptions& options) const {
+    CheckBufferSize(labels.size(), dataset.RowCount());
+    const DTDictionary& classes = _flatTree.GetClasses();
+    PredictDataset(dataset, dataset.RowCount(), [](size_t row) { return row; }, options, [&](size_t row, uint32_t classId) {
+        labels[row] = classes.GetValue(classId);
+    });
+}
 
-    std::vector<std::string> predictions;
-    for (const auto& row : testData) {
-        predictions.push_back(_root->Predict(row, _headers));
+void DecisionTree::PredictBatch(const DTDataset& dataset, std::span<const uint32_t> rows, std::span<uint32_t> classIds, const PredictOptions& options) const {
+    // Предсказание для подмножества строк набора (например, отложенной части) без его копирования
+    CheckBufferSize(classIds.size(), rows.size());
+    for (uint32_t row : rows) {
+        if (row >= dataset.RowCount())
+            throw std::out_of_range("Индекс строки выходит за пределы набора данных");
     }
+    PredictDataset(dataset, rows.size(), [rows](size_t row) { return rows[row]; }, options, [&](size_t row, uint32_t classId) {
+        classIds[row] = classId;
+    });
+}
 
-    //  
-    PrintPredictionsTable(testData, predictions);
+void DecisionTree::PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<uint32_t> classIds, const PredictOptions& options) const {
+    CheckBufferSize(classIds.size(), samples.size());
+    PredictSamples(samples, options, [&](size_t row, uint32_t classId) {
+        classIds[row] = classId;
+    });
+}
+
+void DecisionTree::PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<std::string> labels, const PredictOptions& options) const {
+    CheckBufferSize(labels.size(), samples.size());
+    const DTDictionary& classes = _flatTree.GetClasses();
+    PredictSamples(samples, options, [&](size_t row, uint32_t classId) {
+        labels[row] = classes.GetValue(classId);
+    });
 }
 
 
@@ -160,8 +366,10 @@ std::string DecisionTree::GetBuildingProcessDescr() const {
 }
 
 void DecisionTree::PrintTree() const {
-    if (_root)
-        _root->Print(0, false, "");
+    if (_nodes && _nodes->GetRoot())
+        _nodes->GetRoot()->Print(0, false, "");
+    else if (!_flatTree.Empty())
+        _flatTree.Print(_headers);
     else
-        std::cout << " \n";
+        std::cout << "Дерево пустое\n";
 }
\ No newline at end of file
@@ -0,0 +1,622 @@
+#include <../include/DecisionTrees/DecisionTree/FlatTree.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    constexpr char ModelMagic[8] = { 'D', 'T', 'M', 'O', 'D', 'E', 'L', '\0' };
+    constexpr uint32_t ByteOrderMark = 0x01020304;
+    constexpr uint64_t SectionAlignment = 16;
+
+    // Заголовок файла модели. Узлы и таблица потомков лежат в файле в том же виде,
+    // что и в памяти, поэтому загруженная модель работает прямо по отображению файла
+    struct ModelHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t metadataOffset;
+        uint64_t metadataSize;
+        uint64_t nodesOffset;
+        uint64_t nodeCount;
+        uint64_t childrenOffset;
+        uint64_t childCount;
+    };
+
+    // Узел версий 2 и 3: порог хранился в самом узле, и узел занимал 20 байт
+    struct LegacyFlatNode {
+        uint32_t feature;
+        uint32_t firstCode;
+        uint32_t codeCount;
+        uint32_t offset;
+        float threshold;
+    };
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+    }
+
+    void WriteU32(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(std::string& out, std::string_view value) {
+        WriteU32(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    [[noreturn]] void ThrowCorrupted(const std::string& reason) {
+        throw std::runtime_error("Файл модели повреждён: " + reason);
+    }
+
+    class MetadataReader {
+    private:
+        const char* _pos;
+        const char* _end;
+
+    public:
+        MetadataReader(const char* begin, const char* end)
+            : _pos(begin), _end(end) {
+        }
+
+        uint32_t ReadU32() {
+            if (_end - _pos < static_cast<ptrdiff_t>(sizeof(uint32_t)))
+                ThrowCorrupted("неожиданный конец метаданных");
+            uint32_t value;
+            std::memcpy(&value, _pos, sizeof(value));
+            _pos += sizeof(value);
+            return value;
+        }
+
+        std::string_view ReadString() {
+            uint32_t length = ReadU32();
+            if (static_cast<size_t>(_end - _pos) < length)
+                ThrowCorrupted("неожиданный конец метаданных");
+            std::string_view value(_pos, length);
+            _pos += length;
+            return value;
+        }
+    };
+}
+
+FlatTree::FlatTree(FlatTree&& other) noexcept {
+    *this = std::move(other);
+}
+
+FlatTree& FlatTree::operator=(FlatTree&& other) noexcept {
+    if (this != &other) {
+        // Буферы векторов при перемещении не переезжают, поэтому представления остаются верными
+        _ownedNodes = std::move(other._ownedNodes);
+        _ownedChildTable = std::move(other._ownedChildTable);
+        _mapping = std::move(other._mapping);
+        _nodes = std::exchange(other._nodes, {});
+        _childTable = std::exchange(other._childTable, {});
+        _featureValues = std::move(other._featureValues);
+        _featureColumns = std::move(other._featureColumns);
+        _featureNumeric = std::move(other._featureNumeric);
+        _classes = std::move(other._classes);
+        _unknownClass = other._unknownClass;
+    }
+    return *this;
+}
+
+void FlatTree::BindOwned() {
+    _nodes = _ownedNodes;
+    _childTable = _ownedChildTable;
+}
+
+FlatTree FlatTree::Compile(const Node& root, const std::vector<std::string>& headers, size_t targetColumn) {
+    FlatTree tree;
+
+    // Признаки нумеруются так же, как значения в примере для предсказания: без целевого столбца
+    std::unordered_map<std::string, uint32_t, DTStringHash, std::equal_to<>> featureIndex;
+    for (size_t col = 0; col < headers.size(); ++col) {
+        if (col == targetColumn)
+            continue;
+        featureIndex.emplace(headers[col], static_cast<uint32_t>(tree._featureColumns.size()));
+        tree._featureColumns.push_back(col);
+    }
+    tree._featureValues.resize(tree._featureColumns.size());
+
+    // Обход в ширину: потомки узла лежат рядом, а верхние уровни - в начале массива
+    std::vector<const Node*> order{ &root };
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (const auto* leaf = dynamic_cast<const LeafNode*>(order[i])) {
+            tree._ownedNodes.push_back({ LeafFeature, 0, 0, tree._classes.Intern(leaf->GetResult()) });
+            continue;
+        }
+
+        if (const auto* split = dynamic_cast<const ThresholdNode*>(order[i])) {
+            auto feature = featureIndex.find(split->GetFeatureName());
+            if (feature == featureIndex.end()) {
+                tree._ownedNodes.push_back({ LeafFeature, 0, 0, tree._classes.Intern("(неизвестно)") });
+                continue;
+            }
+
+            // В таблице потомков две ячейки ("не больше" и "больше"), затем биты порога
+            uint32_t offset = static_cast<uint32_t>(tree._ownedChildTable.size());
+            for (const Node* child : { split->GetLessOrEqual(), split->GetGreater() }) {
+                tree._ownedChildTable.push_back(child ? static_cast<uint32_t>(order.size()) : NoChild);
+                if (child)
+                    order.push_back(child);
+            }
+            tree._ownedChildTable.push_back(std::bit_cast<uint32_t>(split->GetThreshold()));
+            tree._ownedNodes.push_back({ feature->second, ThresholdSplit, 2, offset });
+            continue;
+        }
+
+        if (const auto* subset = dynamic_cast<const SubsetNode*>(order[i])) {
+            auto feature = featureIndex.find(subset->GetFeatureName());
+            if (feature == featureIndex.end()) {
+                tree._ownedNodes.push_back({ LeafFeature, 0, 0, tree._classes.Intern("(неизвестно)") });
+                continue;
+            }
+
+            // Две ячейки потомков ("из подмножества" и "прочие"), затем битовое множество
+            // кодов подмножества: число 32-битных слов и сами слова
+            DTDictionary& values = tree._featureValues[feature->second];
+            std::vector<uint32_t> codes;
+            codes.reserve(subset->GetValues().size());
+            for (const auto& value : subset->GetValues()) {
+                codes.push_back(values.Intern(value));
+            }
+            uint32_t words = codes.empty() ? 0 : *std::max_element(codes.begin(), codes.end()) / 32 + 1;
+
+            uint32_t offset = static_cast<uint32_t>(tree._ownedChildTable.size());
+            for (const Node* child : { subset->GetInSubset(), subset->GetOther() }) {
+                tree._ownedChildTable.push_back(child ? static_cast<uint32_t>(order.size()) : NoChild);
+                if (child)
+                    order.push_back(child);
+            }
+            tree._ownedChildTable.push_back(words);
+            tree._ownedChildTable.resize(tree._ownedChildTable.size() + words, 0);
+            for (uint32_t code : codes) {
+                tree._ownedChildTable[offset + 3 + code / 32] |= 1u << (code % 32);
+            }
+            tree._ownedNodes.push_back({ feature->second, SubsetSplit, 2, offset });
+            continue;
+        }
+
+        const auto* decision = dynamic_cast<const DecisionNode*>(order[i]);
+        if (!decision)
+            throw std::invalid_argument("Неизвестный тип узла дерева решений");
+
+        auto feature = featureIndex.find(decision->GetFeatureName());
+        if (feature == featureIndex.end()) {
+            // Признака нет среди заголовков - любое предсказание через этот узел неизвестно
+            tree._ownedNodes.push_back({ LeafFeature, 0, 0, tree._classes.Intern("(неизвестно)") });
+            continue;
+        }
+
+        DTDictionary& values = tree._featureValues[feature->second];
+        std::vector<std::pair<uint32_t, const Node*>> children;
+        children.reserve(decision->GetChildren().size());
+        for (const auto& [value, child] : decision->GetChildren()) {
+            children.emplace_back(values.Intern(value), child);
+        }
+
+        // Таблица потомков покрывает только диапазон кодов значений, встреченных в этом узле
+        uint32_t firstCode = 0;
+        uint32_t codeCount = 0;
+        if (!children.empty()) {
+            auto [minIt, maxIt] = std::minmax_element(children.begin(), children.end());
+            firstCode = minIt->first;
+            codeCount = maxIt->first - minIt->first + 1;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(tree._ownedChildTable.size());
+        tree._ownedChildTable.resize(tree._ownedChildTable.size() + codeCount, NoChild);
+        for (const auto& [code, child] : children) {
+            tree._ownedChildTable[offset + code - firstCode] = static_cast<uint32_t>(order.size());
+            order.push_back(child);
+        }
+
+        tree._ownedNodes.push_back({ feature->second, firstCode, codeCount, offset });
+    }
+
+    tree._unknownClass = tree._classes.Intern("(неизвестно)");
+    tree.BindOwned();
+    tree.IndexNumericFeatures();
+    return tree;
+}
+
+void FlatTree::IndexNumericFeatures() {
+    // Признак числовой, если по нему есть хотя бы одно пороговое разбиение
+    _featureNumeric.assign(_featureColumns.size(), 0);
+    for (const FlatNode& node : _nodes) {
+        if (node.feature != LeafFeature && node.firstCode == ThresholdSplit)
+            _featureNumeric[node.feature] = 1;
+    }
+}
+
+
+
+bool FlatTree::Empty() const {
+    return _nodes.empty();
+}
+
+size_t FlatTree::NodeCount() const {
+    return _nodes.size();
+}
+
+size_t FlatTree::FeatureCount() const {
+    return _featureColumns.size();
+}
+
+size_t FlatTree::ClassCount() const {
+    return _classes.Size();
+}
+
+size_t FlatTree::MemoryUsage() const {
+    // Узлы отображённой модели лежат в файле и в куче не учитываются
+    size_t total = _ownedNodes.capacity() * sizeof(FlatNode)
+        + _ownedChildTable.capacity() * sizeof(uint32_t)
+        + _featureColumns.capacity() * sizeof(size_t)
+        + _featureNumeric.capacity()
+        + _classes.MemoryUsage();
+    for (const auto& values : _featureValues) {
+        total += values.MemoryUsage();
+    }
+    return total;
+}
+
+
+
+bool FlatTree::IsMapped() const {
+    return _mapping != nullptr;
+}
+
+std::span<const FlatTree::FlatNode> FlatTree::GetNodes() const {
+    return _nodes;
+}
+
+std::span<const uint32_t> FlatTree::GetChildTable() const {
+    return _childTable;
+}
+
+const DTDictionary& FlatTree::GetFeatureValues(size_t feature) const {
+    if (feature >= _featureValues.size())
+        throw std::out_of_range("Индекс признака вне диапазона");
+    return _featureValues[feature];
+}
+
+size_t FlatTree::GetFeatureColumn(size_t feature) const {
+    if (feature >= _featureColumns.size())
+        throw std::out_of_range("Индекс признака вне диапазона");
+    return _featureColumns[feature];
+}
+
+bool FlatTree::IsFeatureNumeric(size_t feature) const {
+    if (feature >= _featureNumeric.size())
+        throw std::out_of_range("Индекс признака вне диапазона");
+    return _featureNumeric[feature] != 0;
+}
+
+const DTDictionary& FlatTree::GetClasses() const {
+    return _classes;
+}
+
+uint32_t FlatTree::GetUnknownClass() const {
+    return _unknownClass;
+}
+
+const std::string& FlatTree::GetClassLabel(uint32_t classId) const {
+    if (classId >= _classes.Size())
+        throw std::out_of_range("Индекс класса вне диапазона");
+    return _classes.GetValue(classId);
+}
+
+
+
+uint32_t FlatTree::PredictClass(const std::vector<std::string>& sample) const {
+    return PredictClassBy([&](uint32_t feature) {
+        return _featureValues[feature].Find(sample[feature]);
+    }, [&](uint32_t feature) {
+        float value;
+        return DTParseNumber(sample[feature], value) ? value : std::numeric_limits<float>::quiet_NaN();
+    });
+}
+
+void FlatTree::PrintNode(uint32_t index, const std::vector<std::string>& headers, int depth, bool isLastChild, const std::string& parentIndent) const {
+    const FlatNode& node = _nodes[index];
+    if (node.feature == LeafFeature) {
+        std::string currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
+        std::cout << currentIndent << "`-- Решение: \"" << "\033[1;32m\033[4m" << _classes.GetValue(node.offset) << "\033[0m\""
+            << "\n" << currentIndent << "\n";
+        return;
+    }
+
+    std::string currentIndent;
+    if (depth > 0) {
+        currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
+    }
+
+    size_t column = _featureColumns[node.feature];
+    std::cout << currentIndent << "|-- "
+        << "Признак: \"" << "\033[1;36m" << (column < headers.size() ? headers[column] : std::to_string(column)) << "\033[0m\"\n";
+
+    // Печать повторяет ThresholdNode::Print
+    if (node.firstCode == ThresholdSplit) {
+        const std::string threshold = DTFormatNumber(GetThreshold(node.offset));
+        for (uint32_t local = 0; local < 2; ++local) {
+            bool isLast = local == 1;
+            std::cout << currentIndent << (isLast ? "    " : "|   ")
+                << (isLast ? "`-- " : "|-- ") << "Значение: \"" << "\033[1;31m"
+                << (isLast ? "> " : "<= ") << threshold << "\033[0m\"" << "\n";
+
+            if (_childTable[node.offset + local] != NoChild)
+                PrintNode(_childTable[node.offset + local], headers, depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
+        }
+        return;
+    }
+
+    // Печать повторяет SubsetNode::Print, значения подмножества выводятся по возрастанию
+    if (node.firstCode == SubsetSplit) {
+        std::vector<std::string_view> values;
+        const uint32_t words = _childTable[node.offset + 2];
+        for (uint32_t code = 0; code < words * 32; ++code) {
+            if (SubsetBranch(code, node.offset) == 0)
+                values.push_back(_featureValues[node.feature].GetValue(code));
+        }
+        std::sort(values.begin(), values.end());
+
+        const std::string labels[2] = { SubsetNode::DescribeValues(values), "прочие" };
+        for (uint32_t local = 0; local < 2; ++local) {
+            bool isLast = local == 1;
+            std::cout << currentIndent << (isLast ? "    " : "|   ")
+                << (isLast ? "`-- " : "|-- ") << "Значение: \"" << "\033[1;31m" << labels[local] << "\033[0m\"" << "\n";
+
+            if (_childTable[node.offset + local] != NoChild)
+                PrintNode(_childTable[node.offset + local], headers, depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
+        }
+        return;
+    }
+
+    // Печать повторяет DecisionNode::Print, потомки идут в порядке кодов значений
+    std::vector<uint32_t> codes;
+    for (uint32_t local = 0; local < node.codeCount; ++local) {
+        if (_childTable[node.offset + local] != NoChild)
+            codes.push_back(local);
+    }
+
+    for (size_t i = 0; i < codes.size(); ++i) {
+        bool isLast = i == codes.size() - 1;
+        std::cout << currentIndent << (isLast ? "    " : "|   ")
+            << (isLast ? "`-- " : "|-- ") << "Значение: \"" << "\033[1;31m"
+            << _featureValues[node.feature].GetValue(node.firstCode + codes[i]) << "\033[0m\"" << "\n";
+
+        PrintNode(_childTable[node.offset + codes[i]], headers, depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
+    }
+}
+
+void FlatTree::Print(const std::vector<std::string>& headers) const {
+    if (!_nodes.empty())
+        PrintNode(0, headers, 0, false, "");
+}
+
+
+
+void FlatTree::Save(std::ostream& out, const std::vector<std::string>& headers, size_t targetColumn) const {
+    std::string metadata;
+    WriteU32(metadata, static_cast<uint32_t>(headers.size()));
+    for (const auto& header : headers) {
+        WriteString(metadata, header);
+    }
+    WriteU32(metadata, static_cast<uint32_t>(targetColumn));
+
+    WriteU32(metadata, static_cast<uint32_t>(_featureColumns.size()));
+    for (size_t feature = 0; feature < _featureColumns.size(); ++feature) {
+        WriteU32(metadata, static_cast<uint32_t>(_featureColumns[feature]));
+        const auto& values = _featureValues[feature].GetValues();
+        WriteU32(metadata, static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) {
+            WriteString(metadata, value);
+        }
+    }
+
+    const auto& classes = _classes.GetValues();
+    WriteU32(metadata, static_cast<uint32_t>(classes.size()));
+    for (const auto& label : classes) {
+        WriteString(metadata, label);
+    }
+    WriteU32(metadata, _unknownClass);
+
+    ModelHeader header{};
+    std::memcpy(header.magic, ModelMagic, sizeof(ModelMagic));
+    header.version = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.metadataOffset = AlignUp(sizeof(ModelHeader));
+    header.metadataSize = metadata.size();
+    header.nodesOffset = AlignUp(header.metadataOffset + header.metadataSize);
+    header.nodeCount = _nodes.size();
+    header.childrenOffset = AlignUp(header.nodesOffset + header.nodeCount * sizeof(FlatNode));
+    header.childCount = _childTable.size();
+
+    auto pad = [&](uint64_t from, uint64_t to) {
+        static const char zeros[SectionAlignment] = {};
+        out.write(zeros, static_cast<std::streamsize>(to - from));
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad(sizeof(header), header.metadataOffset);
+    out.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+    pad(header.metadataOffset + header.metadataSize, header.nodesOffset);
+    out.write(reinterpret_cast<const char*>(_nodes.data()), static_cast<std::streamsize>(_nodes.size_bytes()));
+    pad(header.nodesOffset + _nodes.size_bytes(), header.childrenOffset);
+    out.write(reinterpret_cast<const char*>(_childTable.data()), static_cast<std::streamsize>(_childTable.size_bytes()));
+}
+
+FlatTree FlatTree::Load(std::shared_ptr<const MappedFile> file, std::vector<std::string>& headers, size_t& targetColumn) {
+    const char* data = file->Data();
+    const size_t size = file->Size();
+
+    ModelHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Файл не является моделью дерева решений");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, ModelMagic, sizeof(ModelMagic)) != 0) {
+        throw std::runtime_error("Файл не является моделью дерева решений");
+    }
+    if (header.byteOrder != ByteOrderMark) {
+        throw std::runtime_error("Модель сохранена на платформе с другим порядком байтов");
+    }
+    // В версиях 2 и 3 порог хранился в 20-байтном узле: такие узлы переводятся в память процесса
+    const bool legacyNodes = header.version == 2 || header.version == 3;
+    if (header.version != FormatVersion && !legacyNodes) {
+        std::stringstream ss;
+        ss << "Неподдерживаемая версия модели: " << header.version << " (ожидалась " << FormatVersion << ")";
+        throw std::runtime_error(ss.str());
+    }
+
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!fits(header.metadataOffset, header.metadataSize, 1)
+        || !fits(header.nodesOffset, header.nodeCount, legacyNodes ? sizeof(LegacyFlatNode) : sizeof(FlatNode))
+        || !fits(header.childrenOffset, header.childCount, sizeof(uint32_t))
+        || header.nodesOffset % alignof(FlatNode) != 0
+        || header.childrenOffset % alignof(uint32_t) != 0) {
+        ThrowCorrupted("секции выходят за пределы файла");
+    }
+    if (header.nodeCount == 0) {
+        ThrowCorrupted("модель не содержит узлов");
+    }
+
+    // Строки (заголовки, значения признаков, классы) переносятся в словари,
+    // а узлы и таблица потомков остаются в отображённом файле
+    FlatTree tree;
+    MetadataReader reader(data + header.metadataOffset, data + header.metadataOffset + header.metadataSize);
+
+    headers.clear();
+    uint32_t headerCount = reader.ReadU32();
+    for (uint32_t i = 0; i < headerCount; ++i) {
+        headers.emplace_back(reader.ReadString());
+    }
+    targetColumn = reader.ReadU32();
+    if (targetColumn >= headerCount) {
+        ThrowCorrupted("неверный целевой столбец");
+    }
+
+    // Признаки индексируют пример без целевого столбца, поэтому их меньше, чем заголовков
+    uint32_t featureCount = reader.ReadU32();
+    if (featureCount >= headerCount) {
+        ThrowCorrupted("число признаков не соответствует заголовкам");
+    }
+    tree._featureValues.resize(featureCount);
+    for (uint32_t feature = 0; feature < featureCount; ++feature) {
+        tree._featureColumns.push_back(reader.ReadU32());
+        if (tree._featureColumns.back() >= headerCount || tree._featureColumns.back() == targetColumn) {
+            ThrowCorrupted("неверный столбец признака");
+        }
+        uint32_t valueCount = reader.ReadU32();
+        for (uint32_t i = 0; i < valueCount; ++i) {
+            tree._featureValues[feature].Intern(reader.ReadString());
+        }
+        if (tree._featureValues[feature].Size() != valueCount) {
+            ThrowCorrupted("повторяющиеся значения признака");
+        }
+    }
+
+    uint32_t classCount = reader.ReadU32();
+    for (uint32_t i = 0; i < classCount; ++i) {
+        tree._classes.Intern(reader.ReadString());
+    }
+    if (tree._classes.Size() != classCount) {
+        ThrowCorrupted("повторяющиеся метки классов");
+    }
+    tree._unknownClass = reader.ReadU32();
+
+    tree._childTable = std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(data + header.childrenOffset), header.childCount);
+    if (legacyNodes) {
+        tree.ConvertLegacyNodes(data + header.nodesOffset, header.nodeCount);
+    }
+    else {
+        tree._nodes = std::span<const FlatNode>(reinterpret_cast<const FlatNode*>(data + header.nodesOffset), header.nodeCount);
+        tree._mapping = std::move(file);
+    }
+
+    tree.Validate();
+    tree.IndexNumericFeatures();
+    return tree;
+}
+
+void FlatTree::ConvertLegacyNodes(const char* nodes, size_t nodeCount) {
+    // Ячейки каждого узла переносятся в новую таблицу потомков, а порог дописывается за ячейками
+    // потомков; номера узлов не меняются, поэтому ссылки на потомков остаются верными
+    const auto* legacy = reinterpret_cast<const LegacyFlatNode*>(nodes);
+    _ownedNodes.reserve(nodeCount);
+    _ownedChildTable.reserve(_childTable.size() + nodeCount);
+    for (size_t index = 0; index < nodeCount; ++index) {
+        const LegacyFlatNode& node = legacy[index];
+        if (node.feature == LeafFeature) {
+            _ownedNodes.push_back({ node.feature, node.firstCode, node.codeCount, node.offset });
+            continue;
+        }
+
+        uint64_t cells = node.codeCount;
+        if (node.firstCode == SubsetSplit && static_cast<uint64_t>(node.offset) + 3 <= _childTable.size())
+            cells = 3 + static_cast<uint64_t>(_childTable[node.offset + 2]);
+        if (static_cast<uint64_t>(node.offset) + cells > _childTable.size())
+            ThrowCorrupted("неверный узел " + std::to_string(index));
+
+        uint32_t offset = static_cast<uint32_t>(_ownedChildTable.size());
+        _ownedChildTable.insert(_ownedChildTable.end(), _childTable.begin() + node.offset, _childTable.begin() + node.offset + cells);
+        if (node.firstCode == ThresholdSplit)
+            _ownedChildTable.push_back(std::bit_cast<uint32_t>(node.threshold));
+        _ownedNodes.push_back({ node.feature, node.firstCode, node.codeCount, offset });
+    }
+    BindOwned();
+}
+
+void FlatTree::Validate() const {
+    if (_unknownClass >= _classes.Size()) {
+        ThrowCorrupted("неверный класс для неизвестных значений");
+    }
+
+    // Потомки всегда лежат дальше родителя (обход в ширину), это исключает циклы при спуске
+    for (size_t index = 0; index < _nodes.size(); ++index) {
+        const FlatNode& node = _nodes[index];
+        if (node.feature == LeafFeature) {
+            if (node.offset >= _classes.Size())
+                ThrowCorrupted("неверный класс в листе");
+            continue;
+        }
+
+        const bool threshold = node.firstCode == ThresholdSplit;
+        const bool subset = node.firstCode == SubsetSplit;
+        if (node.feature >= _featureValues.size()
+            || static_cast<uint64_t>(node.offset) + node.codeCount > _childTable.size()
+            || ((threshold || subset) && node.codeCount != 2)
+            || (!threshold && !subset && static_cast<uint64_t>(node.firstCode) + node.codeCount > _featureValues[node.feature].Size())) {
+            ThrowCorrupted("неверный узел " + std::to_string(index));
+        }
+
+        if (threshold && static_cast<uint64_t>(node.offset) + 3 > _childTable.size()) {
+            ThrowCorrupted("неверный порог в узле " + std::to_string(index));
+        }
+
+        // Битовое множество подмножества должно помещаться в таблицу и не выходить за словарь признака
+        if (subset) {
+            if (static_cast<uint64_t>(node.offset) + 3 > _childTable.size())
+                ThrowCorrupted("неверное подмножество в узле " + std::to_string(index));
+            const uint64_t words = _childTable[node.offset + 2];
+            const uint64_t valueCount = _featureValues[node.feature].Size();
+            if (static_cast<uint64_t>(node.offset) + 3 + words > _childTable.size() || words > (valueCount + 31) / 32)
+                ThrowCorrupted("неверное подмножество в узле " + std::to_string(index));
+            for (uint64_t code = valueCount; code < words * 32; ++code) {
+                if (SubsetBranch(static_cast<uint32_t>(code), node.offset) == 0)
+                    ThrowCorrupted("неверное подмножество в узле " + std::to_string(index));
+            }
+        }
+
+        for (uint32_t local = 0; local < node.codeCount; ++local) {
+            uint32_t child = _childTable[node.offset + local];
+            if (child != NoChild && (child <= index || child >= _nodes.size()))
+                ThrowCorrupted("неверная ссылка на потомка в узле " + std::to_string(index));
+        }
+    }
+}
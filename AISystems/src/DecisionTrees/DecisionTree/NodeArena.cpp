@@ -0,0 +1,70 @@
+#include <../include/DecisionTrees/DecisionTree/NodeArena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+// Узлы, их строки и таблицы потомков выделяются последовательно из крупных блоков.
+// Освобождение отдельных выделений не выполняется: вся память дерева возвращается
+// разом вместе с блоками, деструкторы узлов при этом не вызываются - всё, чем узлы
+// владеют, тоже лежит в арене
+
+std::byte* NodeArena::AllocateBlock(size_t size) {
+    _blocks.emplace_back(new std::byte[size]);
+    _reservedBytes += size;
+    return _blocks.back().get();
+}
+
+void* NodeArena::do_allocate(size_t bytes, size_t alignment) {
+    // Узлы дерева при параллельном обучении создаются из разных потоков
+    std::lock_guard<std::mutex> lock(_mutex);
+    _usedBytes += bytes;
+
+    // Крупное выделение получает собственный блок, текущий блок продолжает заполняться
+    if (bytes + alignment > _nextBlockSize) {
+        std::byte* block = AllocateBlock(bytes + alignment);
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(block) % alignment) % alignment;
+        return block + padding;
+    }
+
+    size_t padding = _current == nullptr ? 0 : (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) % alignment;
+    if (_current == nullptr || padding + bytes > _remaining) {
+        // Блоки растут вдвое до предела: мелкие деревья не занимают лишнего,
+        // крупные обходятся небольшим числом блоков
+        _current = AllocateBlock(_nextBlockSize);
+        _remaining = _nextBlockSize;
+        _nextBlockSize = std::min(_nextBlockSize * 2, MaxBlockSize);
+        padding = (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) % alignment;
+    }
+
+    std::byte* result = _current + padding;
+    _current += padding + bytes;
+    _remaining -= padding + bytes;
+    return result;
+}
+
+void NodeArena::do_deallocate(void*, size_t, size_t) {
+}
+
+bool NodeArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void NodeArena::SetRoot(const Node* root) {
+    _root = root;
+}
+
+const Node* NodeArena::GetRoot() const {
+    return _root;
+}
+
+size_t NodeArena::BlockCount() const {
+    return _blocks.size();
+}
+
+size_t NodeArena::UsedBytes() const {
+    return _usedBytes;
+}
+
+size_t NodeArena::MemoryUsage() const {
+    return _reservedBytes + _blocks.capacity() * sizeof(std::unique_ptr<std::byte[]>);
+}
@@ -1,20 +1,43 @@
 #include <../include/DecisionTrees/DecisionTree/Nodes/DecisionNode.h>
 
-void DecisionNode::AddChild(const std::string& value, std::unique_ptr<Node> child) {
-    _children[value] = std::move(child);
+#include <algorithm>
+
+void DecisionNode::ReserveChildren(size_t count) {
+    _children.reserve(count);
+}
+
+void DecisionNode::AddChild(std::string_view value, const Node* child) {
+    // Ветви хранятся по возрастанию значения; построители добавляют их уже
+    // упорядоченными, поэтому вставка обычно идёт в конец
+    auto it = std::lower_bound(_children.begin(), _children.end(), value,
+        [](const Child& a, std::string_view b) { return std::string_view(a.first) < b; });
+    if (it != _children.end() && std::string_view(it->first) == value)
+        it->second = child;
+    else
+        _children.emplace(it, value, child);
+}
+
+std::string_view DecisionNode::GetFeatureName() const {
+    return _featureName;
+}
+
+const std::pmr::vector<DecisionNode::Child>& DecisionNode::GetChildren() const {
+    return _children;
 }
 
 std::string DecisionNode::Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const {
-    auto it = std::find(headers.begin(), headers.end(), _featureName);
-    if (it == headers.end()) return "()";
+    auto it = std::find(headers.begin(), headers.end(), GetFeatureName());
+    if (it == headers.end()) return "(неизвестно)";
     size_t featureIndex = it - headers.begin();
 
     if (featureIndex >= sample.size())
-        return "()";
+        return "(неизвестно)";
 
-    auto childIt = _children.find(sample[featureIndex]);
-    if (childIt == _children.end())
-        return "()";
+    std::string_view value = sample[featureIndex];
+    auto childIt = std::lower_bound(_children.begin(), _children.end(), value,
+        [](const Child& a, std::string_view b) { return std::string_view(a.first) < b; });
+    if (childIt == _children.end() || std::string_view(childIt->first) != value)
+        return "(неизвестно)";
 
     return childIt->second->Predict(sample, headers);
 }
@@ -22,26 +45,26 @@ std::string DecisionNode::Predict(const std::vector<std::string>& sample, const
 void DecisionNode::Print(int depth, bool isLastChild, const std::string& parentIndent) const {
     std::string currentIndent;
 
-    //     
+    // Формируем отступ для текущего узла
     if (depth > 0) {
         currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
     }
 
-    //   
+    // Вывод текущего узла
     std::cout << currentIndent << (depth == 0 ? "|-- " : "|-- ")
-        << ": \"" << "\033[1;36m" << _featureName << "\033[0m\"\n";
+        << "Признак: \"" << "\033[1;36m" << _featureName << "\033[0m\"\n";
 
-    //   
+    // Обработка дочерних элементов
     size_t childIndex = 0;
     for (const auto& pair : _children) {
         bool isLast = (childIndex == _children.size() - 1);
         std::string childConnector = isLast ? "`-- " : "|-- ";
 
-        //  
+        // Вывод значения
         std::cout << currentIndent << (isLast ? "    " : "|   ")
-            << childConnector << ": \"" << "\033[1;31m" << pair.first << "\033[0m\"" << "\n";
+            << childConnector << "Значение: \"" << "\033[1;31m" << pair.first << "\033[0m\"" << "\n";
 
-        //     
+        // Рекурсивный вызов для дочернего узла
         pair.second->Print(depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
         childIndex++;
     }
@@ -1,11 +1,15 @@
 #include <../include/DecisionTrees/DecisionTree/Nodes/LeafNode.h>
 
-std::string LeafNode::Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const {
+std::string_view LeafNode::GetResult() const {
     return _result;
 }
 
+std::string LeafNode::Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const {
+    return std::string(_result);
+}
+
 void LeafNode::Print(int depth, bool isLastChild, const std::string& parentIndent) const {
     std::string currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
-    std::cout << currentIndent << "`-- : \"" << "\033[1;32m\033[4m" << _result << "\033[0m\""
+    std::cout << currentIndent << "`-- Решение: \"" << "\033[1;32m\033[4m" << _result << "\033[0m\""
         << "\n" << currentIndent << "\n";
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <../include/DecisionTrees/DecisionTree/Nodes/SubsetNode.h>
+
+#include <algorithm>
+
+void SubsetNode::ReserveValues(size_t count) {
+    _values.reserve(count);
+}
+
+void SubsetNode::AddValue(std::string_view value) {
+    // Значения хранятся по возрастанию, проверка принадлежности - двоичный поиск
+    auto it = std::lower_bound(_values.begin(), _values.end(), value,
+        [](const std::pmr::string& a, std::string_view b) { return std::string_view(a) < b; });
+    if (it == _values.end() || std::string_view(*it) != value)
+        _values.emplace(it, value);
+}
+
+void SubsetNode::SetChildren(const Node* inSubset, const Node* other) {
+    _inSubset = inSubset;
+    _other = other;
+}
+
+std::string_view SubsetNode::GetFeatureName() const {
+    return _featureName;
+}
+
+const std::pmr::vector<std::pmr::string>& SubsetNode::GetValues() const {
+    return _values;
+}
+
+bool SubsetNode::Contains(std::string_view value) const {
+    auto it = std::lower_bound(_values.begin(), _values.end(), value,
+        [](const std::pmr::string& a, std::string_view b) { return std::string_view(a) < b; });
+    return it != _values.end() && std::string_view(*it) == value;
+}
+
+const Node* SubsetNode::GetInSubset() const {
+    return _inSubset;
+}
+
+const Node* SubsetNode::GetOther() const {
+    return _other;
+}
+
+std::string SubsetNode::Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const {
+    auto it = std::find(headers.begin(), headers.end(), GetFeatureName());
+    if (it == headers.end()) return "(неизвестно)";
+    size_t featureIndex = it - headers.begin();
+
+    if (featureIndex >= sample.size())
+        return "(неизвестно)";
+
+    // Значения вне подмножества, в том числе не встречавшиеся при обучении, уходят в ветвь "прочие"
+    const Node* child = Contains(sample[featureIndex]) ? _inSubset : _other;
+    if (!child)
+        return "(неизвестно)";
+
+    return child->Predict(sample, headers);
+}
+
+std::string SubsetNode::DescribeValues(const std::vector<std::string_view>& values) {
+    // Для признаков с тысячами значений печатается только начало подмножества
+    std::string label = "из {";
+    for (size_t i = 0; i < values.size() && i < PrintedValues; ++i) {
+        if (i != 0)
+            label += ", ";
+        label += values[i];
+    }
+    if (values.size() > PrintedValues)
+        label += ", ... ещё " + std::to_string(values.size() - PrintedValues);
+    label += "}";
+    return label;
+}
+
+void SubsetNode::Print(int depth, bool isLastChild, const std::string& parentIndent) const {
+    std::string currentIndent;
+
+    // Формируем отступ для текущего узла
+    if (depth > 0) {
+        currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
+    }
+
+    // Вывод текущего узла
+    std::cout << currentIndent << "|-- "
+        << "Признак: \"" << "\033[1;36m" << _featureName << "\033[0m\"\n";
+
+    // Две ветви: значения из подмножества и все прочие
+    const std::vector<std::string_view> values(_values.begin(), _values.end());
+    const Node* children[2] = { _inSubset, _other };
+    const std::string labels[2] = { DescribeValues(values), "прочие" };
+    for (size_t i = 0; i < 2; ++i) {
+        bool isLast = (i == 1);
+        std::string childConnector = isLast ? "`-- " : "|-- ";
+
+        std::cout << currentIndent << (isLast ? "    " : "|   ")
+            << childConnector << "Значение: \"" << "\033[1;31m" << labels[i] << "\033[0m\"" << "\n";
+
+        if (children[i])
+            children[i]->Print(depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
+    }
+}
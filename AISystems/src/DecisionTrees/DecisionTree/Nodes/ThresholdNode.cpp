@@ -0,0 +1,70 @@
+#include <../include/DecisionTrees/DecisionTree/Nodes/ThresholdNode.h>
+#include <../include/DecisionTrees/DTColumn.h>
+
+#include <algorithm>
+
+void ThresholdNode::SetChildren(const Node* lessOrEqual, const Node* greater) {
+    _lessOrEqual = lessOrEqual;
+    _greater = greater;
+}
+
+std::string_view ThresholdNode::GetFeatureName() const {
+    return _featureName;
+}
+
+float ThresholdNode::GetThreshold() const {
+    return _threshold;
+}
+
+const Node* ThresholdNode::GetLessOrEqual() const {
+    return _lessOrEqual;
+}
+
+const Node* ThresholdNode::GetGreater() const {
+    return _greater;
+}
+
+std::string ThresholdNode::Predict(const std::vector<std::string>& sample, const std::vector<std::string>& headers) const {
+    auto it = std::find(headers.begin(), headers.end(), GetFeatureName());
+    if (it == headers.end()) return "(неизвестно)";
+    size_t featureIndex = it - headers.begin();
+
+    // Нечисловое значение не относится ни к одной из ветвей
+    float value;
+    if (featureIndex >= sample.size() || !DTParseNumber(sample[featureIndex], value))
+        return "(неизвестно)";
+
+    const Node* child = value <= _threshold ? _lessOrEqual : _greater;
+    if (!child)
+        return "(неизвестно)";
+
+    return child->Predict(sample, headers);
+}
+
+void ThresholdNode::Print(int depth, bool isLastChild, const std::string& parentIndent) const {
+    std::string currentIndent;
+
+    // Формируем отступ для текущего узла
+    if (depth > 0) {
+        currentIndent = parentIndent + (isLastChild ? "    " : "|   ");
+    }
+
+    // Вывод текущего узла
+    std::cout << currentIndent << "|-- "
+        << "Признак: \"" << "\033[1;36m" << _featureName << "\033[0m\"\n";
+
+    // Две ветви: значения не больше порога и больше порога
+    const std::string threshold = DTFormatNumber(_threshold);
+    const Node* children[2] = { _lessOrEqual, _greater };
+    const std::string labels[2] = { "<= " + threshold, "> " + threshold };
+    for (size_t i = 0; i < 2; ++i) {
+        bool isLast = (i == 1);
+        std::string childConnector = isLast ? "`-- " : "|-- ";
+
+        std::cout << currentIndent << (isLast ? "    " : "|   ")
+            << childConnector << "Значение: \"" << "\033[1;31m" << labels[i] << "\033[0m\"" << "\n";
+
+        if (children[i])
+            children[i]->Print(depth + 1, isLast, currentIndent + (isLast ? "    " : "|   "));
+    }
+}
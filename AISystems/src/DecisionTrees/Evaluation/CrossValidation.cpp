@@ -0,0 +1,317 @@
+#include <../include/DecisionTrees/Evaluation/CrossValidation.h>
+#include <../include/DecisionTrees/BuildAlgorithms/TreePruner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+static double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void CrossValidation::CheckOptions(const DTDataset& dataset, const Options& options) {
+    if (dataset.RowCount() == 0)
+        throw std::invalid_argument("Набор данных пуст");
+    if (dataset.RowCount() > std::numeric_limits<uint32_t>::max())
+        throw std::length_error("Слишком много строк для перекрёстной проверки");
+    if (options.folds < 2)
+        throw std::invalid_argument("Число блоков перекрёстной проверки должно быть не меньше двух");
+    if (options.folds > dataset.RowCount())
+        throw std::invalid_argument("Число блоков перекрёстной проверки больше числа строк набора");
+}
+
+
+
+std::vector<std::vector<uint32_t>> CrossValidation::MakeFolds(const DTDataset& dataset, const Options& options) {
+    CheckOptions(dataset, options);
+    const size_t numRows = dataset.RowCount();
+    std::vector<std::vector<uint32_t>> folds(options.folds);
+
+    // Без перемешивания и стратификации блоки - последовательные отрезки строк
+    if (!options.shuffle && !options.stratified) {
+        for (size_t fold = 0; fold < options.folds; ++fold) {
+            const size_t first = fold * numRows / options.folds;
+            const size_t last = (fold + 1) * numRows / options.folds;
+            folds[fold].resize(last - first);
+            std::iota(folds[fold].begin(), folds[fold].end(), static_cast<uint32_t>(first));
+        }
+        return folds;
+    }
+
+    // Блоки - наборы индексов строк, данные не копируются. Строки раздаются по блокам
+    // по очереди; при стратификации - внутри каждого класса со сквозным счётчиком,
+    // поэтому доли классов в блоках совпадают, а размеры блоков отличаются не больше чем на одну строку
+    std::vector<std::vector<uint32_t>> groups;
+    if (options.stratified) {
+        const DTColumn& target = dataset.GetColumn(dataset.GetTargetColumn());
+        groups.resize(target.Cardinality());
+        target.VisitCodes([&](const auto* codes) {
+            for (size_t row = 0; row < numRows; ++row) {
+                groups[codes[row]].push_back(static_cast<uint32_t>(row));
+            }
+        });
+    }
+    else {
+        groups.emplace_back(numRows);
+        std::iota(groups[0].begin(), groups[0].end(), 0u);
+    }
+
+    std::mt19937_64 random(options.seed);
+    size_t next = 0;
+    for (auto& group : groups) {
+        if (options.shuffle)
+            std::shuffle(group.begin(), group.end(), random);
+        for (uint32_t row : group) {
+            folds[next].push_back(row);
+            next = (next + 1) % options.folds;
+        }
+    }
+
+    // Строки блока идут по возрастанию: обход столбцов при обучении и предсказании последовательный
+    for (auto& fold : folds) {
+        std::sort(fold.begin(), fold.end());
+    }
+    return folds;
+}
+
+std::vector<uint32_t> CrossValidation::MakeHoldout(const DTDataset& dataset, double testFraction, const Options& options) {
+    if (!(testFraction > 0.0 && testFraction < 1.0))
+        throw std::invalid_argument("Доля отложенных строк должна быть между 0 и 1");
+
+    // Строки (внутри классов при стратификации) отбираются равномерно по порядку обхода,
+    // так что доля каждого класса в отложенной части сохраняется
+    Options split = options;
+    split.folds = 2;
+    CheckOptions(dataset, split);
+    const DTColumn& target = dataset.GetColumn(dataset.GetTargetColumn());
+    std::vector<std::vector<uint32_t>> groups(options.stratified ? target.Cardinality() : 1);
+    for (uint32_t row = 0; row < dataset.RowCount(); ++row) {
+        groups[options.stratified ? target.GetCode(row) : 0].push_back(row);
+    }
+
+    std::mt19937_64 random(options.seed);
+    std::vector<uint32_t> test;
+    size_t index = 0;
+    for (auto& group : groups) {
+        if (options.shuffle)
+            std::shuffle(group.begin(), group.end(), random);
+        for (uint32_t row : group) {
+            if (static_cast<size_t>((index + 1) * testFraction) > static_cast<size_t>(index * testFraction))
+                test.push_back(row);
+            index++;
+        }
+    }
+    if (test.empty() || test.size() == dataset.RowCount())
+        throw std::invalid_argument("Отложенная или обучающая часть пуста: слишком мало строк для такой доли");
+
+    std::sort(test.begin(), test.end());
+    return test;
+}
+
+
+
+DTDatasetView CrossValidation::MakeTrainingView(const DTDataset& dataset, const std::vector<uint32_t>& testRows) {
+    // Обучающие строки - дополнение отложенного блока; модель строится на представлении
+    // поверх общего набора, копий данных нет
+    const size_t numRows = dataset.RowCount();
+    std::vector<bool> isTest(numRows, false);
+    for (uint32_t row : testRows) {
+        isTest[row] = true;
+    }
+    std::vector<uint32_t> trainRows;
+    trainRows.reserve(numRows - testRows.size());
+    for (uint32_t row = 0; row < numRows; ++row) {
+        if (!isTest[row])
+            trainRows.push_back(row);
+    }
+    return DTDatasetView(dataset, std::move(trainRows));
+}
+
+CrossValidation::FoldResult CrossValidation::EvaluateFold
+(
+    const DTDatasetView& training,
+    const std::vector<uint32_t>& testRows,
+    const Options& options,
+    WorkStealingPool* pool,
+    const DTFeatureBins* bins
+) {
+    const DTDataset& dataset = training.GetDataset();
+    Clock::time_point start = Clock::now();
+
+    FoldResult fold;
+    fold.trainRows = training.RowCount();
+    fold.testRows = testRows.size();
+
+    // Обучение переставляет строки представления, поэтому идёт на копии: training остаётся
+    // нетронутым для следующих испытаний. Обрезке упорядоченные списки не нужны
+    const ID3::Options& treeOptions = options.treeOptions;
+    DTDatasetView view = training.Clone();
+    DecisionTree tree = ID3::TrainView(view, treeOptions, pool, bins);
+    if (treeOptions.validation != nullptr || treeOptions.maxLeaves != 0) {
+        std::span<const uint32_t> rows = training.GetRows();
+        DTDatasetView pruningView(dataset, std::vector<uint32_t>(rows.begin(), rows.end()));
+        tree = TreePruner::Prune(tree, pruningView, { treeOptions.validation, treeOptions.maxLeaves });
+    }
+    fold.nodes = tree.GetFlatTree().NodeCount();
+    fold.trainSeconds = SecondsSince(start);
+
+    // Отложенный блок предсказывается пакетно по индексам строк
+    start = Clock::now();
+    std::vector<uint32_t> predicted(testRows.size());
+    DecisionTree::PredictOptions predictOptions;
+    predictOptions.pool = pool;
+    tree.PredictBatch(dataset, testRows, predicted, predictOptions);
+
+    // Классы дерева переводятся в коды целевого столбца; ответы вне них - отдельный столбец "неизвестно"
+    const DTColumn& target = dataset.GetColumn(dataset.GetTargetColumn());
+    const size_t numClasses = target.Cardinality();
+    const auto& treeClasses = tree.GetFlatTree().GetClasses().GetValues();
+    std::vector<uint32_t> mapping(treeClasses.size());
+    for (size_t c = 0; c < treeClasses.size(); ++c) {
+        uint32_t code = target.GetDictionary().Find(treeClasses[c]);
+        mapping[c] = code == DTDictionary::NoCode ? static_cast<uint32_t>(numClasses) : code;
+    }
+
+    fold.confusion.assign(numClasses * (numClasses + 1), 0);
+    for (size_t i = 0; i < testRows.size(); ++i) {
+        const uint32_t actual = target.GetCode(testRows[i]);
+        const uint32_t guess = mapping[predicted[i]];
+        fold.confusion[actual * (numClasses + 1) + guess]++;
+        if (actual == guess)
+            fold.correct++;
+    }
+    fold.accuracy = static_cast<double>(fold.correct) / fold.testRows;
+    fold.predictSeconds = SecondsSince(start);
+    return fold;
+}
+
+
+
+CrossValidation::Result CrossValidation::Evaluate(const DTDataset& dataset) {
+    return Evaluate(dataset, Options());
+}
+
+CrossValidation::Result CrossValidation::Evaluate(const DTDataset& dataset, const Options& options) {
+    return Evaluate(dataset, MakeFolds(dataset, options), options);
+}
+
+CrossValidation::Result CrossValidation::Holdout(const DTDataset& dataset, double testFraction, const Options& options) {
+    return Evaluate(dataset, { MakeHoldout(dataset, testFraction, options) }, options);
+}
+
+CrossValidation::Result CrossValidation::Evaluate
+(
+    const DTDataset& dataset,
+    const std::vector<std::vector<uint32_t>>& testSets,
+    const Options& options
+) {
+    if (testSets.empty())
+        throw std::invalid_argument("Не задано ни одного отложенного блока");
+    for (const auto& testRows : testSets) {
+        if (testRows.empty() || testRows.size() >= dataset.RowCount())
+            throw std::invalid_argument("Отложенный блок не должен быть пустым или занимать весь набор");
+        for (uint32_t row : testRows) {
+            if (row >= dataset.RowCount())
+                throw std::out_of_range("Индекс строки выходит за пределы набора данных");
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool);
+
+    // Модели блоков обучаются одновременно, описание построения и профиль не ведутся
+    Options local = options;
+    local.treeOptions.traceLevel = TraceLevel::Off;
+    local.treeOptions.traceSink = nullptr;
+    local.treeOptions.profile = nullptr;
+
+    // Корзины режима гистограмм строятся один раз и общие для всех блоков
+    std::unique_ptr<DTFeatureBins> ownBins;
+    const DTFeatureBins* bins = ID3::ResolveFeatureBins(dataset, local.treeOptions, pool, ownBins);
+
+    Result result;
+    result.folds.resize(testSets.size());
+    auto runFold = [&](size_t fold) {
+        result.folds[fold] = EvaluateFold(MakeTrainingView(dataset, testSets[fold]), testSets[fold], local, pool, bins);
+    };
+    if (pool != nullptr && testSets.size() > 1) {
+        pool->ParallelFor(testSets.size(), runFold);
+    }
+    else {
+        for (size_t fold = 0; fold < testSets.size(); ++fold) {
+            runFold(fold);
+        }
+    }
+
+    // Сводка: общая точность по всем отложенным строкам, среднее и разброс по блокам
+    result.classes = dataset.GetColumn(dataset.GetTargetColumn()).GetDictionary().GetValues();
+    result.classes.push_back("(неизвестно)");
+    result.confusion.assign(result.classes.size() * (result.classes.size() - 1), 0);
+    for (const FoldResult& fold : result.folds) {
+        for (size_t i = 0; i < fold.confusion.size(); ++i) {
+            result.confusion[i] += fold.confusion[i];
+        }
+        result.testRows += fold.testRows;
+        result.correct += fold.correct;
+        result.meanAccuracy += fold.accuracy;
+    }
+    result.accuracy = static_cast<double>(result.correct) / result.testRows;
+    result.meanAccuracy /= result.folds.size();
+    for (const FoldResult& fold : result.folds) {
+        result.stdAccuracy += (fold.accuracy - result.meanAccuracy) * (fold.accuracy - result.meanAccuracy);
+    }
+    result.stdAccuracy = std::sqrt(result.stdAccuracy / result.folds.size());
+    result.seconds = SecondsSince(start);
+    return result;
+}
+
+
+
+void CrossValidation::PrintResult(const Result& result) {
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << "\nПерекрёстная проверка: блоков " << result.folds.size()
+        << ", отложенных строк " << result.testRows << ", время " << result.seconds << " с\n";
+    std::cout << "Блок | Обучение | Проверка | Узлов | Точность | Обучение, с | Предсказание, с\n";
+    for (size_t i = 0; i < result.folds.size(); ++i) {
+        const FoldResult& fold = result.folds[i];
+        std::cout << std::setw(4) << i + 1 << " | " << std::setw(8) << fold.trainRows << " | " << std::setw(8) << fold.testRows
+            << " | " << std::setw(5) << fold.nodes << " | " << std::setw(8) << std::fixed << std::setprecision(4) << fold.accuracy
+            << " | " << std::setw(11) << fold.trainSeconds << " | " << std::setw(15) << fold.predictSeconds << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::cout << "Точность: " << result.accuracy << " (по блокам " << result.meanAccuracy << " +- " << result.stdAccuracy << ")\n";
+
+    // Матрица ошибок: строки - истинный класс, столбцы - предсказанный
+    const size_t numClasses = result.classes.size() - 1;
+    std::cout << "\nМатрица ошибок (строки - истинный класс, столбцы - предсказанный):\n";
+    size_t width = 8;
+    for (const auto& label : result.classes) {
+        width = std::max(width, label.size() + 1);
+    }
+    std::cout << std::setw(static_cast<int>(width)) << "";
+    for (const auto& label : result.classes) {
+        std::cout << std::setw(static_cast<int>(width)) << label;
+    }
+    std::cout << "\n";
+    for (size_t actual = 0; actual < numClasses; ++actual) {
+        std::cout << std::setw(static_cast<int>(width)) << result.classes[actual];
+        for (size_t guess = 0; guess <= numClasses; ++guess) {
+            std::cout << std::setw(static_cast<int>(width)) << result.confusion[actual * (numClasses + 1) + guess];
+        }
+        std::cout << "\n";
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
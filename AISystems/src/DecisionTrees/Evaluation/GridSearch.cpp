@@ -0,0 +1,214 @@
+#include <../include/DecisionTrees/Evaluation/GridSearch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<ID3::Options> GridSearch::ExpandGrid(const Grid& grid, const ID3::Options& base) {
+    if (grid.maxDepth.empty() || grid.minSamplesSplit.empty() || grid.minGain.empty() || grid.featureSubset.empty() ||
+        grid.criterion.empty() || grid.categoricalSplit.empty())
+        throw std::invalid_argument("Каждое измерение сетки должно содержать хотя бы одно значение");
+
+    // Декартово произведение значений всех измерений; остальные параметры берутся из базовых настроек
+    std::vector<ID3::Options> configurations;
+    for (size_t maxDepth : grid.maxDepth) {
+        for (size_t minSamplesSplit : grid.minSamplesSplit) {
+            for (double minGain : grid.minGain) {
+                for (size_t featureSubset : grid.featureSubset) {
+                    for (SplitCriterion criterion : grid.criterion) {
+                        for (ID3::CategoricalSplit categoricalSplit : grid.categoricalSplit) {
+                            ID3::Options options = base;
+                            options.maxDepth = maxDepth;
+                            options.minSamplesSplit = minSamplesSplit;
+                            options.minGain = minGain;
+                            options.featureSubset = featureSubset;
+                            options.criterion = criterion;
+                            options.categoricalSplit = categoricalSplit;
+                            configurations.push_back(options);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return configurations;
+}
+
+void GridSearch::Summarize(Trial& trial) {
+    trial.meanAccuracy = 0.0;
+    trial.stdAccuracy = 0.0;
+    trial.meanNodes = 0.0;
+    if (trial.folds.empty())
+        return;
+    for (const auto& fold : trial.folds) {
+        trial.meanAccuracy += fold.accuracy;
+        trial.meanNodes += static_cast<double>(fold.nodes);
+    }
+    trial.meanAccuracy /= trial.folds.size();
+    trial.meanNodes /= trial.folds.size();
+    for (const auto& fold : trial.folds) {
+        trial.stdAccuracy += (fold.accuracy - trial.meanAccuracy) * (fold.accuracy - trial.meanAccuracy);
+    }
+    trial.stdAccuracy = std::sqrt(trial.stdAccuracy / trial.folds.size());
+}
+
+std::string GridSearch::Describe(const ID3::Options& options) {
+    static const char* criteria[] = { "прирост", "отношение прироста", "Джини", "хи-квадрат" };
+    std::ostringstream ss;
+    ss << criteria[static_cast<size_t>(options.criterion)]
+        << (options.categoricalSplit == ID3::CategoricalSplit::Binary ? ", двоичные разбиения" : "") << ", глубина " << options.maxDepth << ", мин. строк " << options.minSamplesSplit
+        << ", мин. прирост " << options.minGain << ", признаков " << options.featureSubset;
+    return ss.str();
+}
+
+
+
+GridSearch::Result GridSearch::Search(const DTDataset& dataset, const Grid& grid) {
+    return Search(dataset, grid, Options());
+}
+
+GridSearch::Result GridSearch::Search(const DTDataset& dataset, const Grid& grid, const Options& options) {
+    return Search(dataset, ExpandGrid(grid, options.validation.treeOptions), options);
+}
+
+GridSearch::Result GridSearch::Search(const DTDataset& dataset, const std::vector<ID3::Options>& configurations, const Options& options) {
+    if (configurations.empty())
+        throw std::invalid_argument("Не задано ни одной конфигурации для перебора");
+    if (options.minFolds == 0)
+        throw std::invalid_argument("Минимальное число блоков до досрочной остановки должно быть положительным");
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Блоки строятся один раз: все испытания оцениваются на одних и тех же строках
+    const CrossValidation::Options& validation = options.validation;
+    std::vector<std::vector<uint32_t>> folds = CrossValidation::MakeFolds(dataset, validation);
+
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(validation.pool, validation.threads, ownPool);
+
+    // Набор не изменяется, корзины гистограмм строятся один раз на каждое различное число корзин
+    // и делятся между всеми испытаниями; описание построения и профиль не ведутся
+    Result result;
+    result.trials.resize(configurations.size());
+    std::vector<CrossValidation::Options> trialOptions(configurations.size(), validation);
+    std::vector<const DTFeatureBins*> trialBins(configurations.size(), nullptr);
+    std::map<size_t, std::unique_ptr<DTFeatureBins>> ownBins;
+    std::map<size_t, const DTFeatureBins*> sharedBins;
+    for (size_t t = 0; t < configurations.size(); ++t) {
+        ID3::Options& treeOptions = trialOptions[t].treeOptions;
+        treeOptions = configurations[t];
+        treeOptions.traceLevel = TraceLevel::Off;
+        treeOptions.traceSink = nullptr;
+        treeOptions.profile = nullptr;
+        result.trials[t].treeOptions = treeOptions;
+        result.trials[t].folds.reserve(folds.size());
+
+        if (treeOptions.splitSearch == ID3::SplitSearch::Histogram) {
+            auto found = sharedBins.find(treeOptions.histogramBins);
+            if (found == sharedBins.end())
+                found = sharedBins.emplace(treeOptions.histogramBins, ID3::ResolveFeatureBins(dataset, treeOptions, pool, ownBins[treeOptions.histogramBins])).first;
+            trialBins[t] = found->second;
+        }
+    }
+
+    // Блоки обходятся раундами: в раунде все оставшиеся испытания обучаются на очередном блоке одновременно.
+    // После раунда испытания, чья средняя точность хуже лучшей больше чем на допуск, снимаются -
+    // оставшиеся блоки для них не считаются. Решение принимается по завершённым раундам, поэтому
+    // набор снятых испытаний не зависит от порядка выполнения задач
+    std::vector<size_t> alive(configurations.size());
+    for (size_t t = 0; t < alive.size(); ++t) {
+        alive[t] = t;
+    }
+    std::vector<CrossValidation::FoldResult> round;
+    for (size_t fold = 0; fold < folds.size(); ++fold) {
+        // Обучающие строки блока упорядочиваются по числовым признакам один раз на раунд:
+        // испытания точного режима получают копии готовых списков вместо своей сортировки
+        DTDatasetView training = CrossValidation::MakeTrainingView(dataset, folds[fold]);
+        std::optional<DTDatasetView> presorted;
+        for (size_t t : alive) {
+            if (trialBins[t] == nullptr) {
+                presorted = training.Clone();
+                presorted->PresortNumericFeatures();
+                break;
+            }
+        }
+
+        round.assign(alive.size(), CrossValidation::FoldResult());
+        auto runTrial = [&](size_t i) {
+            size_t t = alive[i];
+            const DTDatasetView& view = trialBins[t] == nullptr ? *presorted : training;
+            round[i] = CrossValidation::EvaluateFold(view, folds[fold], trialOptions[t], pool, trialBins[t]);
+        };
+        if (pool != nullptr && alive.size() > 1) {
+            pool->ParallelFor(alive.size(), runTrial);
+        }
+        else {
+            for (size_t i = 0; i < alive.size(); ++i) {
+                runTrial(i);
+            }
+        }
+
+        double best = 0.0;
+        for (size_t i = 0; i < alive.size(); ++i) {
+            Trial& trial = result.trials[alive[i]];
+            trial.seconds += round[i].trainSeconds + round[i].predictSeconds;
+            trial.folds.push_back(std::move(round[i]));
+            Summarize(trial);
+            best = std::max(best, trial.meanAccuracy);
+        }
+        result.foldsRun += alive.size();
+
+        const size_t foldsLeft = folds.size() - fold - 1;
+        if (!options.earlyStopping || fold + 1 < options.minFolds || foldsLeft == 0)
+            continue;
+        std::vector<size_t> survivors;
+        for (size_t t : alive) {
+            if (result.trials[t].meanAccuracy + options.stoppingMargin < best) {
+                result.trials[t].stopped = true;
+                result.foldsSkipped += foldsLeft;
+            }
+            else {
+                survivors.push_back(t);
+            }
+        }
+        alive = std::move(survivors);
+    }
+
+    // Лучшее испытание - наибольшая средняя точность среди доведённых до конца,
+    // при равенстве - меньшее дерево, затем более раннее в списке
+    for (size_t t : alive) {
+        const Trial& trial = result.trials[t];
+        const Trial& best = result.trials[result.best];
+        if (result.trials[result.best].stopped || trial.meanAccuracy > best.meanAccuracy ||
+            (trial.meanAccuracy == best.meanAccuracy && trial.meanNodes < best.meanNodes))
+            result.best = t;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+
+
+void GridSearch::PrintResult(const Result& result) {
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << "\nПеребор параметров: испытаний " << result.trials.size() << ", обучено моделей " << result.foldsRun
+        << ", пропущено досрочной остановкой " << result.foldsSkipped << ", время " << result.seconds << " с\n";
+    for (size_t t = 0; t < result.trials.size(); ++t) {
+        const Trial& trial = result.trials[t];
+        std::cout << (t == result.best ? " * " : "   ") << std::setw(4) << t + 1 << " | " << Describe(trial.treeOptions)
+            << " | точность " << std::fixed << std::setprecision(4) << trial.meanAccuracy << " +- " << trial.stdAccuracy
+            << " | узлов " << std::setprecision(1) << trial.meanNodes << " | блоков " << trial.folds.size()
+            << (trial.stopped ? " (остановлено)" : "") << "\n";
+    }
+    std::cout << "Лучшая конфигурация: " << Describe(result.trials[result.best].treeOptions) << "\n";
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,225 @@
+#include <../include/DecisionTrees/RandomForest/RandomForest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+void RandomForest::CheckTrained() const {
+    if (_trees.empty())
+        throw std::logic_error("Лес не обучен");
+}
+
+void RandomForest::CheckBufferSize(size_t bufferSize, size_t rowCount) const {
+    if (bufferSize != rowCount) {
+        std::stringstream ss;
+        ss << "Размер буфера предсказаний не совпадает с количеством строк. Ожидалось " << rowCount
+            << ", получено " << bufferSize;
+        throw std::invalid_argument(ss.str());
+    }
+}
+
+uint32_t RandomForest::SelectClass(const uint32_t* votes) const {
+    // Побеждает класс с наибольшим числом голосов, при равенстве - меньший код.
+    // Деревья, не сумевшие ответить, не голосуют; если не ответило ни одно, класс неизвестен
+    uint32_t best = _unknownClass;
+    uint32_t bestVotes = 0;
+    for (uint32_t c = 0; c < _classes.Size(); ++c) {
+        if (c != _unknownClass && votes[c] > bestVotes) {
+            best = c;
+            bestVotes = votes[c];
+        }
+    }
+    return best;
+}
+
+
+
+RandomForest RandomForest::Train(const DTDataset& dataset) {
+    return Train(dataset, Options());
+}
+
+RandomForest RandomForest::Train(const DTDataset& dataset, const Options& options) {
+    if (options.treeCount == 0)
+        throw std::invalid_argument("Число деревьев должно быть больше нуля");
+    if (!(options.sampleFraction > 0.0))
+        throw std::invalid_argument("Доля строк выборки должна быть больше нуля");
+    if (dataset.RowCount() == 0)
+        throw std::invalid_argument("Набор данных пуст");
+
+    std::unique_ptr<WorkStealingPool> ownPool;
+    WorkStealingPool* pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool);
+
+    // По умолчанию в узле рассматривается корень из числа признаков, как у Бреймана
+    const size_t numFeatures = dataset.ColumnCount() - 1;
+    ID3::Options treeOptions = options.treeOptions;
+    treeOptions.featureSubset = options.featureSubset != 0 ? options.featureSubset :
+        std::max<size_t>(1, static_cast<size_t>(std::lround(std::sqrt(static_cast<double>(numFeatures)))));
+    treeOptions.traceLevel = TraceLevel::Off;
+    treeOptions.traceSink = nullptr;
+    treeOptions.profile = nullptr;
+
+    // Корзины режима гистограмм строятся один раз и общие для всех деревьев
+    std::unique_ptr<DTFeatureBins> ownBins;
+    const DTFeatureBins* bins = ID3::ResolveFeatureBins(dataset, treeOptions, pool, ownBins);
+
+    const size_t numRows = dataset.RowCount();
+    const size_t sampleRows = std::max<size_t>(1, static_cast<size_t>(std::llround(numRows * options.sampleFraction)));
+
+    RandomForest forest;
+    forest._trees.resize(options.treeCount);
+    auto trainTree = [&](size_t index) {
+        // Бутстреп-выборка - вектор индексов строк с повторами, кратность индекса играет роль веса строки.
+        // Дерево строится на представлении поверх общего набора, копии данных не создаются
+        std::mt19937_64 random(ID3::ChildSeed(options.seed, 2 * index));
+        std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(numRows - 1));
+        std::vector<uint32_t> rows(sampleRows);
+        for (auto& row : rows) {
+            row = pick(random);
+        }
+        std::sort(rows.begin(), rows.end());
+
+        ID3::Options local = treeOptions;
+        local.seed = ID3::ChildSeed(options.seed, 2 * index + 1);
+        DTDatasetView view(dataset, std::move(rows));
+        forest._trees[index] = ID3::TrainView(view, local, pool, bins);
+    };
+
+    // Деревья обучаются параллельно; крупные ветви каждого дерева тоже уходят в общий пул
+    if (pool != nullptr && options.treeCount > 1) {
+        pool->ParallelFor(options.treeCount, trainTree);
+    }
+    else {
+        for (size_t index = 0; index < options.treeCount; ++index) {
+            trainTree(index);
+        }
+    }
+
+    // Классы леса - значения целевого столбца; классы каждого дерева переводятся в них один раз
+    forest._classes = dataset.GetColumn(dataset.GetTargetColumn()).GetDictionary();
+    forest._unknownClass = forest._classes.Intern("(неизвестно)");
+    for (const auto& tree : forest._trees) {
+        const auto& labels = tree.GetFlatTree().GetClasses().GetValues();
+        std::vector<uint32_t> mapping(labels.size());
+        for (size_t c = 0; c < labels.size(); ++c) {
+            uint32_t code = forest._classes.Find(labels[c]);
+            mapping[c] = code == DTDictionary::NoCode ? forest._unknownClass : code;
+        }
+        forest._treeClasses.push_back(std::move(mapping));
+    }
+    return forest;
+}
+
+
+
+size_t RandomForest::TreeCount() const {
+    return _trees.size();
+}
+
+const DecisionTree& RandomForest::GetTree(size_t index) const {
+    if (index >= _trees.size())
+        throw std::out_of_range("Некорректный индекс дерева");
+    return _trees[index];
+}
+
+const DTDictionary& RandomForest::GetClasses() const {
+    return _classes;
+}
+
+const std::string& RandomForest::GetClassLabel(uint32_t classId) const {
+    return _classes.GetValue(classId);
+}
+
+uint32_t RandomForest::PredictClass(const std::vector<std::string>& sample) const {
+    CheckTrained();
+    std::vector<uint32_t> votes(_classes.Size(), 0);
+    for (size_t t = 0; t < _trees.size(); ++t) {
+        votes[_treeClasses[t][_trees[t].PredictClass(sample)]]++;
+    }
+    return SelectClass(votes.data());
+}
+
+std::string RandomForest::Predict(const std::vector<std::string>& sample) const {
+    return _classes.GetValue(PredictClass(sample));
+}
+
+
+
+template <typename PredictTree>
+void RandomForest::Vote(size_t rowCount, const PredictOptions& options, const PredictTree& predictTree, std::span<uint32_t> classIds) const {
+    CheckTrained();
+    CheckBufferSize(classIds.size(), rowCount);
+
+    // Пул создаётся один раз на все деревья, если вызывающий не передал свой
+    std::unique_ptr<WorkStealingPool> ownPool;
+    PredictOptions treeOptions = options;
+    treeOptions.pool = WorkStealingPool::Resolve(options.pool, options.threads, ownPool);
+
+    const size_t numClasses = _classes.Size();
+    const size_t taskRows = std::max(options.taskRows, FlatTree::BlockSize);
+    const size_t numTasks = (rowCount + taskRows - 1) / taskRows;
+    auto forEachRange = [&](const auto& fn) {
+        auto runTask = [&](size_t task) {
+            fn(task * taskRows, std::min(rowCount, (task + 1) * taskRows));
+        };
+        if (treeOptions.pool != nullptr && numTasks > 1) {
+            treeOptions.pool->ParallelFor(numTasks, runTask);
+        }
+        else {
+            for (size_t task = 0; task < numTasks; ++task) {
+                runTask(task);
+            }
+        }
+    };
+
+    // Деревья предсказывают по очереди, каждое - пакетно и в несколько потоков:
+    // узлы одного дерева остаются в кэше, пока через него проходят все строки
+    std::vector<uint32_t> treeClassIds(rowCount);
+    std::vector<uint32_t> votes(rowCount * numClasses, 0);
+    for (size_t t = 0; t < _trees.size(); ++t) {
+        predictTree(_trees[t], std::span<uint32_t>(treeClassIds), treeOptions);
+        const uint32_t* mapping = _treeClasses[t].data();
+        forEachRange([&](size_t first, size_t last) {
+            for (size_t row = first; row < last; ++row) {
+                votes[row * numClasses + mapping[treeClassIds[row]]]++;
+            }
+        });
+    }
+
+    forEachRange([&](size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            classIds[row] = SelectClass(votes.data() + row * numClasses);
+        }
+    });
+}
+
+void RandomForest::PredictBatch(const DTDataset& dataset, std::span<uint32_t> classIds, const PredictOptions& options) const {
+    Vote(dataset.RowCount(), options, [&](const DecisionTree& tree, std::span<uint32_t> treeClassIds, const PredictOptions& treeOptions) {
+        tree.PredictBatch(dataset, treeClassIds, treeOptions);
+    }, classIds);
+}
+
+void RandomForest::PredictBatch(const DTDataset& dataset, std::span<std::string> labels, const PredictOptions& options) const {
+    std::vector<uint32_t> classIds(dataset.RowCount());
+    CheckBufferSize(labels.size(), classIds.size());
+    PredictBatch(dataset, std::span<uint32_t>(classIds), options);
+    for (size_t row = 0; row < classIds.size(); ++row) {
+        labels[row] = _classes.GetValue(classIds[row]);
+    }
+}
+
+void RandomForest::PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<uint32_t> classIds, const PredictOptions& options) const {
+    Vote(samples.size(), options, [&](const DecisionTree& tree, std::span<uint32_t> treeClassIds, const PredictOptions& treeOptions) {
+        tree.PredictBatch(samples, treeClassIds, treeOptions);
+    }, classIds);
+}
+
+void RandomForest::PredictBatch(const std::vector<std::vector<std::string>>& samples, std::span<std::string> labels, const PredictOptions& options) const {
+    std::vector<uint32_t> classIds(samples.size());
+    CheckBufferSize(labels.size(), classIds.size());
+    PredictBatch(samples, std::span<uint32_t>(classIds), options);
+    for (size_t row = 0; row < classIds.size(); ++row) {
+        labels[row] = _classes.GetValue(classIds[row]);
+    }
+}
@@ -0,0 +1,35 @@
+#include <../include/Utils/AllocationCounter.h>
+
+// Счётчики только накапливаются: сами operator new/delete библиотека не подменяет.
+// Их подменяет исполняемый файл, которому нужен учёт (например, замеры производительности),
+// и он же вызывает Install, чтобы отчёты знали, что числам можно верить
+std::atomic<uint64_t> AllocationCounter::_count{ 0 };
+std::atomic<uint64_t> AllocationCounter::_bytes{ 0 };
+std::atomic<bool> AllocationCounter::_installed{ false };
+
+// Счётчики потока нужны профилю обучения: выделения узла дерева считаются
+// на том потоке, где он строится, и не смешиваются с параллельными задачами
+thread_local uint64_t AllocationCounter::_threadCount = 0;
+thread_local uint64_t AllocationCounter::_threadBytes = 0;
+
+void AllocationCounter::Install() {
+    _installed.store(true, std::memory_order_relaxed);
+}
+
+bool AllocationCounter::IsInstalled() {
+    return _installed.load(std::memory_order_relaxed);
+}
+
+AllocationCounter::Snapshot AllocationCounter::Current() {
+    Snapshot snapshot;
+    snapshot.count = _count.load(std::memory_order_relaxed);
+    snapshot.bytes = _bytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+AllocationCounter::Snapshot AllocationCounter::CurrentThread() {
+    Snapshot snapshot;
+    snapshot.count = _threadCount;
+    snapshot.bytes = _threadBytes;
+    return snapshot;
+}
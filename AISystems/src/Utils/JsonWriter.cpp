@@ -0,0 +1,25 @@
+#include <../include/Utils/JsonWriter.h>
+
+#include <iomanip>
+
+void JsonWriter::WriteString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (unsigned char c : value) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                    << std::dec << std::setfill(' ');
+            }
+            else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
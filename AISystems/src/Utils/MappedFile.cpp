@@ -0,0 +1,157 @@
+#include <../include/Utils/MappedFile.h>
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _open = std::exchange(other._open, false);
+#ifdef _WIN32
+        _file = std::exchange(other._file, nullptr);
+        _mapping = std::exchange(other._mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    _file = file;
+    _size = static_cast<size_t>(size.QuadPart);
+    _open = true;
+
+    // Пустой файл отобразить нельзя - он считается открытым, но без данных
+    if (_size == 0)
+        return true;
+
+    _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping != nullptr)
+        _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    _size = static_cast<size_t>(info.st_size);
+    _open = true;
+
+    // Пустой файл отобразить нельзя - он считается открытым, но без данных
+    if (_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data != MAP_FAILED) {
+        _data = static_cast<const char*>(data);
+        madvise(data, _size, MADV_SEQUENTIAL);
+    }
+#endif
+
+    if (_data == nullptr) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (_data != nullptr)
+        UnmapViewOfFile(_data);
+    if (_mapping != nullptr)
+        CloseHandle(_mapping);
+    if (_file != nullptr)
+        CloseHandle(_file);
+    _mapping = nullptr;
+    _file = nullptr;
+#else
+    if (_data != nullptr)
+        munmap(const_cast<char*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+
+
+
+bool MappedFile::IsOpen() const {
+    return _open;
+}
+
+const char* MappedFile::Data() const {
+    return _data;
+}
+
+size_t MappedFile::Size() const {
+    return _size;
+}
+
+std::string_view MappedFile::View() const {
+    return std::string_view(_data, _size);
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+    if (_data == nullptr || offset >= _size)
+        return;
+    size = std::min(size, _size - offset);
+
+    // Подсказка системе заранее подгрузить страницы; на корректность не влияет
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    WIN32_MEMORY_RANGE_ENTRY range{ const_cast<char*>(_data + offset), size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t first = offset / page * page;
+    madvise(const_cast<char*>(_data + first), size + (offset - first), MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,180 @@
+#include <../include/Utils/WorkStealingPool.h>
+
+namespace {
+    // Пул и номер рабочего потока, которому принадлежит текущий поток
+    thread_local const WorkStealingPool* tlsPool = nullptr;
+    thread_local size_t tlsWorkerIndex = 0;
+
+    constexpr size_t NoWorker = static_cast<size_t>(-1);
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t i = 0; i < threads; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        _threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopping = true;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+WorkStealingPool* WorkStealingPool::Resolve(WorkStealingPool* pool, size_t threads, std::unique_ptr<WorkStealingPool>& own, bool parallelWork) {
+    if (pool != nullptr)
+        return pool;
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads <= 1 || !parallelWork)
+        return nullptr;
+    own = std::make_unique<WorkStealingPool>(threads);
+    return own.get();
+}
+
+size_t WorkStealingPool::ThreadCount() const {
+    return _workers.size();
+}
+
+size_t WorkStealingPool::CurrentWorker() const {
+    return tlsPool == this ? tlsWorkerIndex : NoWorker;
+}
+
+
+
+void WorkStealingPool::Submit(TaskGroup& group, std::function<void()> task) {
+    group._pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Рабочий поток кладёт задачу в свою очередь, внешний - распределяет по кругу
+    size_t index = CurrentWorker();
+    if (index == NoWorker)
+        index = _nextExternal.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+
+    {
+        std::lock_guard<std::mutex> lock(_workers[index]->mutex);
+        _workers[index]->tasks.push_back(Task{ std::move(task), &group });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+    _sleepCondition.notify_one();
+}
+
+void WorkStealingPool::Wait(TaskGroup& group) {
+    // Ожидающий поток не простаивает, а выполняет задачи - так вложенные группы не блокируют пул.
+    // Когда красть нечего, он засыпает до появления новой задачи или завершения группы
+    size_t index = CurrentWorker();
+    while (group._pending.load(std::memory_order_acquire) != 0) {
+        if (TryRunOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this, &group]() {
+            return group._pending.load(std::memory_order_acquire) == 0 || _queuedTasks.load(std::memory_order_acquire) != 0;
+        });
+    }
+
+    if (group._error) {
+        std::exception_ptr error = group._error;
+        group._error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+
+
+bool WorkStealingPool::TryPop(size_t index, Task& task) {
+    Worker& worker = *_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty())
+        return false;
+
+    // Владелец берёт последнюю задачу (LIFO): она самая "тёплая" в кэше
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(size_t thief, Task& task) {
+    const size_t count = _workers.size();
+    const size_t start = thief == NoWorker ? 0 : thief + 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if (victim == thief)
+            continue;
+
+        Worker& worker = *_workers[victim];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+            continue;
+
+        // Кража идёт с противоположного конца: там самые крупные, ещё не разбитые задачи
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::TryRunOne(size_t index) {
+    Task task;
+    if ((index != NoWorker && TryPop(index, task)) || TrySteal(index, task)) {
+        _queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        Execute(task);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::Execute(Task& task) {
+    TaskGroup* group = task.group;
+    try {
+        task.function();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(group->_errorMutex);
+        if (!group->_error)
+            group->_error = std::current_exception();
+    }
+    task.function = nullptr;
+
+    // Последняя задача группы будит ожидающих; после уменьшения счётчика группа может быть
+    // уже разрушена ожидающим, поэтому к ней больше не обращаемся
+    if (group->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _sleepCondition.notify_all();
+    }
+}
+
+void WorkStealingPool::WorkerLoop(size_t index) {
+    tlsPool = this;
+    tlsWorkerIndex = index;
+
+    while (true) {
+        if (TryRunOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this]() {
+            return _stopping || _queuedTasks.load(std::memory_order_acquire) != 0;
+        });
+        if (_stopping)
+            return;
+    }
+}